@@ -0,0 +1,402 @@
+#include <comics/comics.h>
+#include <comics/coro.h>
+#include <comics/formatter.h>
+#include <comics/issue-index.h>
+#include <comics/match-printer.h>
+#include <comics/snapshot.h>
+
+#include <benchmark/benchmark.h>
+#include <simdjson.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+constexpr int SEQUENCES_PER_ISSUE{8};
+constexpr std::int64_t SIZES[]{10'000, 100'000};
+constexpr std::int64_t HIT_PERCENTS[]{1, 10, 50, 100};
+
+enum Source : std::int64_t
+{
+    JSON,
+    SNAPSHOT,
+    NDJSON,
+};
+
+// Discards everything written to it, so printing is measured without the cost of a terminal.
+class NullBuffer : public std::streambuf
+{
+protected:
+    int_type overflow(int_type c) override
+    {
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char *, std::streamsize count) override
+    {
+        return count;
+    }
+};
+
+NullBuffer g_nullBuffer;
+std::ostream g_null{&g_nullBuffer};
+
+// Silences the progress messages databases write while loading.
+class QuietCout
+{
+public:
+    QuietCout() :
+        m_saved(std::cout.rdbuf(&g_nullBuffer))
+    {
+    }
+    ~QuietCout()
+    {
+        std::cout.rdbuf(m_saved);
+    }
+
+private:
+    std::streambuf *m_saved;
+};
+
+// The name whose credits appear in hitPercent of the sequences.
+std::string needle(std::int64_t hitPercent)
+{
+    char name[8];
+    std::snprintf(name, sizeof(name), "P%03d", static_cast<int>(hitPercent));
+    return name;
+}
+
+// Synthetic issues and sequences with one script credit per hit rate, spread evenly over the
+// sequences, written as JSON, snapshots and NDJSON in their own directories.
+class Dataset
+{
+public:
+    explicit Dataset(std::int64_t sequences) :
+        m_dir(std::filesystem::temp_directory_path() / ("bench-comics-" + std::to_string(sequences)))
+    {
+        std::filesystem::remove_all(m_dir);
+        for (const char *source : {"json", "snapshot", "ndjson"})
+        {
+            std::filesystem::create_directories(m_dir / source);
+        }
+        comics::TableWriter issueTable{comics::ISSUE_COLUMNS};
+        std::ofstream issues(m_dir / "json" / "bench_issues.json");
+        std::ofstream issueLines(m_dir / "ndjson" / "bench_issues.ndjson");
+        issues << "[\n";
+        const std::int64_t issueCount{(sequences + SEQUENCES_PER_ISSUE - 1) / SEQUENCES_PER_ISSUE};
+        for (int issue = 1; issue <= issueCount; ++issue)
+        {
+            const std::string series{"Series " + std::to_string(issue % 997)};
+            const std::string number{std::to_string(issue)};
+            const std::string record{"{ \"id\": \"" + number + "\", \"series name\": \"" + series +
+                "\", \"issue number\": \"" + number + "\"}"};
+            issues << (issue == 1 ? "" : ",\n") << record;
+            issueLines << record << '\n';
+            issueTable.set(0, issue);
+            issueTable.set(1, series);
+            issueTable.set(2, number);
+            issueTable.endRow();
+        }
+        issues << "\n]\n";
+
+        comics::TableWriter sequenceTable{comics::SEQUENCE_COLUMNS};
+        std::ofstream sequenceFile(m_dir / "json" / "bench_sequences.json");
+        std::ofstream sequenceLines(m_dir / "ndjson" / "bench_sequences.ndjson");
+        sequenceFile << "[\n";
+        for (std::int64_t row = 0; row < sequences; ++row)
+        {
+            const int issue{static_cast<int>(row / SEQUENCES_PER_ISSUE + 1)};
+            const int sequence{static_cast<int>(row % SEQUENCES_PER_ISSUE)};
+            const std::int64_t spread{row * 7919 % 100};
+            std::string script{"Stan Lee (credited)"};
+            for (const std::int64_t hitPercent : HIT_PERCENTS)
+            {
+                if (spread < hitPercent)
+                {
+                    script += "; Writer " + needle(hitPercent);
+                }
+            }
+            const std::string title{"Story " + std::to_string(row)};
+            const std::string record{"{ \"issue\": \"" + std::to_string(issue) + "\", \"sequence_number\": \"" +
+                std::to_string(sequence) + "\", \"title\": \"" + title +
+                "\", \"feature\": \"Fantastic Four\", \"script\": \"" + script +
+                "\", \"pencils\": \"Jack Kirby\", \"inks\": \"Joe Sinnott\", \"colors\": \"Stan Goldberg\"}"};
+            sequenceFile << (row == 0 ? "" : ",\n") << record;
+            sequenceLines << record << '\n';
+            sequenceTable.set(0, issue);
+            sequenceTable.set(1, sequence);
+            sequenceTable.set(2, title);
+            sequenceTable.set(3, "Fantastic Four");
+            sequenceTable.set(4, script);
+            sequenceTable.set(5, "Jack Kirby");
+            sequenceTable.set(6, "Joe Sinnott");
+            sequenceTable.set(7, "Stan Goldberg");
+            sequenceTable.endRow();
+        }
+        sequenceFile << "\n]\n";
+        comics::writeSnapshot(m_dir / "snapshot" / "bench_issues.snapshot", issueTable.table());
+        comics::writeSnapshot(m_dir / "snapshot" / "bench_sequences.snapshot", sequenceTable.table());
+    }
+    ~Dataset()
+    {
+        std::filesystem::remove_all(m_dir);
+    }
+    Dataset(const Dataset &) = delete;
+    Dataset &operator=(const Dataset &) = delete;
+
+    std::filesystem::path dir(std::int64_t source) const
+    {
+        return m_dir / (source == JSON ? "json" : source == SNAPSHOT ? "snapshot" : "ndjson");
+    }
+
+private:
+    std::filesystem::path m_dir;
+};
+
+// Datasets are generated the first time a benchmark asks for their size.
+const Dataset &dataset(std::int64_t sequences)
+{
+    static std::map<std::int64_t, std::unique_ptr<Dataset>> datasets;
+    std::unique_ptr<Dataset> &data = datasets[sequences];
+    if (!data)
+    {
+        data = std::make_unique<Dataset>(sequences);
+    }
+    return *data;
+}
+
+// Loaded databases, kept across benchmarks of the same size and source.
+comics::coroutine::DatabasePtr coroutineDatabase(std::int64_t sequences, std::int64_t source)
+{
+    static std::map<std::pair<std::int64_t, std::int64_t>, comics::coroutine::DatabasePtr> databases;
+    comics::coroutine::DatabasePtr &db = databases[{sequences, source}];
+    if (!db)
+    {
+        const QuietCout quiet;
+        db = comics::coroutine::createDatabase(dataset(sequences).dir(source));
+    }
+    return db;
+}
+
+std::shared_ptr<comics::Database> printDatabase(std::int64_t sequences, std::int64_t source)
+{
+    static std::map<std::pair<std::int64_t, std::int64_t>, std::shared_ptr<comics::Database>> databases;
+    std::shared_ptr<comics::Database> &db = databases[{sequences, source}];
+    if (!db)
+    {
+        const QuietCout quiet;
+        db = comics::createDatabase(dataset(sequences).dir(source));
+    }
+    return db;
+}
+
+std::vector<comics::coroutine::SequenceMatch> collectMatches(
+    const comics::coroutine::DatabasePtr &db, const std::string &name)
+{
+    std::vector<comics::coroutine::SequenceMatch> found;
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, name)};
+    while (coro.resume())
+    {
+        found.push_back(coro.getMatch());
+    }
+    return found;
+}
+
+void setItems(benchmark::State &state, std::int64_t items)
+{
+    state.SetItemsProcessed(state.iterations() * items);
+}
+
+// createDatabase: args are sequences and source.
+void loadPrint(benchmark::State &state)
+{
+    const std::filesystem::path dir{dataset(state.range(0)).dir(state.range(1))};
+    for (auto _ : state)
+    {
+        const QuietCout quiet;
+        benchmark::DoNotOptimize(comics::createDatabase(dir));
+    }
+    setItems(state, state.range(0));
+}
+
+void loadCoroutine(benchmark::State &state)
+{
+    const std::filesystem::path dir{dataset(state.range(0)).dir(state.range(1))};
+    for (auto _ : state)
+    {
+        const QuietCout quiet;
+        benchmark::DoNotOptimize(comics::coroutine::createDatabase(dir));
+    }
+    setItems(state, state.range(0));
+}
+
+// Drain a scan of the scripts; items are sequences scanned.  Args are sequences, source and hit percent.
+void scanCoroutine(benchmark::State &state)
+{
+    const comics::coroutine::DatabasePtr db{coroutineDatabase(state.range(0), state.range(1))};
+    const std::string name{needle(state.range(2))};
+    std::size_t count{};
+    for (auto _ : state)
+    {
+        comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, name)};
+        count = 0;
+        for (std::span<const comics::coroutine::SequenceMatch> batch = coro.resumeBatch(256); !batch.empty();
+             batch = coro.resumeBatch(256))
+        {
+            benchmark::DoNotOptimize(batch.data());
+            count += batch.size();
+        }
+    }
+    setItems(state, state.range(0));
+    state.counters["matches"] = static_cast<double>(count);
+}
+
+// Find the issue row of every match; items are matches.  Args are sequences, source and hit percent.
+void joinCoroutine(benchmark::State &state)
+{
+    const comics::coroutine::DatabasePtr db{coroutineDatabase(state.range(0), state.range(1))};
+    const std::vector<comics::coroutine::SequenceMatch> found{collectMatches(db, needle(state.range(2)))};
+    const comics::SequenceColumns sequences{*db->getSequenceTable()};
+    for (auto _ : state)
+    {
+        for (const comics::coroutine::SequenceMatch &match : found)
+        {
+            benchmark::DoNotOptimize(db->findIssueRow(sequences.issue[match.sequenceRow]));
+        }
+    }
+    setItems(state, static_cast<std::int64_t>(found.size()));
+}
+
+// The issue index lookups the print engine makes for each match; items are matches.
+void joinPrint(benchmark::State &state)
+{
+    const comics::coroutine::DatabasePtr db{coroutineDatabase(state.range(0), SNAPSHOT)};
+    const std::vector<comics::coroutine::SequenceMatch> found{collectMatches(db, needle(state.range(1)))};
+    const comics::SequenceColumns sequences{*db->getSequenceTable()};
+    const comics::IssueRowIndex index{comics::buildIssueRowIndex(comics::IssueColumns{*db->getIssueTable()}.id)};
+    for (auto _ : state)
+    {
+        for (const comics::coroutine::SequenceMatch &match : found)
+        {
+            benchmark::DoNotOptimize(index.find(sequences.issue[match.sequenceRow]));
+        }
+    }
+    setItems(state, static_cast<std::int64_t>(found.size()));
+}
+
+// Scan, join and print every match to a discarding stream; items are sequences scanned.
+// Args are sequences, source and hit percent.
+void printPrint(benchmark::State &state)
+{
+    const std::shared_ptr<comics::Database> db{printDatabase(state.range(0), state.range(1))};
+    const std::string name{needle(state.range(2))};
+    for (auto _ : state)
+    {
+        db->printScriptSequences(g_null, name);
+    }
+    setItems(state, state.range(0));
+}
+
+void printCoroutine(benchmark::State &state)
+{
+    const comics::coroutine::DatabasePtr db{coroutineDatabase(state.range(0), state.range(1))};
+    const std::string name{needle(state.range(2))};
+    for (auto _ : state)
+    {
+        comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, name)};
+        comics::coroutine::MatchPrinter{*db}.printAll(g_null, coro, {}, 256);
+    }
+    setItems(state, state.range(0));
+}
+
+// Format every sequence from its columns, as both engines print table rows; items are sequences.
+void formatColumns(benchmark::State &state)
+{
+    const comics::coroutine::DatabasePtr db{coroutineDatabase(state.range(0), SNAPSHOT)};
+    const comics::SequenceColumns sequences{*db->getSequenceTable()};
+    const std::size_t rows{db->getSequenceTable()->rows()};
+    for (auto _ : state)
+    {
+        comics::OutputBuffer out{g_null};
+        for (std::size_t row = 0; row < rows; ++row)
+        {
+            comics::formatSequence(out, sequences, row);
+        }
+    }
+    setItems(state, static_cast<std::int64_t>(rows));
+}
+
+// Format every sequence from its JSON record, as the coroutine engine prints streamed records.
+void formatJSON(benchmark::State &state)
+{
+    simdjson::dom::parser parser;
+    const simdjson::dom::element records{
+        parser.load((dataset(state.range(0)).dir(JSON) / "bench_sequences.json").string())};
+    std::vector<simdjson::dom::object> sequences;
+    for (const simdjson::dom::element record : records.get_array())
+    {
+        sequences.push_back(record.get_object().value());
+    }
+    for (auto _ : state)
+    {
+        comics::OutputBuffer out{g_null};
+        for (const simdjson::dom::object sequence : sequences)
+        {
+            comics::formatSequence(out, sequence);
+        }
+    }
+    setItems(state, static_cast<std::int64_t>(sequences.size()));
+}
+
+void loadArgs(benchmark::internal::Benchmark *benchmark, std::initializer_list<std::int64_t> sources)
+{
+    benchmark->ArgNames({"sequences", "source"});
+    for (const std::int64_t sequences : SIZES)
+    {
+        for (const std::int64_t source : sources)
+        {
+            benchmark->Args({sequences, source});
+        }
+    }
+}
+
+void scanArgs(benchmark::internal::Benchmark *benchmark, std::initializer_list<std::int64_t> sources)
+{
+    benchmark->ArgNames({"sequences", "source", "hit%"});
+    for (const std::int64_t sequences : SIZES)
+    {
+        for (const std::int64_t source : sources)
+        {
+            for (const std::int64_t hitPercent : HIT_PERCENTS)
+            {
+                benchmark->Args({sequences, source, hitPercent});
+            }
+        }
+    }
+}
+
+} // namespace
+
+// source: 0 JSON, 1 snapshot, 2 NDJSON; the print engine doesn't read NDJSON.
+BENCHMARK(loadPrint)->Apply([](auto *b) { loadArgs(b, {JSON, SNAPSHOT}); })->Unit(benchmark::kMillisecond);
+BENCHMARK(loadCoroutine)->Apply([](auto *b) { loadArgs(b, {JSON, SNAPSHOT, NDJSON}); })->Unit(benchmark::kMillisecond);
+BENCHMARK(scanCoroutine)->Apply([](auto *b) { scanArgs(b, {JSON, SNAPSHOT, NDJSON}); })->Unit(benchmark::kMillisecond);
+BENCHMARK(joinCoroutine)->Apply([](auto *b) { scanArgs(b, {SNAPSHOT}); });
+BENCHMARK(joinPrint)->ArgsProduct({{SIZES[0], SIZES[1]}, {1, 10, 50, 100}})->ArgNames({"sequences", "hit%"});
+BENCHMARK(printPrint)->Apply([](auto *b) { scanArgs(b, {JSON, SNAPSHOT}); })->Unit(benchmark::kMillisecond);
+BENCHMARK(printCoroutine)->Apply([](auto *b) { scanArgs(b, {SNAPSHOT, NDJSON}); })->Unit(benchmark::kMillisecond);
+BENCHMARK(formatColumns)->ArgsProduct({{SIZES[0], SIZES[1]}})->ArgNames({"sequences"})->Unit(benchmark::kMillisecond);
+BENCHMARK(formatJSON)->ArgsProduct({{SIZES[0], SIZES[1]}})->ArgNames({"sequences"})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,140 @@
+#include <comics/coro.h>
+#include <comics/issue-index.h>
+#include <comics/snapshot.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace
+{
+
+const char *const SAMPLE_SCRIPTS[]{
+    "Stan Lee",
+    "Stan Lee (credited); Jack Kirby (plot)",
+    "Larry Lieber (credited); Stan Lee (plot)",
+    "Steve Ditko",
+    "Gardner Fox",
+    "Roy Thomas (credited); Gerry Conway (credited)",
+};
+
+constexpr int SEQUENCES_PER_ISSUE{8};
+
+// Sequence table in memory, so the benchmark measures the generator rather than loading.
+class TableDatabase : public comics::coroutine::Database
+{
+public:
+    explicit TableDatabase(int issues)
+    {
+        int row{};
+        for (int issue = 1; issue <= issues; ++issue)
+        {
+            m_issueWriter.set(0, issue);
+            m_issueWriter.set(1, "Fantastic Four");
+            m_issueWriter.set(2, std::to_string(issue));
+            m_issueWriter.endRow();
+            for (int sequence = 0; sequence < SEQUENCES_PER_ISSUE; ++sequence)
+            {
+                m_sequenceWriter.set(0, issue);
+                m_sequenceWriter.set(1, sequence);
+                m_sequenceWriter.set(4, SAMPLE_SCRIPTS[row++ % std::size(SAMPLE_SCRIPTS)]);
+                m_sequenceWriter.endRow();
+            }
+        }
+        m_issues = m_issueWriter.table();
+        m_sequences = m_sequenceWriter.table();
+        m_index = comics::buildIssueRowIndex(comics::IssueColumns{m_issues}.id);
+    }
+    ~TableDatabase() override = default;
+
+    simdjson::simdjson_result<simdjson::dom::element> getIssues() const override
+    {
+        return simdjson::UNINITIALIZED;
+    }
+    simdjson::simdjson_result<simdjson::dom::element> getSequences() const override
+    {
+        return simdjson::UNINITIALIZED;
+    }
+    const comics::Table *getIssueTable() const override
+    {
+        return &m_issues;
+    }
+    const comics::Table *getSequenceTable() const override
+    {
+        return &m_sequences;
+    }
+    std::size_t findIssueRow(int id) const override
+    {
+        return *m_index.find(id);
+    }
+
+private:
+    comics::TableWriter m_issueWriter{comics::ISSUE_COLUMNS};
+    comics::TableWriter m_sequenceWriter{comics::SEQUENCE_COLUMNS};
+    comics::Table m_issues;
+    comics::Table m_sequences;
+    comics::IssueRowIndex m_index;
+};
+
+std::shared_ptr<TableDatabase> g_database;
+
+void setItemsProcessed(benchmark::State &state, std::size_t matches)
+{
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * matches));
+}
+
+// One resume and one getMatch per match.
+void perMatch(benchmark::State &state)
+{
+    std::size_t count{};
+    for (auto _ : state)
+    {
+        comics::coroutine::MatchGenerator coro{matches(g_database, comics::coroutine::CreditField::SCRIPT, "Lee")};
+        count = 0;
+        while (coro.resume())
+        {
+            benchmark::DoNotOptimize(coro.getMatch());
+            ++count;
+        }
+    }
+    setItemsProcessed(state, count);
+}
+
+// One resume per batch of state.range(0) matches.
+void batched(benchmark::State &state)
+{
+    const std::size_t capacity{static_cast<std::size_t>(state.range(0))};
+    std::size_t count{};
+    for (auto _ : state)
+    {
+        comics::coroutine::MatchGenerator coro{matches(g_database, comics::coroutine::CreditField::SCRIPT, "Lee")};
+        count = 0;
+        for (std::span<const comics::coroutine::SequenceMatch> batch = coro.resumeBatch(capacity); !batch.empty();
+             batch = coro.resumeBatch(capacity))
+        {
+            for (const comics::coroutine::SequenceMatch &match : batch)
+            {
+                benchmark::DoNotOptimize(match);
+            }
+            count += batch.size();
+        }
+    }
+    setItemsProcessed(state, count);
+}
+
+} // namespace
+
+BENCHMARK(perMatch);
+BENCHMARK(batched)->Arg(1)->Arg(16)->Arg(256)->Arg(4096);
+
+int main(int argc, char *argv[])
+{
+    benchmark::Initialize(&argc, argv);
+    g_database = std::make_shared<TableDatabase>(20000);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include <comics/matcher.h>
+
+#include <benchmark/benchmark.h>
+#include <simdjson.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+// Credit strings as they appear in the GCD script and pencils fields.
+const char *const SAMPLE_CREDITS[]{
+    "Stan Lee",
+    "Stan Lee (credited); Jack Kirby (plot)",
+    "Jack Kirby (credited); Stan Lee (credited)",
+    "Steve Ditko",
+    "?",
+    "Gardner Fox",
+    "Robert Kanigher (signed as Bob Kanigher)",
+    "Bill Finger ?",
+    "John Broome; Gardner Fox ?",
+    "Roy Thomas (credited); Gerry Conway (credited)",
+    "Chris Claremont (credited)",
+    "Len Wein (credited); Marv Wolfman (credited) [as Marv Wolfman]",
+    "Archie Goodwin (credited)",
+    "Don Rico [as N. Korok]",
+    "Otto Binder ?; Bill Woolfolk ?",
+    "Carl Barks",
+    "Alan Moore (credited)",
+    "Frank Miller (credited); Klaus Janson (credited)",
+    "Dennis O'Neil (credited) [as Denny O'Neil]",
+    "Stan Goldberg (credited); Sol Brodsky ?",
+    "Larry Lieber (credited); Stan Lee (plot)",
+    "Jerry Siegel; Joe Shuster (signed as Joe Shuster)",
+    "Mort Weisinger ?",
+    "Will Eisner (signed as Will Eisner [signature])",
+    "Harvey Kurtzman (credited)",
+    "Wally Wood (signed as Wood)",
+    "Julius Schwartz (editor); John Broome (credited)",
+    "Gil Kane (credited); Murphy Anderson (credited)",
+    "Marie Severin (credited); Herb Trimpe (credited)",
+    "John Romita (credited) [as John Romita Sr.]",
+    "Denny O'Neil (credited); Neal Adams (credited)",
+    "Steve Englehart (credited)",
+};
+
+std::vector<std::string> g_credits;
+std::string g_corpus;
+
+void loadSampleCredits()
+{
+    // repeat the sample so the corpus is well beyond the size of the L1 cache
+    for (int i = 0; i < 2000; ++i)
+    {
+        g_credits.insert(g_credits.end(), std::begin(SAMPLE_CREDITS), std::end(SAMPLE_CREDITS));
+    }
+}
+
+void loadSequenceCredits(const char *path)
+{
+    simdjson::dom::parser parser;
+    for (const simdjson::dom::element record : parser.load(path).get_array())
+    {
+        std::string_view script;
+        if (record.at_key("script").get(script) == simdjson::SUCCESS)
+        {
+            g_credits.emplace_back(script);
+        }
+    }
+}
+
+void setBytesProcessed(benchmark::State &state)
+{
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * g_corpus.size()));
+}
+
+void stringViewFind(benchmark::State &state, std::string_view needle)
+{
+    for (auto _ : state)
+    {
+        std::size_t count{};
+        for (const std::string &credits : g_credits)
+        {
+            count += std::string_view{credits}.find(needle) != std::string_view::npos;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    setBytesProcessed(state);
+}
+
+void boyerMooreHorspool(benchmark::State &state, std::string_view needle)
+{
+    const std::boyer_moore_horspool_searcher searcher{needle.begin(), needle.end()};
+    for (auto _ : state)
+    {
+        std::size_t count{};
+        for (const std::string &credits : g_credits)
+        {
+            count += std::search(credits.begin(), credits.end(), searcher) != credits.end();
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    setBytesProcessed(state);
+}
+
+void needleMatcher(benchmark::State &state, std::string_view needle, comics::NeedleMatcher::Implementation impl)
+{
+    const comics::NeedleMatcher matcher{needle, impl};
+    for (auto _ : state)
+    {
+        std::size_t count{};
+        for (const std::string &credits : g_credits)
+        {
+            count += matcher.matches(credits);
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    setBytesProcessed(state);
+}
+
+// One search over all credits concatenated, as findRow searches a snapshot column.
+void needleMatcherCorpus(benchmark::State &state, std::string_view needle, comics::NeedleMatcher::Implementation impl)
+{
+    const comics::NeedleMatcher matcher{needle, impl};
+    for (auto _ : state)
+    {
+        std::size_t count{};
+        std::string_view text{g_corpus};
+        for (std::size_t pos = matcher.find(text); pos != comics::NeedleMatcher::npos; pos = matcher.find(text))
+        {
+            ++count;
+            text.remove_prefix(pos + 1);
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    setBytesProcessed(state);
+}
+
+void registerBenchmarks()
+{
+    using Implementation = comics::NeedleMatcher::Implementation;
+    for (const std::string_view needle : {"Lee", "Stan Lee", "Steve Englehart", "Barry Flargle"})
+    {
+        const std::string suffix{"/\"" + std::string{needle} + "\""};
+        benchmark::RegisterBenchmark(("string_view::find" + suffix).c_str(), stringViewFind, needle);
+        benchmark::RegisterBenchmark(("boyer_moore_horspool" + suffix).c_str(), boyerMooreHorspool, needle);
+        for (const Implementation impl :
+            {Implementation::SCALAR, Implementation::SSE2, Implementation::AVX2, Implementation::NEON})
+        {
+            if (comics::NeedleMatcher::supported(impl))
+            {
+                const std::string name{comics::NeedleMatcher::name(impl)};
+                benchmark::RegisterBenchmark(("NeedleMatcher/" + name + suffix).c_str(), needleMatcher, needle, impl);
+                benchmark::RegisterBenchmark(
+                    ("NeedleMatcher/" + name + "/corpus" + suffix).c_str(), needleMatcherCorpus, needle, impl);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    benchmark::Initialize(&argc, argv);
+    if (argc > 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " [benchmark options] [sequences.json]\n";
+        return 1;
+    }
+    try
+    {
+        if (argc == 2)
+        {
+            loadSequenceCredits(argv[1]);
+        }
+        else
+        {
+            loadSampleCredits();
+        }
+    }
+    catch (const std::exception &bang)
+    {
+        std::cerr << bang.what() << '\n';
+        return 1;
+    }
+    for (const std::string &credits : g_credits)
+    {
+        g_corpus += credits;
+    }
+
+    registerBenchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -1,248 +1,353 @@
 #include <algorithm>
 #include <map>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <simdjson.h>
 
 #include "comics/comics.h"
+#include "comics/credit-index.h"
+#include "comics/fold.h"
+#include "comics/formatter.h"
+#include "comics/issue-index.h"
+#include "comics/json-files.h"
+#include "comics/matcher.h"
+#include "comics/projection.h"
+#include "comics/query-cache.h"
+#include "comics/snapshot.h"
+#include "comics/sort-keys.h"
+#include "comics/stats.h"
+#include "comics/thread-pool.h"
+#include "comics/trigram-index.h"
 
 namespace comics
 {
 
-inline bool endsWith(const std::string &text, const std::string &suffix)
-{
-    return text.length() >= suffix.length() && text.substr(text.length() - suffix.length()) == suffix;
-}
-
 namespace
 {
 
-void printSequence(std::ostream &str, const simdjson::dom::object &sequence)
-{
-    const auto printField = [&](const std::string_view key)
-    {
-        const auto it = std::find_if(sequence.begin(), sequence.end(),
-            [=](const simdjson::dom::key_value_pair &item) { return item.key == key; });
-        if (it == sequence.end())
-        {
-            // field might not be present
-            return;
-        }
-        const simdjson::simdjson_result<simdjson::dom::element> field = sequence.at_key(key);
-        if (key.length() > 18)
-        {
-            throw std::runtime_error("Field " + std::string{key} + " too long");
-        }
-        str << std::string(18 - key.length(), ' ') << key << ": ";
-        if (field.is_string())
-        {
-            str << field.get_string().value() << '\n';
-        }
-        else if (field.is_bool())
-        {
-            str << (field.get_bool().value() ? "true\n" : "false\n");
-        }
-        else if (field.is_number())
-        {
-            str << field.get_int64() << '\n';
-        }
-        else
-        {
-            std::ostringstream fieldType;
-            fieldType << field.type();
-            throw std::runtime_error("Unknown type for field '" + std::string{key} + "', got " + fieldType.str());
-        }
-    };
-    printField("title");
-    printField("feature");
-    printField("script");
-    printField("pencils");
-    printField("inks");
-    printField("colors");
-}
-
-class JSONDatabase : public Database
+// Prints matches found by scanning in-memory columns of the fields queries read.
+class ColumnDatabase : public Database
 {
 public:
-    JSONDatabase(const std::filesystem::path &jsonDir);
+    explicit ColumnDatabase(const DatabaseOptions &options);
+    void setMatchMode(MatchMode mode) override;
     void printScriptSequences(std::ostream &str, const std::string &name) override;
     void printPencilSequences(std::ostream &str, const std::string &name) override;
     void printInkSequences(std::ostream &str, const std::string &name) override;
     void printColorSequences(std::ostream &str, const std::string &name) override;
+    void printLetterSequences(std::ostream &str, const std::string &name) override;
+
+protected:
+    void setTables(const Table &issues, const Table &sequences);
+    // Open the query cache the options ask for, for the files the tables were loaded from.
+    void openCache(const std::filesystem::path &issues, const std::filesystem::path &sequences);
 
 private:
-    void printIssue( std::ostream& str, int id ) const;
-    void printMatchingSequences(std::ostream &str, const std::string_view &fieldName, const std::string &name);
+    void printIssue(OutputBuffer &out, int id) const;
+    void printMatchingSequences(
+        std::ostream &str, std::string_view field, const StringColumn &column, const std::string &name);
+    const StringColumn &foldedColumn(const StringColumn &column);
 
-    simdjson::dom::parser m_issueParser;
-    simdjson::simdjson_result<simdjson::dom::element> m_issues;
-    simdjson::dom::parser m_sequenceParser;
-    simdjson::simdjson_result<simdjson::dom::element> m_sequences;
+    std::optional<IssueColumns> m_issues;
+    std::optional<SequenceColumns> m_sequences;
+    IssueRowIndex m_issueIndex;
+    DatabaseOptions m_options;
+    MatchMode m_matchMode{MatchMode::SUBSTRING};
+    std::map<const StringColumn *, CreditIndex> m_creditIndexes;
+    std::map<const StringColumn *, TrigramIndex> m_trigramIndexes;
+    std::map<const StringColumn *, std::pair<FoldedColumn, StringColumn>> m_foldedColumns;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::unique_ptr<QueryCache> m_cache;
 };
 
-JSONDatabase::JSONDatabase(const std::filesystem::path &jsonDir)
+ColumnDatabase::ColumnDatabase(const DatabaseOptions &options) :
+    m_options(options)
 {
-    bool foundIssues{false};
-    bool foundSequences{false};
-    for (const auto &entry : std::filesystem::directory_iterator(jsonDir))
+    if (m_options.threads > 1)
     {
-        if (!entry.is_regular_file())
-        {
-            continue;
-        }
-        const std::filesystem::path &path{entry.path()};
-        const std::string filename{path.filename().string()};
-        if (endsWith(filename, "issues.json"))
-        {
-            std::cout << "Reading issues...\n";
-            m_issues = m_issueParser.load(path.string());
-            foundIssues = true;
-            std::cout << "done.\n";
-            if (!m_issues.is_array())
-            {
-                throw std::runtime_error("JSON issues file should be an array of objects");
-            }
-        }
-        else if (endsWith(filename, "sequences.json"))
-        {
-            std::cout << "Reading sequences...\n";
-            m_sequences = m_sequenceParser.load(path.string());
-            foundSequences = true;
-            std::cout << "done.\n";
-            if (!m_sequences.is_array())
-            {
-                throw std::runtime_error("JSON sequences file should be an array of objects");
-            }
-        }
+        m_pool = std::make_unique<ThreadPool>(m_options.threads);
     }
-    if (!(foundIssues && foundSequences))
+}
+
+void ColumnDatabase::setTables(const Table &issues, const Table &sequences)
+{
+    m_issues.emplace(issues);
+    m_sequences.emplace(sequences);
     {
-        if (foundIssues)
-        {
-            throw std::runtime_error("Couldn't find sequences JSON file in " + jsonDir.string());
-        }
-        if (foundSequences)
+        const PhaseTimer timer{m_options.stats, Phase::INDEX};
+        m_issueIndex = buildIssueRowIndex(m_issues->id);
+    }
+    if (m_options.foldCredits)
+    {
+        for (const StringColumn *column :
+            {&m_sequences->script, &m_sequences->pencils, &m_sequences->inks, &m_sequences->colors, &m_sequences->letters})
         {
-            throw std::runtime_error("Couldn't find issues JSON file in " + jsonDir.string());
+            foldedColumn(*column);
         }
-        throw std::runtime_error("Couldn't find either issues or sequences JSON file in " + jsonDir.string());
     }
 }
 
-void JSONDatabase::printScriptSequences(std::ostream &str, const std::string &name)
+void ColumnDatabase::openCache(const std::filesystem::path &issues, const std::filesystem::path &sequences)
 {
-    printMatchingSequences(str, "script", name);
+    m_cache = openQueryCache(m_options, issues, sequences);
 }
 
-void JSONDatabase::printPencilSequences(std::ostream &str, const std::string &name)
+const StringColumn &ColumnDatabase::foldedColumn(const StringColumn &column)
 {
-    printMatchingSequences(str, "pencils", name);
+    auto it = m_foldedColumns.find(&column);
+    if (it == m_foldedColumns.end())
+    {
+        const PhaseTimer timer{m_options.stats, Phase::PROJECT};
+        it = m_foldedColumns.emplace(&column, std::pair{FoldedColumn{column}, StringColumn{}}).first;
+        it->second.second = it->second.first.column();
+    }
+    return it->second.second;
 }
 
-void JSONDatabase::printInkSequences(std::ostream &str, const std::string &name)
+void ColumnDatabase::setMatchMode(MatchMode mode)
 {
-    printMatchingSequences(str, "inks", name);
+    m_matchMode = mode;
 }
 
-void JSONDatabase::printColorSequences(std::ostream &str, const std::string &name)
+void ColumnDatabase::printScriptSequences(std::ostream &str, const std::string &name)
 {
-    printMatchingSequences(str, "colors", name);
+    printMatchingSequences(str, "script", m_sequences->script, name);
 }
 
-void JSONDatabase::printIssue(std::ostream &str, int id) const
+void ColumnDatabase::printPencilSequences(std::ostream &str, const std::string &name)
 {
-    const auto it = std::find_if(m_issues.get_array().begin(), m_issues.get_array().end(),
-        [=](const simdjson::dom::element &item)
-        {
-            if (!item.is_object())
-            {
-                throw std::runtime_error("Issue array element is not an object");
-            }
-            const simdjson::dom::object &obj = item.get_object().value();
-            if (!obj.at_key("id").is_string())
-            {
-                std::ostringstream typeName;
-                typeName << obj.at_key("id").type();
-                throw std::runtime_error("Expected string value for key 'id', got " + typeName.str());
-            }
-            const int issueId = std::stoi(std::string{obj.at_key("id").get_string().value()});
-            return issueId == id;
-        });
-    if (it == m_issues.get_array().end())
+    printMatchingSequences(str, "pencils", m_sequences->pencils, name);
+}
+
+void ColumnDatabase::printInkSequences(std::ostream &str, const std::string &name)
+{
+    printMatchingSequences(str, "inks", m_sequences->inks, name);
+}
+
+void ColumnDatabase::printColorSequences(std::ostream &str, const std::string &name)
+{
+    printMatchingSequences(str, "colors", m_sequences->colors, name);
+}
+
+void ColumnDatabase::printLetterSequences(std::ostream &str, const std::string &name)
+{
+    printMatchingSequences(str, "letters", m_sequences->letters, name);
+}
+
+void ColumnDatabase::printIssue(OutputBuffer &out, int id) const
+{
+    const std::size_t *row;
+    {
+        const PhaseTimer timer{m_options.stats, Phase::JOIN};
+        addCount(m_options.stats, &QueryStats::joinLookups, 1);
+        row = m_issueIndex.find(id);
+    }
+    if (row == nullptr)
     {
         throw std::runtime_error("Couldn't find issue with id " + std::to_string(id));
     }
-    const simdjson::dom::object issue = (*it).get_object().value();
-    str << issue.at_key("series name").get_string().value() << " #" << issue.at_key("issue number").get_string().value() << '\n';
+    out << m_issues->seriesName[*row] << " #" << m_issues->issueNumber[*row] << '\n';
 }
 
-void JSONDatabase::printMatchingSequences(std::ostream &str, const std::string_view &fieldName, const std::string &name)
+void ColumnDatabase::printMatchingSequences(
+    std::ostream &str, std::string_view field, const StringColumn &column, const std::string &name)
 {
-    std::map<int, std::vector<simdjson::dom::object>> issueSequences;
+    QueryStats *stats{m_options.stats};
+    std::vector<KeyedRow> found;
+    const bool folded{m_matchMode == MatchMode::FOLDED};
+    const NeedleMatcher matcher{folded ? foldText(name) : name};
+    // folded names are searched for in the folded copy of the column
+    const StringColumn &searched{folded ? foldedColumn(column) : column};
+    const auto addRow = [&](std::size_t row)
+    {
+        found.push_back(
+            KeyedRow{sequenceKey(m_sequences->issue[row], m_sequences->sequenceNumber[row]), static_cast<std::uint32_t>(row)});
+    };
 
-    for (const simdjson::dom::element record : m_sequences.get_array())
+    const std::string key{m_cache ? queryKey(field, m_matchMode, name) : std::string{}};
+    const std::shared_ptr<const PostingList> cached{m_cache ? m_cache->find(key) : nullptr};
+    if (cached)
     {
-        if (!record.is_object())
+        addCount(stats, &QueryStats::cacheHits, 1);
+        for (const std::uint32_t row : *cached)
         {
-            throw std::runtime_error("Sequence array element should be an object");
+            addRow(row);
         }
-
-        for (const simdjson::dom::key_value_pair field : record.get_object())
+    }
+    else if (m_matchMode == MatchMode::CREATOR)
+    {
+        auto it = m_creditIndexes.find(&column);
+        if (it == m_creditIndexes.end())
+        {
+            const PhaseTimer timer{stats, Phase::INDEX};
+            it = m_creditIndexes.emplace(&column, buildCreditIndex(column)).first;
+        }
+        const PhaseTimer timer{stats, Phase::SCAN};
+        if (const PostingList *rows = it->second.find(name))
         {
-            if (field.key == fieldName)
+            addCount(stats, &QueryStats::recordsScanned, rows->size());
+            for (const std::uint32_t row : *rows)
             {
-                const simdjson::dom::element &value = field.value;
-                if (!value.is_string())
-                {
-                    throw std::runtime_error("Value of script field should be a string");
-                }
-                if (value.get_string().value().find(name) != std::string::npos)
+                addRow(row);
+            }
+        }
+    }
+    else if (m_matchMode == MatchMode::SUBSTRING && m_options.trigramIndex && name.length() >= TrigramIndex::MIN_NEEDLE)
+    {
+        auto it = m_trigramIndexes.find(&column);
+        if (it == m_trigramIndexes.end())
+        {
+            const PhaseTimer timer{stats, Phase::INDEX};
+            it = m_trigramIndexes.emplace(&column, buildTrigramIndex(column)).first;
+        }
+        const PhaseTimer timer{stats, Phase::SCAN};
+        const std::vector<std::uint32_t> candidates{it->second.candidates(name)};
+        addCount(stats, &QueryStats::recordsScanned, candidates.size());
+        for (const std::uint32_t row : candidates)
+        {
+            if (matcher.matches(column[row]))
+            {
+                addRow(row);
+            }
+        }
+    }
+    else if (m_pool)
+    {
+        const PhaseTimer timer{stats, Phase::SCAN};
+        addCount(stats, &QueryStats::recordsScanned, searched.size());
+        const std::vector<std::size_t> rows{parallelCollect<std::size_t>(*m_pool, searched.size(),
+            [&](std::size_t begin, std::size_t end, std::vector<std::size_t> &matches)
+            {
+                for (std::size_t row = findRow(searched, matcher, begin, end); row < end;
+                     row = findRow(searched, matcher, row + 1, end))
                 {
-                    simdjson::dom::object obj = record.get_object().value();
-                    const int issue = std::stoi(std::string{obj.at_key("issue").get_string().value()});
-                    issueSequences[issue].push_back(obj);
+                    matches.push_back(row);
                 }
-                break;
-            }
+            })};
+        for (const std::size_t row : rows)
+        {
+            addRow(row);
+        }
+    }
+    else
+    {
+        const PhaseTimer timer{stats, Phase::SCAN};
+        addCount(stats, &QueryStats::recordsScanned, searched.size());
+        for (std::size_t row = findRow(searched, matcher, 0); row < searched.size();
+             row = findRow(searched, matcher, row + 1))
+        {
+            addRow(row);
         }
     }
 
-    int firstIssue{true};
-    const auto sequence_number = [](const simdjson::dom::object &seq)
-        { return std::stoi(std::string{seq.at_key("sequence_number").get_string().value()}); };
-    for (const auto &[issueId, matches] : issueSequences)
+    if (m_cache && !cached)
     {
-        if (!firstIssue)
+        // every way of finding the rows finds them in ascending order
+        PostingList rows;
+        for (const KeyedRow &match : found)
         {
-            str << '\n';
+            rows.append(match.row);
         }
-        printIssue(str, issueId);
-
-        std::vector sequences{matches};
-        std::sort(sequences.begin(), sequences.end(),
-            [&](const simdjson::dom::object &lhs, const simdjson::dom::object &rhs)
-            { return sequence_number(lhs) < sequence_number(rhs); });
-        bool first{true};
-        for (const simdjson::dom::object &seq : sequences)
+        m_cache->insert(key, std::move(rows));
+    }
+
+    {
+        const PhaseTimer timer{stats, Phase::SORT};
+        sortKeyedRows(found);
+    }
+    addCount(stats, &QueryStats::matches, found.size());
+    const PhaseTimer timer{stats, Phase::OUTPUT};
+    OutputBuffer out{str};
+    int lastIssue{-1};
+    for (const KeyedRow &match : found)
+    {
+        const int issue{keyIssue(match.key)};
+        if (issue != lastIssue)
         {
-            if (!first)
+            if (lastIssue != -1)
             {
-                str << '\n';
+                out << '\n';
             }
-            printSequence(str, seq);
-            first = false;
+            printIssue(out, issue);
         }
-        firstIssue = false;
+        else
+        {
+            out << '\n';
+        }
+        formatSequence(out, *m_sequences, match.row);
+        lastIssue = issue;
     }
+    out.flush();
+    addCount(stats, &QueryStats::outputBytes, out.written());
+}
+
+// The JSON files, keeping only the fields queries read; the documents are freed after loading.
+class JSONDatabase : public ColumnDatabase
+{
+public:
+    JSONDatabase(const JSONPaths &paths, const DatabaseOptions &options);
+
+private:
+    TableWriter m_issueColumns{ISSUE_COLUMNS};
+    TableWriter m_sequenceColumns{SEQUENCE_COLUMNS};
+};
+
+JSONDatabase::JSONDatabase(const JSONPaths &paths, const DatabaseOptions &options) :
+    ColumnDatabase(options)
+{
+    simdjson::dom::parser issueParser;
+    simdjson::simdjson_result<simdjson::dom::element> issues;
+    simdjson::dom::parser sequenceParser;
+    simdjson::simdjson_result<simdjson::dom::element> sequences;
+    loadJSONFiles(paths, issueParser, issues, sequenceParser, sequences, options.stats);
+    {
+        const PhaseTimer timer{options.stats, Phase::PROJECT};
+        projectRecords(m_issueColumns, ISSUE_COLUMNS, issues.value());
+        projectRecords(m_sequenceColumns, SEQUENCE_COLUMNS, sequences.value());
+    }
+    setTables(m_issueColumns.table(), m_sequenceColumns.table());
+    openCache(paths.issues, paths.sequences);
+}
+
+class SnapshotDatabase : public ColumnDatabase
+{
+public:
+    SnapshotDatabase(const SnapshotPaths &paths, const DatabaseOptions &options);
+
+private:
+    Snapshot m_issueSnapshot;
+    Snapshot m_sequenceSnapshot;
+};
+
+SnapshotDatabase::SnapshotDatabase(const SnapshotPaths &paths, const DatabaseOptions &options) :
+    ColumnDatabase(options),
+    m_issueSnapshot(paths.issues),
+    m_sequenceSnapshot(paths.sequences)
+{
+    // the snapshots are read as the mapping is used, so only their sizes are counted
+    addCount(options.stats, &QueryStats::bytesRead,
+        std::filesystem::file_size(paths.issues) + std::filesystem::file_size(paths.sequences));
+    setTables(m_issueSnapshot.table(), m_sequenceSnapshot.table());
+    openCache(paths.issues, paths.sequences);
+    // mapping is immediate; keep the same progress output as the JSON database
+    std::cout << "Reading issues...\ndone.\nReading sequences...\ndone.\n";
 }
 
 } // namespace
 
-std::shared_ptr<Database> createDatabase(const std::filesystem::path &jsonDir)
+std::shared_ptr<Database> createDatabase(const std::filesystem::path &jsonDir, const DatabaseOptions &options)
 {
-    return std::make_shared<JSONDatabase>(jsonDir);
+    const TraceSpan span{"load database"};
+    if (const std::optional<SnapshotPaths> snapshots = findSnapshots(jsonDir))
+    {
+        return std::make_shared<SnapshotDatabase>(*snapshots, options);
+    }
+    return std::make_shared<JSONDatabase>(findJSONFiles(jsonDir), options);
 }
 
 } // namespace comics
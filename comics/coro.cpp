@@ -1,8 +1,27 @@
 #include <comics/coro.h>
+#include <comics/fold.h>
+#include <comics/issue-index.h>
+#include <comics/json-chunks.h>
+#include <comics/json-files.h>
+#include <comics/matcher.h>
+#include <comics/multi-matcher.h>
+#include <comics/ndjson.h>
+#include <comics/projection.h>
+#include <comics/query-cache.h>
+#include <comics/snapshot.h>
+#include <comics/sort-keys.h>
+#include <comics/stats.h>
 
+#include <algorithm>
+#include <array>
 #include <coroutine>
-#include <map>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 namespace comics
 {
@@ -11,32 +30,7 @@ namespace coroutine
 namespace
 {
 
-simdjson::dom::object find_issue(DatabasePtr db, int issue)
-{
-    simdjson::dom::array issues = db->getIssues().get_array();
-    const auto it = std::find_if(issues.begin(), issues.end(),
-        [=](const simdjson::dom::element &item)
-        {
-            if (!item.is_object())
-            {
-                throw std::runtime_error("Issue array element is not an object");
-            }
-            const simdjson::dom::object &obj = item.get_object().value();
-            if (!obj.at_key("id").is_string())
-            {
-                std::ostringstream typeName;
-                typeName << obj.at_key("id").type();
-                throw std::runtime_error("Expected string value for key 'id', got " + typeName.str());
-            }
-            const int issueId = std::stoi(std::string{obj.at_key("id").get_string().value()});
-            return issueId == issue;
-        });
-    if (it == issues.end())
-    {
-        throw std::runtime_error("Couldn't find issue with id " + std::to_string(issue));
-    }
-    return (*it).get_object().value();
-}
+constexpr std::size_t CREDIT_FIELD_COUNT{static_cast<std::size_t>(CreditField::LETTER) + 1};
 
 static std::string_view to_string(CreditField field)
 {
@@ -58,15 +52,163 @@ static std::string_view to_string(CreditField field)
     return "?";
 }
 
-inline bool endsWith(const std::string &text, const std::string &suffix)
+// A database scanned through in-memory columns of the fields queries read, so a credit query
+// streams one contiguous column rather than every key of every record.
+class ColumnDatabase : public Database
+{
+public:
+    explicit ColumnDatabase(const DatabaseOptions &options);
+    ~ColumnDatabase() override = default;
+
+    const Table *getIssueTable() const override
+    {
+        return &m_issues;
+    }
+    const Table *getSequenceTable() const override
+    {
+        return &m_sequences;
+    }
+    std::size_t findIssueRow(int id) const override;
+    const CreditIndex *getCreditIndex(CreditField field) const override;
+    const TrigramIndex *getTrigramIndex(CreditField field) const override;
+    const StringColumn *getFoldedCredits(CreditField field) const override;
+    ThreadPool *getThreadPool() const override
+    {
+        return m_pool.get();
+    }
+    QueryStats *getStats() const override
+    {
+        return m_options.stats;
+    }
+    QueryCache *getQueryCache() const override
+    {
+        return m_cache.get();
+    }
+
+protected:
+    void setTables(const Table &issues, const Table &sequences);
+    // Open the query cache the options ask for, for the files the tables were loaded from.
+    void openCache(const std::filesystem::path &issues, const std::filesystem::path &sequences);
+
+private:
+    Table m_issues;
+    Table m_sequences;
+    IssueRowIndex m_issueIndex;
+    DatabaseOptions m_options;
+    // built on first use, as most runs only query one field
+    mutable std::array<std::once_flag, CREDIT_FIELD_COUNT> m_creditIndexBuilt;
+    mutable std::array<CreditIndex, CREDIT_FIELD_COUNT> m_creditIndexes;
+    mutable std::array<std::once_flag, CREDIT_FIELD_COUNT> m_trigramIndexBuilt;
+    mutable std::array<TrigramIndex, CREDIT_FIELD_COUNT> m_trigramIndexes;
+    mutable std::array<std::once_flag, CREDIT_FIELD_COUNT> m_foldedCreditsBuilt;
+    mutable std::array<FoldedColumn, CREDIT_FIELD_COUNT> m_foldedCredits;
+    mutable std::array<StringColumn, CREDIT_FIELD_COUNT> m_foldedColumns;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::unique_ptr<QueryCache> m_cache;
+};
+
+ColumnDatabase::ColumnDatabase(const DatabaseOptions &options) :
+    m_options(options)
+{
+    if (m_options.threads > 1)
+    {
+        m_pool = std::make_unique<ThreadPool>(m_options.threads);
+    }
+}
+
+void ColumnDatabase::setTables(const Table &issues, const Table &sequences)
+{
+    m_issues = issues;
+    m_sequences = sequences;
+    {
+        const PhaseTimer timer{m_options.stats, Phase::INDEX};
+        m_issueIndex = buildIssueRowIndex(IssueColumns{m_issues}.id);
+    }
+    if (m_options.foldCredits)
+    {
+        for (const CreditField field :
+            {CreditField::SCRIPT, CreditField::PENCIL, CreditField::INK, CreditField::COLOR, CreditField::LETTER})
+        {
+            getFoldedCredits(field);
+        }
+    }
+}
+
+void ColumnDatabase::openCache(const std::filesystem::path &issues, const std::filesystem::path &sequences)
+{
+    m_cache = openQueryCache(m_options, issues, sequences);
+}
+
+std::size_t ColumnDatabase::findIssueRow(int id) const
+{
+    const std::size_t *row = m_issueIndex.find(id);
+    if (row == nullptr)
+    {
+        throw std::runtime_error("Couldn't find issue with id " + std::to_string(id));
+    }
+    return *row;
+}
+
+const CreditIndex *ColumnDatabase::getCreditIndex(CreditField field) const
+{
+    const SequenceColumns sequences{m_sequences};
+    const StringColumn *column = sequences.credit(to_string(field));
+    if (column == nullptr)
+    {
+        return nullptr;
+    }
+    const std::size_t pos{static_cast<std::size_t>(field)};
+    std::call_once(m_creditIndexBuilt[pos],
+        [&]
+        {
+            const PhaseTimer timer{m_options.stats, Phase::INDEX};
+            m_creditIndexes[pos] = buildCreditIndex(*column);
+        });
+    return &m_creditIndexes[pos];
+}
+
+const TrigramIndex *ColumnDatabase::getTrigramIndex(CreditField field) const
+{
+    const SequenceColumns sequences{m_sequences};
+    const StringColumn *column = sequences.credit(to_string(field));
+    if (!m_options.trigramIndex || column == nullptr)
+    {
+        return nullptr;
+    }
+    const std::size_t pos{static_cast<std::size_t>(field)};
+    std::call_once(m_trigramIndexBuilt[pos],
+        [&]
+        {
+            const PhaseTimer timer{m_options.stats, Phase::INDEX};
+            m_trigramIndexes[pos] = buildTrigramIndex(*column);
+        });
+    return &m_trigramIndexes[pos];
+}
+
+const StringColumn *ColumnDatabase::getFoldedCredits(CreditField field) const
 {
-    return text.length() >= suffix.length() && text.substr(text.length() - suffix.length()) == suffix;
+    const SequenceColumns sequences{m_sequences};
+    const StringColumn *column = sequences.credit(to_string(field));
+    if (column == nullptr)
+    {
+        return nullptr;
+    }
+    const std::size_t pos{static_cast<std::size_t>(field)};
+    std::call_once(m_foldedCreditsBuilt[pos],
+        [&]
+        {
+            const PhaseTimer timer{m_options.stats, Phase::PROJECT};
+            m_foldedCredits[pos] = FoldedColumn{*column};
+            m_foldedColumns[pos] = m_foldedCredits[pos].column();
+        });
+    return &m_foldedColumns[pos];
 }
 
-class JSONDatabase : public Database
+// The JSON documents, with the fields queries read projected into columns at load.
+class JSONDatabase : public ColumnDatabase
 {
 public:
-    JSONDatabase(const std::filesystem::path &jsonDir);
+    JSONDatabase(const JSONPaths &paths, const DatabaseOptions &options);
     ~JSONDatabase() override = default;
 
     simdjson::simdjson_result<simdjson::dom::element> getIssues() const override
@@ -83,68 +225,438 @@ private:
     simdjson::simdjson_result<simdjson::dom::element> m_issues;
     simdjson::dom::parser m_sequenceParser;
     simdjson::simdjson_result<simdjson::dom::element> m_sequences;
+    TableWriter m_issueColumns{ISSUE_COLUMNS};
+    TableWriter m_sequenceColumns{SEQUENCE_COLUMNS};
+};
+
+JSONDatabase::JSONDatabase(const JSONPaths &paths, const DatabaseOptions &options) :
+    ColumnDatabase(options)
+{
+    loadJSONFiles(paths, m_issueParser, m_issues, m_sequenceParser, m_sequences, options.stats);
+    {
+        const PhaseTimer timer{options.stats, Phase::PROJECT};
+        projectRecords(m_issueColumns, ISSUE_COLUMNS, m_issues.value());
+        projectRecords(m_sequenceColumns, SEQUENCE_COLUMNS, m_sequences.value());
+    }
+    setTables(m_issueColumns.table(), m_sequenceColumns.table());
+    openCache(paths.issues, paths.sequences);
+}
+
+class SnapshotDatabase : public ColumnDatabase
+{
+public:
+    SnapshotDatabase(const SnapshotPaths &paths, const DatabaseOptions &options);
+    ~SnapshotDatabase() override = default;
+
+    simdjson::simdjson_result<simdjson::dom::element> getIssues() const override
+    {
+        return simdjson::UNINITIALIZED;
+    }
+    simdjson::simdjson_result<simdjson::dom::element> getSequences() const override
+    {
+        return simdjson::UNINITIALIZED;
+    }
+    simdjson::dom::object findIssue(int) const override
+    {
+        throw std::runtime_error("Snapshot database has no JSON issues");
+    }
+
+private:
+    Snapshot m_issueSnapshot;
+    Snapshot m_sequenceSnapshot;
+};
+
+SnapshotDatabase::SnapshotDatabase(const SnapshotPaths &paths, const DatabaseOptions &options) :
+    ColumnDatabase(options),
+    m_issueSnapshot(paths.issues),
+    m_sequenceSnapshot(paths.sequences)
+{
+    // the snapshots are read as the mapping is used, so only their sizes are counted
+    addCount(options.stats, &QueryStats::bytesRead,
+        std::filesystem::file_size(paths.issues) + std::filesystem::file_size(paths.sequences));
+    setTables(m_issueSnapshot.table(), m_sequenceSnapshot.table());
+    openCache(paths.issues, paths.sequences);
+    // mapping is immediate; keep the same progress output as the JSON database
+    std::cout << "Reading issues...\ndone.\nReading sequences...\ndone.\n";
+}
+
+template <typename Reader>
+std::unique_ptr<RecordReader> openRecords(const std::filesystem::path &path, std::size_t window)
+{
+    return std::make_unique<Reader>(path, window);
+}
+
+// Only the issue columns are held in memory; the sequences are streamed from disk by each query,
+// either from NDJSON files or in chunks of JSON array files, so memory use doesn't depend on the
+// number of sequences.
+class StreamingDatabase : public Database
+{
+public:
+    using OpenRecords = std::unique_ptr<RecordReader> (*)(const std::filesystem::path &path, std::size_t window);
+
+    StreamingDatabase(const std::filesystem::path &issuesPath, const std::filesystem::path &sequencesPath,
+        OpenRecords open, std::size_t window, const DatabaseOptions &options);
+    ~StreamingDatabase() override = default;
+
+    simdjson::simdjson_result<simdjson::dom::element> getIssues() const override
+    {
+        return simdjson::UNINITIALIZED;
+    }
+    simdjson::simdjson_result<simdjson::dom::element> getSequences() const override
+    {
+        return simdjson::UNINITIALIZED;
+    }
+    simdjson::dom::object findIssue(int) const override
+    {
+        throw std::runtime_error("Streaming database has no JSON issues");
+    }
+    const Table *getIssueTable() const override
+    {
+        return &m_issues;
+    }
+    std::size_t findIssueRow(int id) const override;
+    std::unique_ptr<RecordReader> streamSequences() const override
+    {
+        addCount(m_stats, &QueryStats::bytesRead, std::filesystem::file_size(m_sequencesPath));
+        return m_open(m_sequencesPath, m_window);
+    }
+    QueryStats *getStats() const override
+    {
+        return m_stats;
+    }
+
+private:
+    std::filesystem::path m_sequencesPath;
+    OpenRecords m_open;
+    std::size_t m_window;
+    QueryStats *m_stats;
+    // only the issue columns needed to print a match are kept
+    TableWriter m_issueWriter{ISSUE_COLUMNS};
+    Table m_issues;
+    IssueRowIndex m_issueIndex;
 };
 
-JSONDatabase::JSONDatabase(const std::filesystem::path &jsonDir)
+StreamingDatabase::StreamingDatabase(const std::filesystem::path &issuesPath,
+    const std::filesystem::path &sequencesPath, OpenRecords open, std::size_t window,
+    const DatabaseOptions &options) :
+    m_sequencesPath(sequencesPath),
+    m_open(open),
+    m_window(window),
+    m_stats(options.stats)
+{
+    std::cout << "Reading issues...\n";
+    addCount(m_stats, &QueryStats::bytesRead, std::filesystem::file_size(issuesPath));
+    {
+        // the issues are read and parsed a window at a time, so the two aren't told apart
+        const PhaseTimer timer{m_stats, Phase::PARSE};
+        const std::unique_ptr<RecordReader> issues{m_open(issuesPath, m_window)};
+        readIssueTable(*issues, m_issueWriter);
+    }
+    m_issues = m_issueWriter.table();
+    const PhaseTimer timer{m_stats, Phase::INDEX};
+    m_issueIndex = buildIssueRowIndex(IssueColumns{m_issues}.id);
+    // sequences are streamed by each query
+    std::cout << "done.\nReading sequences...\ndone.\n";
+}
+
+std::size_t StreamingDatabase::findIssueRow(int id) const
+{
+    const std::size_t *row = m_issueIndex.find(id);
+    if (row == nullptr)
+    {
+        throw std::runtime_error("Couldn't find issue with id " + std::to_string(id));
+    }
+    return *row;
+}
+
+// Look up the issue of a match in the issue table or the JSON issues, timing and counting the join.
+std::size_t joinIssueRow(const Database &database, int issue)
+{
+    QueryStats *stats{database.getStats()};
+    const PhaseTimer timer{stats, Phase::JOIN};
+    addCount(stats, &QueryStats::joinLookups, 1);
+    return database.findIssueRow(issue);
+}
+
+simdjson::dom::object joinIssue(const Database &database, int issue)
+{
+    QueryStats *stats{database.getStats()};
+    const PhaseTimer timer{stats, Phase::JOIN};
+    addCount(stats, &QueryStats::joinLookups, 1);
+    return database.findIssue(issue);
+}
+
+// The folded text of a credit for a MatchMode::FOLDED search where there's no folded column;
+// valid until the next call on the same thread.
+std::string_view foldCredits(std::string_view credits)
+{
+    thread_local std::string folded;
+    folded.clear();
+    appendFolded(folded, credits);
+    return folded;
+}
+
+// Take every match of a scan and order them by issue and sequence number.
+std::vector<SequenceMatch> sortMatches(const Database &database, MatchGenerator &scan)
 {
-    bool foundIssues{false};
-    bool foundSequences{false};
-    for (const auto &entry : std::filesystem::directory_iterator(jsonDir))
+    const Table *table = database.getSequenceTable();
+    std::optional<SequenceColumns> sequences;
+    if (table != nullptr)
+    {
+        sequences.emplace(*table);
+    }
+    std::vector<SequenceMatch> found;
+    std::vector<KeyedRow> keys;
+    for (std::span<const SequenceMatch> batch = scan.resumeBatch(256); !batch.empty(); batch = scan.resumeBatch(256))
     {
-        if (!entry.is_regular_file())
+        if (scan.transient())
         {
-            continue;
+            throw std::runtime_error("Ordered matches need the sequences in memory");
+        }
+        for (const SequenceMatch &match : batch)
+        {
+            const SequenceKey key{match.sequenceRow != NO_ROW
+                    ? sequenceKey(sequences->issue[match.sequenceRow], sequences->sequenceNumber[match.sequenceRow])
+                    : sequenceKey(match.sequence)};
+            keys.push_back(KeyedRow{key, static_cast<std::uint32_t>(found.size())});
+            found.push_back(match);
+        }
+    }
+    const PhaseTimer timer{database.getStats(), Phase::SORT};
+    sortKeyedRows(keys);
+    std::vector<SequenceMatch> sorted;
+    sorted.reserve(found.size());
+    for (const KeyedRow &key : keys)
+    {
+        sorted.push_back(std::move(found[key.row]));
+    }
+    return sorted;
+}
+
+} // namespace
+
+std::size_t Database::findIssueRow(int) const
+{
+    throw std::runtime_error("Database has no issue table");
+}
+
+simdjson::dom::object Database::findIssue(int id) const
+{
+    simdjson::dom::array issues = getIssues().get_array();
+    const auto it = std::find_if(issues.begin(), issues.end(),
+        [=](const simdjson::dom::element &item)
+        {
+            if (!item.is_object())
+            {
+                throw std::runtime_error("Issue array element is not an object");
+            }
+            const simdjson::dom::object &obj = item.get_object().value();
+            if (!obj.at_key("id").is_string())
+            {
+                std::ostringstream typeName;
+                typeName << obj.at_key("id").type();
+                throw std::runtime_error("Expected string value for key 'id', got " + typeName.str());
+            }
+            return parseId(obj.at_key("id").get_string().value()) == id;
+        });
+    if (it == issues.end())
+    {
+        throw std::runtime_error("Couldn't find issue with id " + std::to_string(id));
+    }
+    return (*it).get_object().value();
+}
+
+namespace
+{
+
+MatchGenerator scanMatches(
+    DatabasePtr database, CreditField creditField, std::string_view name, MatchMode mode, MatchOrder order)
+{
+    if (!database)
+    {
+        co_return;
+    }
+    if (order == MatchOrder::SEQUENCE)
+    {
+        MatchGenerator scan{matches(database, creditField, name, mode)};
+        std::vector<SequenceMatch> sorted{sortMatches(*database, scan)};
+        for (SequenceMatch &match : sorted)
+        {
+            co_yield std::move(match);
+        }
+        co_return;
+    }
+
+    // sequences are grouped by issue, so remember the last join
+    int lastIssueId{-1};
+    QueryStats *stats{database->getStats()};
+    std::string_view fieldName{to_string(creditField)};
+    const std::string creator{mode == MatchMode::CREATOR ? normalizeCreator(name) : std::string{}};
+    const std::string folded{mode == MatchMode::FOLDED ? foldText(name) : std::string{}};
+    const NeedleMatcher matcher{mode == MatchMode::FOLDED ? std::string_view{folded} : name};
+    const auto matchesName = [&](std::string_view credits)
+    {
+        if (mode == MatchMode::CREATOR)
+        {
+            return creditsName(credits, creator);
+        }
+        return matcher.matches(mode == MatchMode::FOLDED ? foldCredits(credits) : credits);
+    };
+
+    if (const CreditIndex *index = mode == MatchMode::CREATOR ? database->getCreditIndex(creditField) : nullptr)
+    {
+        const PostingList *rows = index->find(creator);
+        if (rows == nullptr)
+        {
+            co_return;
         }
-        const std::filesystem::path &path{entry.path()};
-        const std::string filename{path.filename().string()};
-        if (endsWith(filename, "issues.json"))
+        addCount(stats, &QueryStats::recordsScanned, rows->size());
+        // only databases with tables index their credits
+        const SequenceColumns sequences{*database->getSequenceTable()};
+        std::size_t lastIssueRow{NO_ROW};
+        for (const std::uint32_t row : *rows)
         {
-            std::cout << "Reading issues...\n";
-            m_issues = m_issueParser.load(path.string());
-            foundIssues = true;
-            std::cout << "done.\n";
-            if (!m_issues.is_array())
+            const int issue = sequences.issue[row];
+            if (issue != lastIssueId)
             {
-                throw std::runtime_error("JSON issues file should be an array of objects");
+                lastIssueRow = joinIssueRow(*database, issue);
+                lastIssueId = issue;
             }
+            co_yield SequenceMatch{{}, {}, lastIssueRow, row};
         }
-        else if (endsWith(filename, "sequences.json"))
+        co_return;
+    }
+
+    const TrigramIndex *trigrams = mode == MatchMode::SUBSTRING && name.length() >= TrigramIndex::MIN_NEEDLE
+        ? database->getTrigramIndex(creditField)
+        : nullptr;
+    if (trigrams != nullptr)
+    {
+        const std::vector<std::uint32_t> rows{trigrams->candidates(name)};
+        addCount(stats, &QueryStats::recordsScanned, rows.size());
+        // only databases with tables build trigram indexes
+        const SequenceColumns sequences{*database->getSequenceTable()};
+        const StringColumn &column = *sequences.credit(fieldName);
+        std::size_t lastIssueRow{NO_ROW};
+        for (const std::uint32_t row : rows)
         {
-            std::cout << "Reading sequences...\n";
-            m_sequences = m_sequenceParser.load(path.string());
-            foundSequences = true;
-            std::cout << "done.\n";
-            if (!m_sequences.is_array())
+            if (!matcher.matches(column[row]))
+            {
+                continue;
+            }
+            const int issue = sequences.issue[row];
+            if (issue != lastIssueId)
             {
-                throw std::runtime_error("JSON sequences file should be an array of objects");
+                lastIssueRow = joinIssueRow(*database, issue);
+                lastIssueId = issue;
             }
+            co_yield SequenceMatch{{}, {}, lastIssueRow, row};
         }
+        co_return;
     }
-    if (!(foundIssues && foundSequences))
+
+    if (const Table *table = database->getSequenceTable())
     {
-        if (foundIssues)
+        const SequenceColumns sequences{*table};
+        // folded names are searched for in the folded copy of the column
+        const StringColumn *column =
+            mode == MatchMode::FOLDED ? database->getFoldedCredits(creditField) : sequences.credit(fieldName);
+        if (column == nullptr)
+        {
+            co_return;
+        }
+        addCount(stats, &QueryStats::recordsScanned, column->size());
+        // substrings are found by searching the column's blob directly
+        const auto nextRow = [&](std::size_t row, std::size_t end)
+        {
+            if (mode != MatchMode::CREATOR)
+            {
+                return findRow(*column, matcher, row, end);
+            }
+            while (row < end && !(column->present(row) && matchesName((*column)[row])))
+            {
+                ++row;
+            }
+            return row;
+        };
+        std::size_t lastIssueRow{NO_ROW};
+        if (ThreadPool *pool = database->getThreadPool())
         {
-            throw std::runtime_error("Couldn't find sequences JSON file in " + jsonDir.string());
+            // scan the parts concurrently, then yield in row order just as the serial scan does
+            const std::vector<std::size_t> rows{parallelCollect<std::size_t>(*pool, column->size(),
+                [&](std::size_t begin, std::size_t end, std::vector<std::size_t> &found)
+                {
+                    for (std::size_t row = nextRow(begin, end); row < end; row = nextRow(row + 1, end))
+                    {
+                        found.push_back(row);
+                    }
+                })};
+            for (const std::size_t row : rows)
+            {
+                const int issue = sequences.issue[row];
+                if (issue != lastIssueId)
+                {
+                    lastIssueRow = joinIssueRow(*database, issue);
+                    lastIssueId = issue;
+                }
+                co_yield SequenceMatch{{}, {}, lastIssueRow, row};
+            }
+            co_return;
         }
-        if (foundSequences)
+        for (std::size_t row = nextRow(0, column->size()); row < column->size();
+             row = nextRow(row + 1, column->size()))
         {
-            throw std::runtime_error("Couldn't find issues JSON file in " + jsonDir.string());
+            const int issue = sequences.issue[row];
+            if (issue != lastIssueId)
+            {
+                lastIssueRow = joinIssueRow(*database, issue);
+                lastIssueId = issue;
+            }
+            co_yield SequenceMatch{{}, {}, lastIssueRow, row};
         }
-        throw std::runtime_error("Couldn't find either issues or sequences JSON file in " + jsonDir.string());
+        co_return;
     }
-}
-
-} // namespace
 
-MatchGenerator matches(DatabasePtr database, CreditField creditField, std::string_view name)
-{
-    if (!database)
+    if (const std::unique_ptr<RecordReader> stream = database->streamSequences())
     {
+        std::size_t lastIssueRow{NO_ROW};
+        simdjson::dom::element record;
+        while (stream->next(record))
+        {
+            addCount(stats, &QueryStats::recordsScanned, 1);
+            if (!record.is_object())
+            {
+                throw std::runtime_error("Sequence record should be an object");
+            }
+            const simdjson::dom::object sequence{record.get_object()};
+            const simdjson::simdjson_result<simdjson::dom::element> value = sequence.at_key(fieldName);
+            if (value.error() == simdjson::NO_SUCH_FIELD)
+            {
+                continue;
+            }
+            if (!value.is_string())
+            {
+                throw std::runtime_error("Value of script field should be a string");
+            }
+            if (matchesName(value.get_string().value()))
+            {
+                const int issue = parseId(sequence.at_key("issue").get_string().value());
+                if (issue != lastIssueId)
+                {
+                    lastIssueRow = joinIssueRow(*database, issue);
+                    lastIssueId = issue;
+                }
+                co_yield TransientMatch{{{}, sequence, lastIssueRow}};
+            }
+        }
         co_return;
     }
 
-    std::map<int, simdjson::dom::object> issues;
-    std::string_view fieldName{to_string(creditField)};
+    simdjson::dom::object lastIssue;
+    if (stats != nullptr)
+    {
+        addCount(stats, &QueryStats::recordsScanned, database->getSequences().get_array().size());
+    }
 
     for (const simdjson::dom::element record : database->getSequences().get_array())
     {
@@ -163,15 +675,16 @@ MatchGenerator matches(DatabasePtr database, CreditField creditField, std::strin
                 {
                     throw std::runtime_error("Value of script field should be a string");
                 }
-                if (value.get_string().value().find(name) != std::string::npos)
+                if (matchesName(value.get_string().value()))
                 {
                     simdjson::dom::object obj = record.get_object().value();
-                    const int issue = std::stoi(std::string{obj.at_key("issue").get_string().value()});
-                    if (auto it = issues.find(issue); it == issues.end())
+                    const int issue = parseId(obj.at_key("issue").get_string().value());
+                    if (issue != lastIssueId)
                     {
-                        issues[issue] = find_issue(database, issue);
+                        lastIssue = joinIssue(*database, issue);
+                        lastIssueId = issue;
                     }
-                    co_yield SequenceMatch{issues[issue], sequence};
+                    co_yield SequenceMatch{lastIssue, sequence};
                 }
                 break;
             }
@@ -179,9 +692,682 @@ MatchGenerator matches(DatabasePtr database, CreditField creditField, std::strin
     }
 }
 
-DatabasePtr createDatabase(const std::filesystem::path &jsonDir)
+// Yield the cached rows of a query, or scan for them and cache the rows once the scan has ended.
+MatchGenerator cachedMatches(
+    DatabasePtr database, QueryCache &cache, CreditField creditField, std::string_view name, MatchMode mode)
 {
-    return std::make_shared<JSONDatabase>(jsonDir);
+    QueryStats *stats{database->getStats()};
+    const std::string key{queryKey(to_string(creditField), mode, name)};
+    if (const std::shared_ptr<const PostingList> rows = cache.find(key))
+    {
+        addCount(stats, &QueryStats::cacheHits, 1);
+        const SequenceColumns sequences{*database->getSequenceTable()};
+        int lastIssueId{-1};
+        std::size_t lastIssueRow{NO_ROW};
+        for (const std::uint32_t row : *rows)
+        {
+            const int issue = sequences.issue[row];
+            if (issue != lastIssueId)
+            {
+                lastIssueRow = joinIssueRow(*database, issue);
+                lastIssueId = issue;
+            }
+            co_yield SequenceMatch{{}, {}, lastIssueRow, row};
+        }
+        co_return;
+    }
+
+    // table scans find rows in ascending order, as a posting list stores them
+    MatchGenerator scan{scanMatches(database, creditField, name, mode, MatchOrder::SCAN)};
+    PostingList rows;
+    for (std::span<const SequenceMatch> batch = scan.resumeBatch(256); !batch.empty(); batch = scan.resumeBatch(256))
+    {
+        for (const SequenceMatch &match : batch)
+        {
+            rows.append(static_cast<std::uint32_t>(match.sequenceRow));
+            co_yield match;
+        }
+    }
+    cache.insert(key, std::move(rows));
+}
+
+// A predicate of a credit query, with its name prepared for matching.
+struct Condition
+{
+    Condition(const CreditPredicate &predicate, MatchMode mode) :
+        field(predicate.field),
+        fieldName(to_string(predicate.field)),
+        name(predicate.name),
+        mode(mode),
+        creator(mode == MatchMode::CREATOR ? normalizeCreator(name) : std::string{}),
+        matcher(mode == MatchMode::FOLDED ? std::string_view{foldText(name)} : name)
+    {
+    }
+
+    // Whether credits match; folded credits are folded already.
+    bool matches(std::string_view credits, bool folded) const
+    {
+        if (mode == MatchMode::CREATOR)
+        {
+            return creditsName(credits, creator);
+        }
+        return matcher.matches(mode == MatchMode::FOLDED && !folded ? foldCredits(credits) : credits);
+    }
+
+    // The first row in [row, end) of the field's column that matches, or end.
+    std::size_t find(const StringColumn &column, std::size_t row, std::size_t end) const
+    {
+        if (mode != MatchMode::CREATOR)
+        {
+            return findRow(column, matcher, row, end);
+        }
+        while (row < end && !(column.present(row) && creditsName(column[row], creator)))
+        {
+            ++row;
+        }
+        return row;
+    }
+
+    CreditField field;
+    std::string_view fieldName;
+    std::string_view name;
+    MatchMode mode;
+    std::string creator;
+    NeedleMatcher matcher;
+};
+
+// Rows in every posting list, walking the smallest and skipping through the others.
+std::vector<std::uint32_t> intersectPostings(std::vector<const PostingList *> lists)
+{
+    std::sort(lists.begin(), lists.end(),
+        [](const PostingList *lhs, const PostingList *rhs) { return lhs->size() < rhs->size(); });
+    std::vector<PostingList::Iterator> others;
+    for (auto it = std::next(lists.begin()); it != lists.end(); ++it)
+    {
+        others.push_back((*it)->begin());
+    }
+    std::vector<std::uint32_t> rows;
+    for (const std::uint32_t row : *lists.front())
+    {
+        bool inAll{true};
+        for (PostingList::Iterator &other : others)
+        {
+            while (other != PostingList::Iterator{} && *other < row)
+            {
+                ++other;
+            }
+            if (other == PostingList::Iterator{})
+            {
+                return rows;
+            }
+            inAll = inAll && *other == row;
+        }
+        if (inAll)
+        {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+// Rows in all, or any, of several ascending row lists; intersections start from the shortest.
+std::vector<std::uint32_t> combineRows(std::vector<std::vector<std::uint32_t>> lists, Combine combine)
+{
+    std::sort(lists.begin(), lists.end(),
+        [](const std::vector<std::uint32_t> &lhs, const std::vector<std::uint32_t> &rhs)
+        { return lhs.size() < rhs.size(); });
+    std::vector<std::uint32_t> rows{std::move(lists.front())};
+    std::vector<std::uint32_t> combined;
+    for (auto it = std::next(lists.begin()); it != lists.end() && !(combine == Combine::ALL && rows.empty()); ++it)
+    {
+        combined.clear();
+        if (combine == Combine::ALL)
+        {
+            std::set_intersection(rows.begin(), rows.end(), it->begin(), it->end(), std::back_inserter(combined));
+        }
+        else
+        {
+            std::set_union(rows.begin(), rows.end(), it->begin(), it->end(), std::back_inserter(combined));
+        }
+        rows.swap(combined);
+    }
+    return rows;
+}
+
+} // namespace
+
+MatchGenerator matches(
+    DatabasePtr database, CreditField creditField, std::string_view name, MatchMode mode, MatchOrder order)
+{
+    QueryCache *cache{database ? database->getQueryCache() : nullptr};
+    if (cache != nullptr && order == MatchOrder::SCAN && database->getSequenceTable() != nullptr)
+    {
+        return cachedMatches(std::move(database), *cache, creditField, name, mode);
+    }
+    return scanMatches(std::move(database), creditField, name, mode, order);
+}
+
+MatchGenerator matches(DatabasePtr database, CreditField creditField, std::span<const std::string_view> names,
+    MatchMode mode, MatchOrder order)
+{
+    if (!database || names.empty())
+    {
+        co_return;
+    }
+    if (order == MatchOrder::SEQUENCE)
+    {
+        MatchGenerator scan{matches(database, creditField, names, mode)};
+        std::vector<SequenceMatch> sorted{sortMatches(*database, scan)};
+        for (SequenceMatch &match : sorted)
+        {
+            co_yield std::move(match);
+        }
+        co_return;
+    }
+
+    int lastIssueId{-1};
+    QueryStats *stats{database->getStats()};
+    std::string_view fieldName{to_string(creditField)};
+    std::vector<std::string> foldedNames;
+    std::vector<std::string_view> needles(names.begin(), names.end());
+    if (mode == MatchMode::FOLDED)
+    {
+        std::transform(names.begin(), names.end(), std::back_inserter(foldedNames), foldText);
+        needles.assign(foldedNames.begin(), foldedNames.end());
+    }
+    const MultiMatcher matcher{needles};
+    // normalized creator to the positions of the names normalizing to it
+    std::unordered_map<std::string, std::vector<std::uint32_t>> creators;
+    if (mode == MatchMode::CREATOR)
+    {
+        for (std::uint32_t i = 0; i < names.size(); ++i)
+        {
+            creators[normalizeCreator(names[i])].push_back(i);
+        }
+    }
+    // Replace found with the names the credits match; scratch is reused between calls.
+    const auto findNames = [&](std::string_view credits, std::vector<std::uint32_t> &found,
+                               std::vector<std::string> &scratch)
+    {
+        if (mode != MatchMode::CREATOR)
+        {
+            matcher.find(mode == MatchMode::FOLDED ? foldCredits(credits) : credits, found);
+            return;
+        }
+        found.clear();
+        creatorNames(scratch, credits);
+        for (const std::string &creator : scratch)
+        {
+            if (const auto it = creators.find(creator); it != creators.end())
+            {
+                found.insert(found.end(), it->second.begin(), it->second.end());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+    };
+    struct RowNames
+    {
+        std::size_t row;
+        std::vector<std::uint32_t> names;
+    };
+    std::vector<std::uint32_t> found;
+    std::vector<std::string> scratch;
+    // Matches are yielded from named variables, as GCC 12 destroys a braced temporary holding
+    // a non-empty vector twice when it is the operand of co_yield.
+
+    if (const Table *table = database->getSequenceTable())
+    {
+        const SequenceColumns sequences{*table};
+        const StringColumn *column =
+            mode == MatchMode::FOLDED ? database->getFoldedCredits(creditField) : sequences.credit(fieldName);
+        if (column == nullptr)
+        {
+            co_return;
+        }
+        addCount(stats, &QueryStats::recordsScanned, column->size());
+        const auto scan = [&](std::size_t begin, std::size_t end, std::vector<RowNames> &rows)
+        {
+            std::vector<std::uint32_t> partFound;
+            std::vector<std::string> partScratch;
+            for (std::size_t row = begin; row < end; ++row)
+            {
+                if (!column->present(row))
+                {
+                    continue;
+                }
+                if (mode == MatchMode::FOLDED)
+                {
+                    // the column is folded already
+                    matcher.find((*column)[row], partFound);
+                }
+                else
+                {
+                    findNames((*column)[row], partFound, partScratch);
+                }
+                if (!partFound.empty())
+                {
+                    rows.push_back(RowNames{row, partFound});
+                }
+            }
+        };
+        std::vector<RowNames> rows;
+        if (ThreadPool *pool = database->getThreadPool())
+        {
+            rows = parallelCollect<RowNames>(*pool, column->size(), scan);
+        }
+        else
+        {
+            scan(0, column->size(), rows);
+        }
+        std::size_t lastIssueRow{NO_ROW};
+        for (RowNames &row : rows)
+        {
+            const int issue = sequences.issue[row.row];
+            if (issue != lastIssueId)
+            {
+                lastIssueRow = joinIssueRow(*database, issue);
+                lastIssueId = issue;
+            }
+            SequenceMatch match{{}, {}, lastIssueRow, row.row, std::move(row.names)};
+            co_yield std::move(match);
+        }
+        co_return;
+    }
+
+    if (const std::unique_ptr<RecordReader> stream = database->streamSequences())
+    {
+        std::size_t lastIssueRow{NO_ROW};
+        simdjson::dom::element record;
+        while (stream->next(record))
+        {
+            addCount(stats, &QueryStats::recordsScanned, 1);
+            if (!record.is_object())
+            {
+                throw std::runtime_error("Sequence record should be an object");
+            }
+            const simdjson::dom::object sequence{record.get_object()};
+            const simdjson::simdjson_result<simdjson::dom::element> value = sequence.at_key(fieldName);
+            if (value.error() == simdjson::NO_SUCH_FIELD)
+            {
+                continue;
+            }
+            if (!value.is_string())
+            {
+                throw std::runtime_error("Value of script field should be a string");
+            }
+            findNames(value.get_string().value(), found, scratch);
+            if (!found.empty())
+            {
+                const int issue = parseId(sequence.at_key("issue").get_string().value());
+                if (issue != lastIssueId)
+                {
+                    lastIssueRow = joinIssueRow(*database, issue);
+                    lastIssueId = issue;
+                }
+                const TransientMatch match{{{}, sequence, lastIssueRow, NO_ROW, found}};
+                co_yield match;
+            }
+        }
+        co_return;
+    }
+
+    simdjson::dom::object lastIssue;
+    if (stats != nullptr)
+    {
+        addCount(stats, &QueryStats::recordsScanned, database->getSequences().get_array().size());
+    }
+
+    for (const simdjson::dom::element record : database->getSequences().get_array())
+    {
+        if (!record.is_object())
+        {
+            throw std::runtime_error("Sequence array element should be an object");
+        }
+        const simdjson::dom::object sequence{record.get_object()};
+        const simdjson::simdjson_result<simdjson::dom::element> value = sequence.at_key(fieldName);
+        if (value.error() == simdjson::NO_SUCH_FIELD)
+        {
+            continue;
+        }
+        if (!value.is_string())
+        {
+            throw std::runtime_error("Value of script field should be a string");
+        }
+        findNames(value.get_string().value(), found, scratch);
+        if (!found.empty())
+        {
+            const int issue = parseId(sequence.at_key("issue").get_string().value());
+            if (issue != lastIssueId)
+            {
+                lastIssue = joinIssue(*database, issue);
+                lastIssueId = issue;
+            }
+            SequenceMatch match{lastIssue, sequence, NO_ROW, NO_ROW, found};
+            co_yield std::move(match);
+        }
+    }
+}
+
+MatchGenerator matches(DatabasePtr database, std::span<const CreditPredicate> predicates, Combine combine,
+    MatchMode mode, MatchOrder order)
+{
+    if (!database || predicates.empty())
+    {
+        co_return;
+    }
+    if (order == MatchOrder::SEQUENCE)
+    {
+        MatchGenerator scan{matches(database, predicates, combine, mode)};
+        std::vector<SequenceMatch> sorted{sortMatches(*database, scan)};
+        for (SequenceMatch &match : sorted)
+        {
+            co_yield std::move(match);
+        }
+        co_return;
+    }
+
+    int lastIssueId{-1};
+    QueryStats *stats{database->getStats()};
+    std::vector<Condition> conditions;
+    conditions.reserve(predicates.size());
+    for (const CreditPredicate &predicate : predicates)
+    {
+        conditions.emplace_back(predicate, mode);
+    }
+    struct RowNames
+    {
+        std::size_t row;
+        std::vector<std::uint32_t> names;
+    };
+    // Matches are yielded from named variables, as GCC 12 destroys a braced temporary holding
+    // a non-empty vector twice when it is the operand of co_yield.
+
+    if (const Table *table = database->getSequenceTable())
+    {
+        const SequenceColumns sequences{*table};
+        // nullptr for a field without credits, which never matches
+        std::vector<const StringColumn *> columns;
+        for (const Condition &condition : conditions)
+        {
+            columns.push_back(mode == MatchMode::FOLDED ? database->getFoldedCredits(condition.field)
+                                                        : sequences.credit(condition.fieldName));
+        }
+
+        if (combine == Combine::ALL && std::find(columns.begin(), columns.end(), nullptr) != columns.end())
+        {
+            co_return;
+        }
+
+        // Plan the query: with an index for the predicates, only the rows their posting lists
+        // combine to are checked.  A conjunction needs only one indexed predicate, as the others
+        // are checked on its rows; a disjunction needs them all.
+        std::optional<std::vector<std::uint32_t>> candidates;
+        bool allIndexed{true};
+        if (mode == MatchMode::CREATOR)
+        {
+            std::vector<const PostingList *> lists;
+            for (std::size_t i = 0; i < conditions.size(); ++i)
+            {
+                const CreditIndex *index = columns[i] != nullptr ? database->getCreditIndex(conditions[i].field) : nullptr;
+                if (index == nullptr)
+                {
+                    allIndexed = allIndexed && columns[i] == nullptr;
+                    continue;
+                }
+                if (const PostingList *rows = index->find(conditions[i].creator))
+                {
+                    lists.push_back(rows);
+                }
+                else if (combine == Combine::ALL)
+                {
+                    // no sequence credits the creator
+                    co_return;
+                }
+            }
+            if (combine == Combine::ALL && !lists.empty())
+            {
+                candidates = intersectPostings(lists);
+            }
+            else if (combine == Combine::ANY && allIndexed)
+            {
+                std::vector<std::vector<std::uint32_t>> rows;
+                for (const PostingList *list : lists)
+                {
+                    rows.emplace_back(list->begin(), list->end());
+                }
+                candidates = rows.empty() ? std::vector<std::uint32_t>{} : combineRows(std::move(rows), combine);
+            }
+        }
+        else if (mode == MatchMode::SUBSTRING)
+        {
+            std::vector<std::vector<std::uint32_t>> lists;
+            for (std::size_t i = 0; i < conditions.size(); ++i)
+            {
+                const TrigramIndex *trigrams = columns[i] != nullptr && conditions[i].name.length() >= TrigramIndex::MIN_NEEDLE
+                    ? database->getTrigramIndex(conditions[i].field)
+                    : nullptr;
+                if (trigrams == nullptr)
+                {
+                    allIndexed = allIndexed && columns[i] == nullptr;
+                    continue;
+                }
+                lists.push_back(trigrams->candidates(conditions[i].name));
+            }
+            if (!lists.empty() && (combine == Combine::ALL || allIndexed))
+            {
+                candidates = combineRows(std::move(lists), combine);
+            }
+        }
+
+        // Check the predicates of a row, recording those it matched for a disjunction.
+        const auto matchesRow = [&](std::size_t row, std::vector<std::uint32_t> &matched)
+        {
+            matched.clear();
+            for (std::uint32_t i = 0; i < conditions.size(); ++i)
+            {
+                const StringColumn *column{columns[i]};
+                const bool hit{column != nullptr && column->present(row)
+                    && conditions[i].matches((*column)[row], mode == MatchMode::FOLDED)};
+                if (hit)
+                {
+                    matched.push_back(i);
+                }
+                else if (combine == Combine::ALL)
+                {
+                    return false;
+                }
+            }
+            return !matched.empty();
+        };
+        // For a full scan of a conjunction, the predicate with the longest name is searched for
+        // through its column's blob and the others are checked on the rows it finds.
+        std::size_t driver{};
+        for (std::size_t i = 1; i < conditions.size(); ++i)
+        {
+            if (conditions[i].name.size() > conditions[driver].name.size())
+            {
+                driver = i;
+            }
+        }
+        const std::size_t count{candidates ? candidates->size() : table->rows()};
+        addCount(stats, &QueryStats::recordsScanned, count);
+        const auto scan = [&](std::size_t begin, std::size_t end, std::vector<RowNames> &rows)
+        {
+            std::vector<std::uint32_t> matched;
+            const auto add = [&](std::size_t row)
+            {
+                rows.push_back(RowNames{row, combine == Combine::ANY ? matched : std::vector<std::uint32_t>{}});
+            };
+            if (candidates)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    if (matchesRow((*candidates)[i], matched))
+                    {
+                        add((*candidates)[i]);
+                    }
+                }
+            }
+            else if (combine == Combine::ALL)
+            {
+                const Condition &condition{conditions[driver]};
+                const StringColumn &column{*columns[driver]};
+                for (std::size_t row = condition.find(column, begin, end); row < end;
+                     row = condition.find(column, row + 1, end))
+                {
+                    if (matchesRow(row, matched))
+                    {
+                        add(row);
+                    }
+                }
+            }
+            else
+            {
+                // the next match of each predicate, so each column is searched once
+                std::vector<std::size_t> next;
+                for (std::size_t i = 0; i < conditions.size(); ++i)
+                {
+                    next.push_back(columns[i] != nullptr ? conditions[i].find(*columns[i], begin, end) : end);
+                }
+                for (std::size_t row = *std::min_element(next.begin(), next.end()); row < end;
+                     row = *std::min_element(next.begin(), next.end()))
+                {
+                    matched.clear();
+                    for (std::uint32_t i = 0; i < conditions.size(); ++i)
+                    {
+                        if (next[i] == row)
+                        {
+                            matched.push_back(i);
+                            next[i] = conditions[i].find(*columns[i], row + 1, end);
+                        }
+                    }
+                    add(row);
+                }
+            }
+        };
+        std::vector<RowNames> rows;
+        if (ThreadPool *pool = database->getThreadPool())
+        {
+            rows = parallelCollect<RowNames>(*pool, count, scan);
+        }
+        else
+        {
+            scan(0, count, rows);
+        }
+        std::size_t lastIssueRow{NO_ROW};
+        for (RowNames &row : rows)
+        {
+            const int issue = sequences.issue[row.row];
+            if (issue != lastIssueId)
+            {
+                lastIssueRow = joinIssueRow(*database, issue);
+                lastIssueId = issue;
+            }
+            SequenceMatch match{{}, {}, lastIssueRow, row.row, std::move(row.names)};
+            co_yield std::move(match);
+        }
+        co_return;
+    }
+
+    // Check the predicates of a record, recording those it matched for a disjunction.
+    std::vector<std::uint32_t> matched;
+    const auto matchesRecord = [&](const simdjson::dom::object &sequence)
+    {
+        matched.clear();
+        for (std::uint32_t i = 0; i < conditions.size(); ++i)
+        {
+            const simdjson::simdjson_result<simdjson::dom::element> value = sequence.at_key(conditions[i].fieldName);
+            if (value.error() != simdjson::NO_SUCH_FIELD && !value.is_string())
+            {
+                throw std::runtime_error("Value of credit field should be a string");
+            }
+            if (value.error() != simdjson::NO_SUCH_FIELD && conditions[i].matches(value.get_string().value(), false))
+            {
+                matched.push_back(i);
+            }
+            else if (combine == Combine::ALL)
+            {
+                return false;
+            }
+        }
+        if (combine == Combine::ALL)
+        {
+            matched.clear();
+            return true;
+        }
+        return !matched.empty();
+    };
+
+    if (const std::unique_ptr<RecordReader> stream = database->streamSequences())
+    {
+        std::size_t lastIssueRow{NO_ROW};
+        simdjson::dom::element record;
+        while (stream->next(record))
+        {
+            addCount(stats, &QueryStats::recordsScanned, 1);
+            if (!record.is_object())
+            {
+                throw std::runtime_error("Sequence record should be an object");
+            }
+            const simdjson::dom::object sequence{record.get_object()};
+            if (matchesRecord(sequence))
+            {
+                const int issue = parseId(sequence.at_key("issue").get_string().value());
+                if (issue != lastIssueId)
+                {
+                    lastIssueRow = joinIssueRow(*database, issue);
+                    lastIssueId = issue;
+                }
+                TransientMatch match{{{}, sequence, lastIssueRow, NO_ROW, matched}};
+                co_yield match;
+            }
+        }
+        co_return;
+    }
+
+    simdjson::dom::object lastIssue;
+    for (const simdjson::dom::element record : database->getSequences().get_array())
+    {
+        addCount(stats, &QueryStats::recordsScanned, 1);
+        if (!record.is_object())
+        {
+            throw std::runtime_error("Sequence array element should be an object");
+        }
+        const simdjson::dom::object sequence{record.get_object()};
+        if (matchesRecord(sequence))
+        {
+            const int issue = parseId(sequence.at_key("issue").get_string().value());
+            if (issue != lastIssueId)
+            {
+                lastIssue = joinIssue(*database, issue);
+                lastIssueId = issue;
+            }
+            SequenceMatch match{lastIssue, sequence, NO_ROW, NO_ROW, matched};
+            co_yield std::move(match);
+        }
+    }
+}
+
+DatabasePtr createDatabase(const std::filesystem::path &jsonDir, const DatabaseOptions &options)
+{
+    const TraceSpan span{"load database"};
+    if (const std::optional<SnapshotPaths> snapshots = findSnapshots(jsonDir))
+    {
+        return std::make_shared<SnapshotDatabase>(*snapshots, options);
+    }
+    if (const std::optional<NDJSONPaths> ndjson = findNDJSONFiles(jsonDir))
+    {
+        return std::make_shared<StreamingDatabase>(
+            ndjson->issues, ndjson->sequences, openRecords<NDJSONReader>, NDJSONReader::DEFAULT_WINDOW, options);
+    }
+    const JSONPaths json{findJSONFiles(jsonDir)};
+    if (options.memoryBudget != 0)
+    {
+        return std::make_shared<StreamingDatabase>(json.issues, json.sequences, openRecords<JSONArrayReader>,
+            chunkWindow(options.memoryBudget), options);
+    }
+    return std::make_shared<JSONDatabase>(json, options);
 }
 
 } // namespace coroutine
@@ -0,0 +1,166 @@
+#include "comics/credit-index.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace comics
+{
+
+namespace
+{
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+} // namespace
+
+std::string normalizeCreator(std::string_view name)
+{
+    std::string result;
+    result.reserve(name.size());
+    bool space{false};
+    for (const char c : name)
+    {
+        if (isSpace(c))
+        {
+            space = !result.empty();
+            continue;
+        }
+        if (space)
+        {
+            result += ' ';
+            space = false;
+        }
+        result += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+    while (!result.empty() && (result.back() == '?' || result.back() == ' '))
+    {
+        result.pop_back();
+    }
+    return result;
+}
+
+void creatorNames(std::vector<std::string> &names, std::string_view credits)
+{
+    names.clear();
+    std::string name;
+    int depth{};
+    const auto endName = [&]
+    {
+        std::string normalized{normalizeCreator(name)};
+        if (!normalized.empty())
+        {
+            names.push_back(std::move(normalized));
+        }
+        name.clear();
+    };
+    for (const char c : credits)
+    {
+        if (c == '(' || c == '[')
+        {
+            ++depth;
+        }
+        else if (c == ')' || c == ']')
+        {
+            if (depth > 0)
+            {
+                --depth;
+            }
+        }
+        else if (depth == 0)
+        {
+            if (c == ';')
+            {
+                endName();
+            }
+            else
+            {
+                name += c;
+            }
+        }
+    }
+    endName();
+}
+
+bool creditsName(std::string_view credits, std::string_view creator)
+{
+    std::vector<std::string> names;
+    creatorNames(names, credits);
+    return std::find(names.begin(), names.end(), creator) != names.end();
+}
+
+void PostingList::Iterator::decode()
+{
+    if (m_pos == m_end)
+    {
+        m_done = true;
+        return;
+    }
+    std::uint32_t delta{};
+    int shift{};
+    while (true)
+    {
+        const std::uint8_t byte = *m_pos++;
+        delta |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            break;
+        }
+        shift += 7;
+    }
+    m_row += delta;
+    m_done = false;
+}
+
+void PostingList::append(std::uint32_t row)
+{
+    if (m_count != 0 && row <= m_last)
+    {
+        if (row == m_last)
+        {
+            return;
+        }
+        throw std::runtime_error("Posting list rows must be appended in ascending order");
+    }
+    std::uint32_t delta{row - m_last};
+    while (delta >= 0x80)
+    {
+        m_bytes.push_back(static_cast<std::uint8_t>(delta | 0x80));
+        delta >>= 7;
+    }
+    m_bytes.push_back(static_cast<std::uint8_t>(delta));
+    m_last = row;
+    ++m_count;
+}
+
+void CreditIndex::add(std::uint32_t row, std::string_view credits)
+{
+    creatorNames(m_names, credits);
+    for (const std::string &name : m_names)
+    {
+        m_postings[name].append(row);
+    }
+}
+
+const PostingList *CreditIndex::find(std::string_view creator) const
+{
+    const auto it = m_postings.find(normalizeCreator(creator));
+    return it == m_postings.end() ? nullptr : &it->second;
+}
+
+CreditIndex buildCreditIndex(const StringColumn &column)
+{
+    CreditIndex index;
+    for (std::size_t row = 0; row < column.size(); ++row)
+    {
+        if (column.present(row))
+        {
+            index.add(static_cast<std::uint32_t>(row), column[row]);
+        }
+    }
+    return index;
+}
+
+} // namespace comics
@@ -0,0 +1,141 @@
+#include "comics/dump-delta.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+namespace comics
+{
+
+std::uint64_t hashRecord(std::string_view lines)
+{
+    // a word at a time multiply and xor-shift; collisions only matter between versions of one record
+    constexpr std::uint64_t PRIME{0x9E3779B97F4A7C15ULL};
+    std::uint64_t hash{lines.size() * PRIME};
+    std::size_t pos{};
+    for (; pos + 8 <= lines.size(); pos += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, lines.data() + pos, sizeof(word));
+        hash = ((hash ^ word) * PRIME);
+        hash ^= hash >> 29;
+    }
+    std::uint64_t tail{};
+    std::memcpy(&tail, lines.data() + pos, lines.size() - pos);
+    hash = (hash ^ tail) * PRIME;
+    return hash ^ (hash >> 32);
+}
+
+void writeRecordList(const std::filesystem::path &path, std::uint32_t flags, const std::filesystem::path &json,
+    std::span<const RecordEntry> records)
+{
+    RecordListHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, RECORDS_MAGIC, sizeof(RECORDS_MAGIC));
+    header.version = RECORDS_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.recordCount = records.size();
+    header.flags = flags;
+    header.json = stampFile(json);
+
+    std::ofstream str(path, std::ios::binary | std::ios::trunc);
+    if (!str)
+    {
+        throw std::runtime_error("Couldn't create " + path.string());
+    }
+    str.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    str.write(reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>(records.size_bytes()));
+    if (!str)
+    {
+        throw std::runtime_error("Couldn't write " + path.string());
+    }
+}
+
+PreviousConversion::PreviousConversion(const std::filesystem::path &records, const std::filesystem::path &json,
+    const std::filesystem::path &snapshot, std::uint32_t flags, const std::vector<ColumnSpec> &columns) :
+    m_file(records),
+    m_json(json)
+{
+    const std::string name{records.string()};
+    RecordListHeader header;
+    if (m_file.size() < sizeof(header))
+    {
+        throw std::runtime_error("Record list " + name + " is truncated");
+    }
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.magic, RECORDS_MAGIC, sizeof(RECORDS_MAGIC)) != 0)
+    {
+        throw std::runtime_error(name + " is not a record list");
+    }
+    if (header.byteOrder != SNAPSHOT_BYTE_ORDER || header.version != RECORDS_VERSION)
+    {
+        throw std::runtime_error("Record list " + name + " was written by another version");
+    }
+    if (header.flags != flags)
+    {
+        throw std::runtime_error("Record list " + name + " was written with other options");
+    }
+    // offsets into a JSON file converted again since may still fall within it
+    if (header.json != stampFile(json))
+    {
+        throw std::runtime_error("Record list " + name + " is older than " + json.string());
+    }
+    if (header.recordCount > (m_file.size() - sizeof(header)) / sizeof(RecordEntry))
+    {
+        throw std::runtime_error("Record list " + name + " is truncated");
+    }
+    // the header is a multiple of 8 bytes, so the mapping keeps the entries aligned
+    m_records = {reinterpret_cast<const RecordEntry *>(m_file.data() + sizeof(header)),
+        static_cast<std::size_t>(header.recordCount)};
+
+    if (flags & RECORDS_SNAPSHOT)
+    {
+        m_snapshot.emplace(snapshot);
+        const std::vector<Table::Column> &tableColumns{m_snapshot->table().columns()};
+        if (tableColumns.size() != columns.size() || m_snapshot->table().rows() != m_records.size())
+        {
+            throw std::runtime_error("Snapshot " + snapshot.string() + " doesn't match record list " + name);
+        }
+        for (std::size_t i = 0; i < columns.size(); ++i)
+        {
+            if (tableColumns[i].name != columns[i].name || tableColumns[i].type != columns[i].type)
+            {
+                throw std::runtime_error("Snapshot " + snapshot.string() + " has other columns");
+            }
+        }
+    }
+
+    m_index.reserve(m_records.size());
+    for (std::uint32_t i = 0; i < m_records.size(); ++i)
+    {
+        const RecordEntry &record{m_records[i]};
+        if (record.offset > m_json.size() || record.length > m_json.size() - record.offset)
+        {
+            throw std::runtime_error("Record list " + name + " doesn't match " + json.string());
+        }
+        m_index.emplace(record.key, i);
+    }
+}
+
+const RecordEntry *PreviousConversion::find(std::uint64_t key) const
+{
+    const auto it = m_index.find(key);
+    return it == m_index.end() ? nullptr : &m_records[it->second];
+}
+
+std::size_t PreviousConversion::removed(std::span<const RecordEntry> records) const
+{
+    std::unordered_set<std::uint64_t> keys;
+    keys.reserve(records.size());
+    for (const RecordEntry &record : records)
+    {
+        keys.insert(record.key);
+    }
+    return static_cast<std::size_t>(std::count_if(m_records.begin(), m_records.end(),
+        [&](const RecordEntry &record) { return !keys.contains(record.key); }));
+}
+
+} // namespace comics
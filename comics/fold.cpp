@@ -0,0 +1,259 @@
+#include "comics/fold.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+namespace comics
+{
+
+namespace
+{
+
+// Latin letters with diacritics and ligatures, spelled in lower case ASCII.
+struct LatinFold
+{
+    char32_t first;
+    char32_t last;
+    const char *ascii;
+};
+
+constexpr std::array LATIN_FOLDS{
+    // Latin-1 Supplement
+    LatinFold{0xC0, 0xC5, "a"},
+    LatinFold{0xC6, 0xC6, "ae"},
+    LatinFold{0xC7, 0xC7, "c"},
+    LatinFold{0xC8, 0xCB, "e"},
+    LatinFold{0xCC, 0xCF, "i"},
+    LatinFold{0xD0, 0xD0, "d"},
+    LatinFold{0xD1, 0xD1, "n"},
+    LatinFold{0xD2, 0xD6, "o"},
+    LatinFold{0xD8, 0xD8, "o"},
+    LatinFold{0xD9, 0xDC, "u"},
+    LatinFold{0xDD, 0xDD, "y"},
+    LatinFold{0xDE, 0xDE, "th"},
+    LatinFold{0xDF, 0xDF, "ss"},
+    LatinFold{0xE0, 0xE5, "a"},
+    LatinFold{0xE6, 0xE6, "ae"},
+    LatinFold{0xE7, 0xE7, "c"},
+    LatinFold{0xE8, 0xEB, "e"},
+    LatinFold{0xEC, 0xEF, "i"},
+    LatinFold{0xF0, 0xF0, "d"},
+    LatinFold{0xF1, 0xF1, "n"},
+    LatinFold{0xF2, 0xF6, "o"},
+    LatinFold{0xF8, 0xF8, "o"},
+    LatinFold{0xF9, 0xFC, "u"},
+    LatinFold{0xFD, 0xFD, "y"},
+    LatinFold{0xFE, 0xFE, "th"},
+    LatinFold{0xFF, 0xFF, "y"},
+    // Latin Extended-A
+    LatinFold{0x100, 0x105, "a"},
+    LatinFold{0x106, 0x10D, "c"},
+    LatinFold{0x10E, 0x111, "d"},
+    LatinFold{0x112, 0x11B, "e"},
+    LatinFold{0x11C, 0x123, "g"},
+    LatinFold{0x124, 0x127, "h"},
+    LatinFold{0x128, 0x131, "i"},
+    LatinFold{0x132, 0x133, "ij"},
+    LatinFold{0x134, 0x135, "j"},
+    LatinFold{0x136, 0x138, "k"},
+    LatinFold{0x139, 0x142, "l"},
+    LatinFold{0x143, 0x14B, "n"},
+    LatinFold{0x14C, 0x151, "o"},
+    LatinFold{0x152, 0x153, "oe"},
+    LatinFold{0x154, 0x159, "r"},
+    LatinFold{0x15A, 0x161, "s"},
+    LatinFold{0x162, 0x167, "t"},
+    LatinFold{0x168, 0x173, "u"},
+    LatinFold{0x174, 0x175, "w"},
+    LatinFold{0x176, 0x178, "y"},
+    LatinFold{0x179, 0x17E, "z"},
+    LatinFold{0x17F, 0x17F, "s"},
+    // the Latin Extended-B letters of Romanian
+    LatinFold{0x218, 0x219, "s"},
+    LatinFold{0x21A, 0x21B, "t"},
+};
+
+bool isCombiningMark(char32_t c)
+{
+    return (c >= 0x300 && c <= 0x36F) || (c >= 0x1AB0 && c <= 0x1AFF) || (c >= 0x1DC0 && c <= 0x1DFF)
+        || (c >= 0x20D0 && c <= 0x20FF) || (c >= 0xFE20 && c <= 0xFE2F);
+}
+
+// Greek and Cyrillic letters folded to lower case, with the Greek tonos and dialytika removed.
+char32_t foldGreekCyrillic(char32_t c)
+{
+    switch (c)
+    {
+    case 0x386:
+    case 0x3AC:
+        return 0x3B1; // alpha
+    case 0x388:
+    case 0x3AD:
+        return 0x3B5; // epsilon
+    case 0x389:
+    case 0x3AE:
+        return 0x3B7; // eta
+    case 0x38A:
+    case 0x390:
+    case 0x3AA:
+    case 0x3AF:
+    case 0x3CA:
+        return 0x3B9; // iota
+    case 0x38C:
+    case 0x3CC:
+        return 0x3BF; // omicron
+    case 0x38E:
+    case 0x3AB:
+    case 0x3B0:
+    case 0x3CB:
+    case 0x3CD:
+        return 0x3C5; // upsilon
+    case 0x38F:
+    case 0x3CE:
+        return 0x3C9; // omega
+    case 0x3C2:
+        return 0x3C3; // final sigma
+    default:
+        break;
+    }
+    if (c >= 0x391 && c <= 0x3A9)
+    {
+        return c + 0x20;
+    }
+    if (c >= 0x410 && c <= 0x42F)
+    {
+        return c + 0x20;
+    }
+    if (c >= 0x400 && c <= 0x40F)
+    {
+        return c + 0x50;
+    }
+    return c;
+}
+
+void appendUtf8(std::string &result, char32_t c)
+{
+    if (c < 0x800)
+    {
+        result += static_cast<char>(0xC0 | (c >> 6));
+        result += static_cast<char>(0x80 | (c & 0x3F));
+        return;
+    }
+    // only letters of the Basic Multilingual Plane are folded
+    result += static_cast<char>(0xE0 | (c >> 12));
+    result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    result += static_cast<char>(0x80 | (c & 0x3F));
+}
+
+// Decode the character at the start of text, returning its length, or 0 if it isn't valid UTF-8.
+std::size_t decodeUtf8(std::string_view text, char32_t &c)
+{
+    const auto byte = [&](std::size_t i) { return static_cast<unsigned char>(text[i]); };
+    const unsigned char lead{byte(0)};
+    std::size_t length;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+        c = lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        c = lead & 0x0F;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        c = lead & 0x07;
+    }
+    else
+    {
+        return 0;
+    }
+    if (text.size() < length)
+    {
+        return 0;
+    }
+    for (std::size_t i = 1; i < length; ++i)
+    {
+        if ((byte(i) & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        c = (c << 6) | (byte(i) & 0x3F);
+    }
+    return length;
+}
+
+} // namespace
+
+void appendFolded(std::string &result, std::string_view text)
+{
+    std::size_t pos{};
+    while (pos < text.size())
+    {
+        const char byte{text[pos]};
+        if ((byte & 0x80) == 0)
+        {
+            result += (byte >= 'A' && byte <= 'Z') ? static_cast<char>(byte - 'A' + 'a') : byte;
+            ++pos;
+            continue;
+        }
+        char32_t c{};
+        const std::size_t length{decodeUtf8(text.substr(pos), c)};
+        if (length == 0)
+        {
+            result += byte;
+            ++pos;
+            continue;
+        }
+        const std::string_view original{text.substr(pos, length)};
+        pos += length;
+        if (isCombiningMark(c))
+        {
+            continue;
+        }
+        const auto latin = std::upper_bound(LATIN_FOLDS.begin(), LATIN_FOLDS.end(), c,
+            [](char32_t value, const LatinFold &fold) { return value < fold.first; });
+        if (latin != LATIN_FOLDS.begin() && c <= std::prev(latin)->last)
+        {
+            result += std::prev(latin)->ascii;
+            continue;
+        }
+        const char32_t folded{foldGreekCyrillic(c)};
+        if (folded != c)
+        {
+            appendUtf8(result, folded);
+            continue;
+        }
+        result += original;
+    }
+}
+
+std::string foldText(std::string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    appendFolded(result, text);
+    return result;
+}
+
+FoldedColumn::FoldedColumn(const StringColumn &column)
+{
+    m_offsets.reserve(column.size() + 1);
+    m_blob.reserve(column.blobSize());
+    m_offsets.push_back(0);
+    for (std::size_t row = 0; row < column.size(); ++row)
+    {
+        if (!column.present(row))
+        {
+            m_offsets.push_back(m_blob.size() | StringColumn::ABSENT);
+            continue;
+        }
+        appendFolded(m_blob, column[row]);
+        m_offsets.push_back(m_blob.size());
+    }
+}
+
+} // namespace comics
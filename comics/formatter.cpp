@@ -0,0 +1,136 @@
+#include "comics/formatter.h"
+
+#include "comics/trace.h"
+
+#include <array>
+#include <charconv>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace comics
+{
+
+namespace
+{
+
+// Labels of the printed fields, right aligned in 18 columns, in the order they are printed.
+constexpr std::array<std::string_view, 6> FIELD_KEYS{"title", "feature", "script", "pencils", "inks", "colors"};
+constexpr std::array<std::string_view, 6> FIELD_LABELS{
+    "             title: ",
+    "           feature: ",
+    "            script: ",
+    "           pencils: ",
+    "              inks: ",
+    "            colors: ",
+};
+
+} // namespace
+
+OutputBuffer::OutputBuffer(std::ostream &str, std::size_t capacity) :
+    m_str(str),
+    m_buffer(capacity == 0 ? 1 : capacity)
+{
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    flush();
+}
+
+OutputBuffer &OutputBuffer::operator<<(std::int64_t value)
+{
+    char digits[24];
+    const auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), value);
+    return *this << std::string_view{digits, static_cast<std::size_t>(end - digits)};
+}
+
+void OutputBuffer::flush()
+{
+    if (m_size != 0)
+    {
+        TraceSpan span{"flush"};
+        span.setValue(static_cast<std::int64_t>(m_size));
+        m_str.write(m_buffer.data(), static_cast<std::streamsize>(m_size));
+        m_flushed += m_size;
+        m_size = 0;
+    }
+}
+
+void OutputBuffer::appendSlow(std::string_view text)
+{
+    flush();
+    if (text.size() >= m_buffer.size())
+    {
+        // no point copying text that fills the buffer on its own
+        m_str.write(text.data(), static_cast<std::streamsize>(text.size()));
+        m_flushed += text.size();
+        return;
+    }
+    text.copy(m_buffer.data(), text.size());
+    m_size = text.size();
+}
+
+void formatSequence(OutputBuffer &out, const SequenceColumns &sequences, std::size_t row)
+{
+    const std::array<const StringColumn *, 6> columns{
+        &sequences.title, &sequences.feature, &sequences.script, &sequences.pencils, &sequences.inks, &sequences.colors};
+    for (std::size_t field = 0; field < columns.size(); ++field)
+    {
+        // field might not be present
+        if (columns[field]->present(row))
+        {
+            out << FIELD_LABELS[field] << (*columns[field])[row] << '\n';
+        }
+    }
+}
+
+void formatSequence(OutputBuffer &out, simdjson::dom::object sequence)
+{
+    // one pass over the record finds every printed field; the first of repeated keys wins
+    std::array<simdjson::dom::element, 6> values;
+    std::array<bool, 6> present{};
+    for (const simdjson::dom::key_value_pair item : sequence)
+    {
+        for (std::size_t field = 0; field < FIELD_KEYS.size(); ++field)
+        {
+            if (!present[field] && item.key == FIELD_KEYS[field])
+            {
+                values[field] = item.value;
+                present[field] = true;
+                break;
+            }
+        }
+    }
+    for (std::size_t field = 0; field < FIELD_KEYS.size(); ++field)
+    {
+        if (!present[field])
+        {
+            // field might not be present
+            continue;
+        }
+        const simdjson::dom::element value{values[field]};
+        out << FIELD_LABELS[field];
+        if (value.is_string())
+        {
+            out << value.get_string().value() << '\n';
+        }
+        else if (value.is_bool())
+        {
+            out << (value.get_bool().value() ? std::string_view{"true\n"} : std::string_view{"false\n"});
+        }
+        else if (value.is_number())
+        {
+            out << value.get_int64().value() << '\n';
+        }
+        else
+        {
+            std::ostringstream fieldType;
+            fieldType << value.type();
+            throw std::runtime_error(
+                "Unknown type for field '" + std::string{FIELD_KEYS[field]} + "', got " + fieldType.str());
+        }
+    }
+}
+
+} // namespace comics
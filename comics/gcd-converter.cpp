@@ -0,0 +1,467 @@
+#include "comics/gcd-converter.h"
+
+#include "comics/snapshot.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+
+namespace comics
+{
+
+namespace
+{
+
+// Escape text the long way round, reporting and dropping control characters.
+std::string escaped(std::string text)
+{
+    // escape all backslashes
+    for (std::string::size_type pos = text.find('\\'); pos != std::string::npos; pos = text.find('\\', pos + 2))
+    {
+        text.insert(pos, 1, '\\');
+    }
+
+    // replace "" with \"
+    for (std::string::size_type pos = text.find(R"("")"); pos != std::string::npos; pos = text.find(R"("")", pos + 2))
+    {
+        text[pos] = '\\';
+    }
+
+    // escape all TABs
+    for (std::string::size_type pos = text.find('\t'); pos != std::string::npos; pos = text.find('\t', pos + 1))
+    {
+        text.erase(pos, 1);
+        text.insert(pos, "\\t");
+    }
+
+    // scan for control characters
+    std::string::size_type pos = 0;
+    while (pos < text.length())
+    {
+        const unsigned char c = static_cast<unsigned char>(text[pos]);
+        if (c < 32)
+        {
+            std::cerr << "\nControl character (^" << static_cast<char>(c + 64) << ") found in '" << text << "'; dropping\n"
+                << "                                 " << std::string(pos, ' ') << "^--\n";
+            text.erase(pos, 1);
+        }
+        else
+        {
+            ++pos;
+        }
+    }
+    return text;
+}
+
+// The record id a line starts with, or nullopt if it doesn't start with one.
+std::optional<int> lineRecordId(std::string_view line)
+{
+    int id{};
+    if (line.size() < 2 || line[0] != '"' ||
+        std::from_chars(line.data() + 1, line.data() + line.size(), id).ec != std::errc{})
+    {
+        return std::nullopt;
+    }
+    return id;
+}
+
+bool isBoolean(std::string_view value)
+{
+    return value == "True" || value == "False";
+}
+
+} // namespace
+
+int parseLeadingInt(std::string_view text)
+{
+    std::size_t pos{};
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+    {
+        ++pos;
+    }
+    if (pos < text.size() && text[pos] == '+')
+    {
+        ++pos;
+        if (pos == text.size() || text[pos] == '-')
+        {
+            throw std::invalid_argument("No integer in '" + std::string{text} + "'");
+        }
+    }
+    int value{};
+    const auto [end, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+    if (ec == std::errc::result_out_of_range)
+    {
+        throw std::out_of_range("Integer out of range in '" + std::string{text} + "'");
+    }
+    if (ec != std::errc{})
+    {
+        throw std::invalid_argument("No integer in '" + std::string{text} + "'");
+    }
+    return value;
+}
+
+DumpConverter::DumpConverter(
+    DumpKind kind, const ConvertOptions &options, OutputBuffer &json, TableWriter *table, DumpPart part) :
+    m_kind(kind),
+    m_options(options),
+    m_part(part),
+    m_json(json),
+    m_table(table),
+    m_columns(kind == DumpKind::ISSUES ? &ISSUE_COLUMNS : &SEQUENCE_COLUMNS),
+    m_firstRecord(part.first)
+{
+    if (m_part.first && !m_options.ndjson)
+    {
+        m_json << "[\n";
+    }
+}
+
+void DumpConverter::addLine(std::string_view line)
+{
+    // "field"<TAB>"field"...; an empty line has no opening quote to skip and throws std::out_of_range
+    m_fields.clear();
+    std::size_t start{1};
+    for (std::size_t split = line.find("\"\t\""); split != std::string_view::npos; split = line.find("\"\t\"", split + 1))
+    {
+        m_fields.push_back(line.substr(start, split - start));
+        start = split + 3;
+    }
+    m_fields.push_back(line.substr(start, line.length() - start - 1));
+
+    const std::size_t expected{m_kind == DumpKind::ISSUES ? 3U : 4U};
+    if (m_fields.size() != expected)
+    {
+        throw std::runtime_error(
+            "Expected " + std::to_string(expected) + " fields, got " + std::to_string(m_fields.size()));
+    }
+    const int recordId{parseLeadingInt(m_fields[0])};
+    const int sequenceId{m_kind == DumpKind::SEQUENCES ? parseLeadingInt(m_fields[1]) : m_lastSequenceId};
+    if (recordId != m_lastRecordId || sequenceId != m_lastSequenceId)
+    {
+        printRecord();
+        m_record.clear();
+        m_record.emplace_back(m_kind == DumpKind::ISSUES ? "id" : "issue", m_fields[0]);
+        m_lastRecordId = recordId;
+        m_lastSequenceId = sequenceId;
+        m_recordBegin = line.data();
+    }
+    m_recordEnd = line.data() + line.size();
+
+    // a repeated name replaces the earlier value
+    const std::string_view name{m_fields[expected - 2]};
+    const std::string_view value{m_fields[expected - 1]};
+    const auto it = std::lower_bound(m_record.begin(), m_record.end(), name,
+        [](const std::pair<std::string_view, std::string_view> &field, std::string_view key) { return field.first < key; });
+    if (it != m_record.end() && it->first == name)
+    {
+        it->second = value;
+    }
+    else
+    {
+        m_record.emplace(it, name, value);
+    }
+}
+
+void DumpConverter::finish()
+{
+    printRecord();
+    m_record.clear();
+    if (m_part.last && !m_options.ndjson)
+    {
+        m_json << "\n]\n";
+    }
+}
+
+void DumpConverter::printRecord()
+{
+    if (m_record.empty())
+    {
+        return;
+    }
+    RecordEntry entry{};
+    const RecordEntry *unchanged{};
+    if (m_tracking != nullptr)
+    {
+        entry.key = recordKey(m_lastRecordId, m_lastSequenceId);
+        entry.hash = hashRecord({m_recordBegin, static_cast<std::size_t>(m_recordEnd - m_recordBegin)});
+        const RecordEntry *previous{m_tracking->previous != nullptr ? m_tracking->previous->find(entry.key) : nullptr};
+        if (previous == nullptr)
+        {
+            ++m_tracking->counts.added;
+        }
+        else if (previous->hash != entry.hash)
+        {
+            ++m_tracking->counts.changed;
+        }
+        else
+        {
+            ++m_tracking->counts.unchanged;
+            unchanged = previous;
+        }
+    }
+    if (m_table != nullptr)
+    {
+        if (unchanged != nullptr && m_tracking->previous->table() != nullptr)
+        {
+            m_table->appendRow(*m_tracking->previous->table(), unchanged->row);
+        }
+        else
+        {
+            addRow();
+        }
+        entry.row = static_cast<std::uint32_t>(m_table->rows() - 1);
+    }
+    if (!m_firstRecord && !m_options.ndjson)
+    {
+        m_json << ",\n";
+    }
+    entry.offset = m_json.written();
+    if (unchanged != nullptr)
+    {
+        m_json << m_tracking->previous->json(*unchanged);
+    }
+    else
+    {
+        writeRecord();
+    }
+    if (m_tracking != nullptr)
+    {
+        entry.length = static_cast<std::uint32_t>(m_json.written() - entry.offset);
+        m_tracking->records.push_back(entry);
+    }
+    if (m_options.ndjson)
+    {
+        m_json << '\n';
+    }
+    m_firstRecord = false;
+}
+
+void DumpConverter::writeRecord()
+{
+    m_json << '{';
+    bool first{true};
+    for (const auto &[name, value] : m_record)
+    {
+        if (!first)
+        {
+            m_json << ',';
+        }
+        m_json << (m_options.singleLineRecords ? std::string_view{" \""} : std::string_view{"\n    \""});
+        writeEscaped(name);
+        m_json << std::string_view{"\": "};
+        if (isBoolean(value))
+        {
+            m_json << (value == "True" ? std::string_view{"true"} : std::string_view{"false"});
+        }
+        else
+        {
+            m_json << '"';
+            writeEscaped(value);
+            m_json << '"';
+        }
+        first = false;
+    }
+    m_json << (m_options.singleLineRecords ? std::string_view{"}"} : std::string_view{"\n}"});
+}
+
+// Append the record to the table, converting values to the strings a JSON reader sees.
+void DumpConverter::addRow()
+{
+    const std::vector<ColumnSpec> &columns{*m_columns};
+    for (std::size_t i = 0; i < columns.size(); ++i)
+    {
+        const auto it = std::lower_bound(m_record.begin(), m_record.end(), columns[i].name,
+            [](const std::pair<std::string_view, std::string_view> &field, std::string_view key)
+            { return field.first < key; });
+        if (it == m_record.end() || it->first != columns[i].name)
+        {
+            continue;
+        }
+        const std::string_view value{it->second};
+        if (columns[i].type == ColumnType::INT32)
+        {
+            m_table->set(i, parseLeadingInt(value));
+        }
+        else if (isBoolean(value))
+        {
+            m_table->set(i, value == "True" ? "true" : "false");
+        }
+        else
+        {
+            // "" reads as ", and control characters other than TAB are dropped
+            m_scratch.clear();
+            for (std::size_t pos = 0; pos < value.length(); ++pos)
+            {
+                const unsigned char c = static_cast<unsigned char>(value[pos]);
+                if (c == '"' && pos + 1 < value.length() && value[pos + 1] == '"')
+                {
+                    m_scratch += '"';
+                    ++pos;
+                }
+                else if (c >= 32 || c == '\t')
+                {
+                    m_scratch += value[pos];
+                }
+            }
+            m_table->set(i, m_scratch);
+        }
+    }
+    m_table->endRow();
+}
+
+void DumpConverter::writeEscaped(std::string_view text)
+{
+    const auto special = [](char c) { return c == '\\' || c == '"' || static_cast<unsigned char>(c) < 32; };
+    if (std::none_of(text.begin(), text.end(), special))
+    {
+        m_json << text;
+        return;
+    }
+
+    m_scratch.clear();
+    for (std::size_t pos = 0; pos < text.length(); ++pos)
+    {
+        const char c = text[pos];
+        if (c == '\\')
+        {
+            m_scratch += "\\\\";
+        }
+        else if (c == '"' && pos + 1 < text.length() && text[pos + 1] == '"')
+        {
+            m_scratch += "\\\"";
+            ++pos;
+        }
+        else if (c == '\t')
+        {
+            m_scratch += "\\t";
+        }
+        else if (static_cast<unsigned char>(c) < 32)
+        {
+            // rare enough to take the slow path, which reports what it drops
+            m_json << escaped(std::string{text});
+            return;
+        }
+        else
+        {
+            m_scratch += c;
+        }
+    }
+    m_json << m_scratch;
+}
+
+std::vector<std::string_view> splitDump(std::string_view text, std::size_t partSize)
+{
+    std::vector<std::string_view> parts;
+    while (!text.empty())
+    {
+        std::size_t end{text.size()};
+        if (partSize < text.size())
+        {
+            std::size_t lineEnd{text.find('\n', partSize)};
+            // extend the part while the next line continues the record of the last line; lines whose id
+            // can't be read quickly are never split from their neighbours
+            while (lineEnd != std::string_view::npos)
+            {
+                const std::size_t lastBegin{lineEnd == 0 ? std::string_view::npos : text.rfind('\n', lineEnd - 1)};
+                const std::optional<int> lastId{lineRecordId(
+                    text.substr(lastBegin == std::string_view::npos ? 0 : lastBegin + 1))};
+                const std::optional<int> nextId{lineRecordId(text.substr(lineEnd + 1))};
+                if (lastId && nextId && *lastId != *nextId)
+                {
+                    break;
+                }
+                lineEnd = text.find('\n', lineEnd + 1);
+            }
+            if (lineEnd != std::string_view::npos)
+            {
+                end = lineEnd + 1;
+            }
+        }
+        parts.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+    return parts;
+}
+
+std::size_t convertDumpParallel(std::string_view text, DumpKind kind, const ConvertOptions &options, std::ostream &json,
+    TableWriter *table, ThreadPool &pool, RecordTracking *tracking,
+    const std::function<void(std::size_t lines)> &progress, std::size_t partSize)
+{
+    const std::vector<std::string_view> parts{splitDump(text, partSize)};
+    if (parts.empty())
+    {
+        // no lines, but the JSON array still needs its brackets
+        OutputBuffer out{json};
+        DumpConverter converter{kind, options, out, table};
+        return convertDump(text, converter, [](std::size_t) {});
+    }
+
+    std::size_t lines{};
+    std::uint64_t jsonWritten{};
+    const std::size_t round{pool.threads()};
+    for (std::size_t begin = 0; begin < parts.size(); begin += round)
+    {
+        const std::size_t count{std::min(round, parts.size() - begin)};
+        std::vector<std::string> outputs(count);
+        std::vector<std::size_t> partLines(count);
+        std::vector<RecordTracking> trackings(tracking != nullptr ? count : 0);
+        std::vector<TableWriter> tables;
+        if (table != nullptr)
+        {
+            tables.assign(count, TableWriter{kind == DumpKind::ISSUES ? ISSUE_COLUMNS : SEQUENCE_COLUMNS});
+        }
+        pool.parallelFor(count,
+            [&](std::size_t, std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    const std::size_t index{begin + i};
+                    std::ostringstream str;
+                    {
+                        OutputBuffer out{str};
+                        DumpConverter converter{kind, options, out, table != nullptr ? &tables[i] : nullptr,
+                            DumpPart{index == 0, index + 1 == parts.size()}};
+                        if (tracking != nullptr)
+                        {
+                            trackings[i].previous = tracking->previous;
+                            converter.track(trackings[i]);
+                        }
+                        partLines[i] = convertDump(parts[index], converter, [](std::size_t) {});
+                    }
+                    outputs[i] = std::move(str).str();
+                }
+            });
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (tracking != nullptr)
+            {
+                // the part's offsets and rows are relative to its own output
+                const std::uint32_t rowBase{table != nullptr ? static_cast<std::uint32_t>(table->rows()) : 0U};
+                for (RecordEntry entry : trackings[i].records)
+                {
+                    entry.offset += jsonWritten;
+                    entry.row += rowBase;
+                    tracking->records.push_back(entry);
+                }
+                tracking->counts.unchanged += trackings[i].counts.unchanged;
+                tracking->counts.changed += trackings[i].counts.changed;
+                tracking->counts.added += trackings[i].counts.added;
+            }
+            json.write(outputs[i].data(), static_cast<std::streamsize>(outputs[i].size()));
+            jsonWritten += outputs[i].size();
+            if (table != nullptr)
+            {
+                table->append(tables[i]);
+            }
+            lines += partLines[i];
+        }
+        progress(lines);
+    }
+    return lines;
+}
+
+} // namespace comics
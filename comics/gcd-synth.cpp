@@ -0,0 +1,408 @@
+#include "comics/gcd-synth.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+namespace comics
+{
+
+namespace
+{
+
+constexpr std::array<std::string_view, 48> FIRST_NAMES{"Jack", "Stan", "Steve", "Joe", "John", "Gil", "Gene", "Carl",
+    "Don", "Dick", "Wally", "Bill", "Frank", "Marie", "Ramona", "Alex", "Neal", "Jim", "Roy", "Len", "Chris", "Mike",
+    "Walt", "Jenette", "Louise", "Ann", "Trina", "Sal", "Herb", "Vince", "George", "Syd", "Paul", "Tony", "Bob",
+    "Julie", "Alan", "Grant", "Peter", "Gail", "Kelly", "Fiona", "Jordie", "Dave", "Todd", "Klaus", "Moebius", "Osamu"};
+constexpr std::array<std::string_view, 96> LAST_NAMES{"Kirby", "Lee", "Ditko", "Sinnott", "Romita", "Kane", "Colan",
+    "Barks", "Heck", "Ayers", "Wood", "Everett", "Frazetta", "Severin", "Fradon", "Toth", "Adams", "Steranko",
+    "Thomas", "Wein", "Claremont", "Grell", "Simonson", "Byrne", "Miller", "Kahn", "Trimble", "Nocenti", "Robbins",
+    "Buscema", "Trimpe", "Colletta", "Perez", "Shores", "Aragones", "Schiff", "Ross", "Infantino", "Anderson",
+    "Giordano", "Orlando", "Kubert", "Eisner", "Cole", "Fox", "Gardner", "Binder", "Beck", "Swan", "Dillin",
+    "Novick", "Kupperberg", "Moore", "Morrison", "Gaiman", "Simone", "Thompson", "Staples", "Bellaire", "Oliff",
+    "Rozum", "Goldberg", "Simek", "Rosen", "Costanza", "Klein", "Brodsky", "Janson", "Austin", "Giacoia", "Mooney",
+    "Tuska", "Andru", "Esposito", "Milgrom", "Mantlo", "Englehart", "Gerber", "Starlin", "Wolfman", "Conway",
+    "Ordway", "Sutton", "Marcos", "Palmer", "Trapani", "Wrightson", "Kaluta", "Chaykin", "Weiss", "Jones", "Ploog",
+    "Heath", "Maneely", "Sekowsky", "Orzechowski"};
+constexpr std::array<std::string_view, 16> SERIES_PREFIXES{"The Amazing", "Tales of the", "Adventures of the",
+    "The Mighty", "Strange Tales of the", "The Uncanny", "Astonishing", "Journey with the", "The Incredible",
+    "Weird Tales of the", "The Mysterious", "The Savage", "The Spectacular", "The Sensational", "All-Star",
+    "The Brave"};
+constexpr std::array<std::string_view, 40> HEROES{"Spider", "Hulk", "Thunderer", "Phantom", "Ghost", "Comet",
+    "Falcon", "Sentinel", "Avenger", "Defender", "Marvel", "Wasp", "Hornet", "Raven", "Panther", "Lantern", "Arrow",
+    "Flash", "Atom", "Hawk", "Shadow", "Spectre", "Wraith", "Titan", "Cyclone", "Meteor", "Nova", "Vision", "Mantis",
+    "Torch", "Sub-Mariner", "Ranger", "Kid", "Doll", "Crusader", "Guardian", "Outlaw", "Valkyrie", "Mystic",
+    "Archer"};
+constexpr std::array<std::string_view, 32> TITLE_WORDS{"Menace", "Return", "Secret", "Night", "Revenge", "City",
+    "Doom", "Beast", "Island", "Star", "Fire", "Shadow", "Monster", "World", "Machine", "Master", "Curse", "Trap",
+    "Crown", "Storm", "Tomb", "Dragon", "Ghost", "Invasion", "Mirror", "Empire", "Serpent", "Twilight", "Planet",
+    "Stone", "Thunder", "Clock"};
+constexpr std::array<std::string_view, 8> PUBLISHERS{"Marvel", "DC", "Dell", "Gold Key", "Charlton", "Harvey",
+    "Archie", "Fawcett"};
+constexpr std::array<std::string_view, 6> GENRES{"superhero", "science fiction", "western", "horror", "humor",
+    "romance"};
+constexpr std::array<std::string_view, 12> MONTHS{"January", "February", "March", "April", "May", "June", "July",
+    "August", "September", "October", "November", "December"};
+constexpr std::array<std::string_view, 4> CREDIT_NOTES{" (credited)", " (signed)", " ?", " (see notes)"};
+constexpr std::string_view PRICES[]{"0.10 USD", "0.12 USD", "0.15 USD", "0.20 USD", "0.35 USD", "0.60 USD",
+    "1.00 USD", "2.99 USD", "3.99 USD"};
+
+constexpr std::size_t CHARACTERS{2'000};
+constexpr std::size_t FIRST_YEAR{1935};
+constexpr std::size_t YEARS{90};
+
+std::string seriesName(std::size_t series)
+{
+    std::string name{SERIES_PREFIXES[series % SERIES_PREFIXES.size()]};
+    name += ' ';
+    name += HEROES[series / SERIES_PREFIXES.size() % HEROES.size()];
+    if (const std::size_t volume{series / (SERIES_PREFIXES.size() * HEROES.size())}; volume > 0)
+    {
+        name += " (";
+        name += std::to_string(volume + 1);
+        name += ')';
+    }
+    return name;
+}
+
+std::string characterName(std::size_t rank)
+{
+    if (rank < HEROES.size())
+    {
+        return std::string{"The "}.append(HEROES[rank]);
+    }
+    return creatorName(rank * 7 + 3);
+}
+
+// Walks the issues in order, starting a new series when the run of the current one ends, so the issues
+// and sequences dumps agree on each issue's series.
+class SeriesWalker
+{
+public:
+    explicit SeriesWalker(std::uint64_t seed) :
+        m_random(seed ^ 0x5E81E5ULL)
+    {
+    }
+
+    void next()
+    {
+        if (m_left == 0)
+        {
+            ++m_series;
+            m_number = 0;
+            // mostly short runs and limited series, with a few long running titles
+            m_left = m_random.chance(0.3) ? 1 + m_random.below(6) : 1 + m_random.below(120);
+        }
+        --m_left;
+        ++m_number;
+    }
+    std::size_t series() const
+    {
+        return m_series;
+    }
+    std::size_t number() const
+    {
+        return m_number;
+    }
+
+private:
+    SynthRandom m_random;
+    std::size_t m_series{~std::size_t{}};
+    std::size_t m_number{};
+    std::size_t m_left{};
+};
+
+// Formats dump lines into reused buffers.  The converter keeps views of the lines of a record until
+// the first line of the next one, so a record's lines stay in one buffer while the next record fills
+// the other.
+class DumpWriter
+{
+public:
+    DumpWriter(OutputBuffer &tsv, DumpConverter *json) :
+        m_tsv(tsv),
+        m_json(json)
+    {
+    }
+
+    void setRecord(std::size_t recordId, std::size_t sequenceId = 0)
+    {
+        convertRecord();
+        m_current ^= 1;
+        m_records[m_current].clear();
+        m_prefix = '"';
+        m_prefix += std::to_string(recordId);
+        m_prefix += "\"\t";
+        if (sequenceId != 0)
+        {
+            m_prefix += '"';
+            m_prefix += std::to_string(sequenceId);
+            m_prefix += "\"\t";
+        }
+    }
+
+    void line(std::string_view name, std::string_view value)
+    {
+        std::string &record{m_records[m_current]};
+        const std::size_t start{record.size()};
+        record += m_prefix;
+        record += '"';
+        record += name;
+        record += "\"\t\"";
+        for (const char c : value)
+        {
+            if (c == '"')
+            {
+                record += '"';
+            }
+            record += c;
+        }
+        record += "\"\n";
+        m_tsv << std::string_view{record}.substr(start);
+    }
+
+    // Give the lines of the last record to the converter and finish it.
+    void finish()
+    {
+        convertRecord();
+        if (m_json != nullptr)
+        {
+            m_json->finish();
+        }
+    }
+
+private:
+    void convertRecord()
+    {
+        if (m_json == nullptr)
+        {
+            return;
+        }
+        std::string_view lines{m_records[m_current]};
+        while (!lines.empty())
+        {
+            const std::size_t end{lines.find('\n')};
+            m_json->addLine(lines.substr(0, end));
+            lines.remove_prefix(end + 1);
+        }
+    }
+
+    OutputBuffer &m_tsv;
+    DumpConverter *m_json;
+    std::string m_prefix;
+    std::string m_records[2];
+    int m_current{};
+};
+
+// One to three names, as "name; name" with the odd annotation.
+void appendCredit(std::string &text, SynthRandom &random, std::size_t firstRank, const ZipfDistribution &creators)
+{
+    const double count{random.unit()};
+    const std::size_t names{count < 0.8 ? 1U : count < 0.95 ? 2U : 3U};
+    for (std::size_t i = 0; i < names; ++i)
+    {
+        if (i > 0)
+        {
+            text += "; ";
+        }
+        text += creatorName(i == 0 ? firstRank : creators(random));
+        if (random.chance(0.1))
+        {
+            text += CREDIT_NOTES[random.below(CREDIT_NOTES.size())];
+        }
+    }
+}
+
+} // namespace
+
+ZipfDistribution::ZipfDistribution(std::size_t count, double exponent)
+{
+    if (count == 0)
+    {
+        throw std::invalid_argument("Zipf distribution needs at least one rank");
+    }
+    m_cumulative.reserve(count);
+    double sum{};
+    for (std::size_t rank = 0; rank < count; ++rank)
+    {
+        sum += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+        m_cumulative.push_back(sum);
+    }
+    for (double &value : m_cumulative)
+    {
+        value /= sum;
+    }
+}
+
+std::size_t ZipfDistribution::operator()(SynthRandom &random) const
+{
+    const auto it = std::upper_bound(m_cumulative.begin(), m_cumulative.end(), random.unit());
+    return std::min(static_cast<std::size_t>(it - m_cumulative.begin()), m_cumulative.size() - 1);
+}
+
+double ZipfDistribution::probability(std::size_t rank) const
+{
+    return m_cumulative[rank] - (rank == 0 ? 0.0 : m_cumulative[rank - 1]);
+}
+
+std::string creatorName(std::size_t rank)
+{
+    constexpr std::size_t names{FIRST_NAMES.size() * LAST_NAMES.size()};
+    std::string name{FIRST_NAMES[rank % FIRST_NAMES.size()]};
+    const std::size_t generation{rank / names};
+    if (generation > 0 && generation <= 26)
+    {
+        name += ' ';
+        name += static_cast<char>('A' + generation - 1);
+        name += '.';
+    }
+    name += ' ';
+    name += LAST_NAMES[rank / FIRST_NAMES.size() % LAST_NAMES.size()];
+    if (generation > 26)
+    {
+        name += ' ';
+        name += std::to_string(generation - 25);
+    }
+    return name;
+}
+
+void synthesizeIssues(const SynthOptions &options, OutputBuffer &tsv, DumpConverter *json)
+{
+    SynthRandom random{options.seed};
+    SeriesWalker walker{options.seed};
+    DumpWriter writer{tsv, json};
+    std::string value;
+    for (std::size_t issue = 0; issue < options.issues; ++issue)
+    {
+        walker.next();
+        const std::size_t year{FIRST_YEAR + issue * YEARS / options.issues};
+        const std::size_t month{(walker.number() - 1) % 12};
+        const std::string number{std::to_string(walker.number())};
+        const std::string_view publisher{PUBLISHERS[walker.series() % PUBLISHERS.size()]};
+
+        writer.setRecord(issue + 1);
+        writer.line("series name", seriesName(walker.series()));
+        writer.line("issue number", number);
+        writer.line("display number", "#" + number);
+        writer.line("publisher name", publisher);
+        writer.line("brand group names", publisher);
+        value = std::to_string(year);
+        value += month < 9 ? "-0" : "-";
+        value += std::to_string(month + 1);
+        value += "-00";
+        writer.line("key date", value);
+        value = MONTHS[month];
+        value += ' ';
+        value += std::to_string(year);
+        writer.line("publication date", value);
+        writer.line("price", PRICES[(year - FIRST_YEAR) * std::size(PRICES) / YEARS]);
+        writer.line("issue page count", random.chance(0.9) ? "36.000" : "68.000");
+        writer.line("issue page count uncertain", random.chance(0.05) ? "True" : "False");
+        writer.line("language code", "en");
+        writer.line("no volume", "False");
+        writer.line("volume", std::to_string(walker.series() / (SERIES_PREFIXES.size() * HEROES.size()) + 1));
+        writer.line("series country code", "us");
+        writer.line("publisher country code", "us");
+    }
+    writer.finish();
+}
+
+void synthesizeSequences(const SynthOptions &options, OutputBuffer &tsv, DumpConverter *json)
+{
+    SynthRandom random{options.seed ^ 0x5E0E2CE5ULL};
+    SeriesWalker walker{options.seed};
+    const ZipfDistribution creators{options.creators, options.zipfExponent};
+    const ZipfDistribution characters{CHARACTERS, 1.0};
+    DumpWriter writer{tsv, json};
+    std::string value;
+    std::size_t sequenceId{};
+    std::size_t remaining{options.sequences};
+    for (std::size_t issue = 0; issue < options.issues; ++issue)
+    {
+        walker.next();
+        // spread what is left over the issues left, between half and one and a half times the average
+        const std::size_t issuesLeft{options.issues - issue};
+        const double average{static_cast<double>(remaining) / static_cast<double>(issuesLeft)};
+        const std::size_t count{issuesLeft == 1
+                ? remaining
+                : std::min(remaining, static_cast<std::size_t>(std::lround(average * (0.5 + random.unit()))))};
+        remaining -= count;
+        const std::string_view hero{HEROES[walker.series() / SERIES_PREFIXES.size() % HEROES.size()]};
+        const std::string_view genre{GENRES[walker.series() % GENRES.size()]};
+        // a series keeps much of its creative team from issue to issue
+        const std::size_t regularWriter{creators(random)};
+        const std::size_t regularArtist{creators(random)};
+
+        for (std::size_t sequence = 0; sequence < count; ++sequence)
+        {
+            writer.setRecord(issue + 1, ++sequenceId);
+            writer.line("sequence_number", std::to_string(sequence));
+            const double kind{random.unit()};
+            const std::string_view type{sequence == 0 ? "cover"
+                    : kind < 0.7                      ? "comic story"
+                    : kind < 0.85                     ? "advertisement"
+                    : kind < 0.92                     ? "text story"
+                                                      : "letters page"};
+            writer.line("type", type);
+            if (type == "advertisement")
+            {
+                writer.line("page count", "1.000");
+                if (random.chance(0.3))
+                {
+                    writer.line("pencils", "?");
+                }
+                continue;
+            }
+
+            if (type != "cover" || random.chance(0.3))
+            {
+                value = "The ";
+                value += TITLE_WORDS[random.below(TITLE_WORDS.size())];
+                value += " of the ";
+                value += TITLE_WORDS[random.below(TITLE_WORDS.size())];
+                value += '!';
+                writer.line("title", value);
+            }
+            writer.line("title by gcd", random.chance(0.1) ? "True" : "False");
+            writer.line("feature", hero);
+            writer.line("genre", genre);
+            writer.line("page count", type == "cover" ? "1.000" : std::to_string(1 + random.below(22)) + ".000");
+
+            const std::size_t writerRank{random.chance(0.7) ? regularWriter : creators(random)};
+            value.clear();
+            appendCredit(value, random, writerRank, creators);
+            writer.line("script", value);
+            if (type == "text story" || type == "letters page")
+            {
+                continue;
+            }
+            const std::size_t pencilsRank{random.chance(0.7) ? regularArtist : creators(random)};
+            value.clear();
+            appendCredit(value, random, pencilsRank, creators);
+            writer.line("pencils", value);
+            value.clear();
+            appendCredit(value, random, random.chance(0.3) ? pencilsRank : creators(random), creators);
+            writer.line("inks", value);
+            value.clear();
+            appendCredit(value, random, creators(random), creators);
+            writer.line("colors", value);
+            if (random.chance(0.8))
+            {
+                value.clear();
+                appendCredit(value, random, creators(random), creators);
+                writer.line("letters", value);
+            }
+            value = characterName(walker.series() / SERIES_PREFIXES.size() % HEROES.size());
+            for (std::size_t i = 1 + random.below(4); i > 0; --i)
+            {
+                value += "; ";
+                value += characterName(characters(random));
+            }
+            writer.line("characters", value);
+        }
+    }
+    writer.finish();
+}
+
+} // namespace comics
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "comics/options.h"
+#include "comics/query.h"
+
 #include <filesystem>
 #include <memory>
 #include <ostream>
@@ -12,12 +15,16 @@ class Database
 public:
     virtual ~Database() = default;
 
+    // How the print functions match names against credits; SUBSTRING by default.
+    virtual void setMatchMode(MatchMode mode) = 0;
+
     virtual void printScriptSequences(std::ostream &str, const std::string &name) = 0;
     virtual void printPencilSequences(std::ostream &str, const std::string &name) = 0;
     virtual void printInkSequences(std::ostream &str, const std::string &name) = 0;
     virtual void printColorSequences(std::ostream &str, const std::string &name) = 0;
+    virtual void printLetterSequences(std::ostream &str, const std::string &name) = 0;
 };
 
-std::shared_ptr<Database> createDatabase(const std::filesystem::path &jsonDir);
+std::shared_ptr<Database> createDatabase(const std::filesystem::path &jsonDir, const DatabaseOptions &options = {});
 
 } // namespace comics
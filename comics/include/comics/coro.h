@@ -1,43 +1,146 @@
 #pragma once
 
+#include "comics/credit-index.h"
+#include "comics/options.h"
+#include "comics/query-cache.h"
+#include "comics/query.h"
+#include "comics/record-reader.h"
+#include "comics/stats.h"
+#include "comics/table.h"
+#include "comics/thread-pool.h"
+#include "comics/trace.h"
+#include "comics/trigram-index.h"
+
 #include <simdjson.h>
 
 #include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
 #include <memory>
+#include <span>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace comics
 {
 namespace coroutine
 {
 
+enum class CreditField
+{
+    NONE = 0,
+    SCRIPT = 1,
+    PENCIL = 2,
+    INK = 3,
+    COLOR = 4,
+    LETTER = 5
+};
+
+// One condition of a credit query: the credits of a field match a name.
+struct CreditPredicate
+{
+    CreditField field;
+    std::string_view name;
+};
+
+// How the predicates of a credit query are combined.
+enum class Combine
+{
+    ALL = 0, // every predicate matches
+    ANY = 1  // at least one predicate matches
+};
+
 class Database
 {
 public:
     virtual ~Database() = default;
     virtual simdjson::simdjson_result<simdjson::dom::element> getIssues() const = 0;
     virtual simdjson::simdjson_result<simdjson::dom::element> getSequences() const = 0;
+
+    // Look up an issue by id; throws if there is no such issue.
+    // The default implementation scans getIssues(); databases that index their issues override it.
+    virtual simdjson::dom::object findIssue(int id) const;
+
+    // Columnar views of the issues and sequences, for databases that have them.
+    // Databases loaded from a snapshot have tables but no JSON documents.
+    virtual const Table *getIssueTable() const
+    {
+        return nullptr;
+    }
+    virtual const Table *getSequenceTable() const
+    {
+        return nullptr;
+    }
+    // Look up the row of an issue in getIssueTable() by id; throws if there is no such issue.
+    virtual std::size_t findIssueRow(int id) const;
+
+    // Creator name index of a credit field, or nullptr if the database doesn't index credits.
+    // Only databases with tables index credits, so rows are getSequenceTable() rows.
+    virtual const CreditIndex *getCreditIndex(CreditField) const
+    {
+        return nullptr;
+    }
+    // Trigram index of a credit field, or nullptr if the database wasn't asked to build one.
+    // Rows are numbered as for getCreditIndex().
+    virtual const TrigramIndex *getTrigramIndex(CreditField) const
+    {
+        return nullptr;
+    }
+    // Case and accent folded copy of a credit column of getSequenceTable(), or nullptr if the
+    // database has no tables or the column.  MatchMode::FOLDED queries scan it.
+    virtual const StringColumn *getFoldedCredits(CreditField) const
+    {
+        return nullptr;
+    }
+    // A new pass over the sequences for databases that stream them from disk instead of holding
+    // them in memory, or nullptr.  Matches from a stream refer to getIssueTable() rows.
+    virtual std::unique_ptr<RecordReader> streamSequences() const
+    {
+        return nullptr;
+    }
+    // Threads to split table scans across, or nullptr to scan serially.
+    virtual ThreadPool *getThreadPool() const
+    {
+        return nullptr;
+    }
+    // Where loading and queries add their timings and counters, or nullptr if they aren't collected.
+    virtual QueryStats *getStats() const
+    {
+        return nullptr;
+    }
+    // Result sets of earlier single name queries, or nullptr if the database wasn't asked to cache
+    // them.  Rows are getSequenceTable() rows.
+    virtual QueryCache *getQueryCache() const
+    {
+        return nullptr;
+    }
 };
 
 using DatabasePtr = std::shared_ptr<Database>;
 
-DatabasePtr createDatabase(const std::filesystem::path &jsonDir);
+DatabasePtr createDatabase(const std::filesystem::path &jsonDir, const DatabaseOptions &options = {});
 
-enum class CreditField
-{
-    NONE = 0,
-    SCRIPT = 1,
-    PENCIL = 2,
-    INK = 3,
-    COLOR = 4,
-    LETTER = 5
-};
+constexpr std::size_t NO_ROW{~std::size_t{}};
 
 struct SequenceMatch
 {
     simdjson::dom::object issue;
     simdjson::dom::object sequence;
+    // Rows in the database tables when the match came from a table scan instead of the JSON documents.
+    std::size_t issueRow{NO_ROW};
+    std::size_t sequenceRow{NO_ROW};
+    // Ascending positions in a batch query's names of the names the credit matched.
+    std::vector<std::uint32_t> names{};
+};
+
+// A match whose JSON is only valid until the generator resumes, such as a record streamed from
+// disk; yielding one always suspends, so it ends the batch it is in.
+struct TransientMatch
+{
+    SequenceMatch match;
 };
 
 class MatchGenerator
@@ -53,10 +156,48 @@ public:
         {
             return {};
         }
-        std::suspend_always yield_value(const SequenceMatch &value)
+        // Suspends once the batch is full, so a batched resume runs the scan without suspending per match.
+        struct YieldAwaiter
         {
-            m_data = value;
-            return {};
+            bool batchFull;
+
+            bool await_ready() const noexcept
+            {
+                return !batchFull;
+            }
+            void await_suspend(std::coroutine_handle<>) const noexcept
+            {
+            }
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        YieldAwaiter yield_value(const SequenceMatch &value)
+        {
+            m_batch.push_back(value);
+            return suspendIfFull();
+        }
+        YieldAwaiter yield_value(SequenceMatch &&value)
+        {
+            m_batch.push_back(std::move(value));
+            return suspendIfFull();
+        }
+        YieldAwaiter yield_value(const TransientMatch &value)
+        {
+            m_batch.push_back(value.match);
+            m_transient = true;
+            traceInstant("suspend", static_cast<std::int64_t>(m_batch.size()));
+            return {true};
+        }
+        YieldAwaiter suspendIfFull()
+        {
+            const bool full{m_batch.size() >= m_capacity};
+            if (full)
+            {
+                traceInstant("suspend", static_cast<std::int64_t>(m_batch.size()));
+            }
+            return {full};
         }
         void return_void()
         {
@@ -67,10 +208,13 @@ public:
         }
         void unhandled_exception()
         {
-            std::terminate();
+            m_exception = std::current_exception();
         }
 
-        mutable SequenceMatch m_data;
+        std::vector<SequenceMatch> m_batch;
+        std::size_t m_capacity{1};
+        bool m_transient{};
+        std::exception_ptr m_exception;
     };
     using promise_type = Promise;
     using Handle = std::coroutine_handle<promise_type>;
@@ -87,19 +231,46 @@ public:
 
     bool resume()
     {
-        if (!m_handle || m_handle.done())
+        return !resumeBatch(1).empty();
+    }
+
+    // The match of the last resume(), which is moved out of the generator.
+    SequenceMatch getMatch() const
+    {
+        std::vector<SequenceMatch> &batch{m_handle.promise().m_batch};
+        return batch.empty() ? SequenceMatch{} : std::move(batch.front());
+    }
+
+    // Run the scan until it yields up to capacity matches or ends, and return them; an empty
+    // span means there are no more.  The matches are valid until the next resume.
+    // An exception thrown by the scan is rethrown here.
+    std::span<const SequenceMatch> resumeBatch(std::size_t capacity)
+    {
+        if (!m_handle)
         {
-            return false;
+            return {};
         }
-        m_handle.resume();
-        return !m_handle.done();
+        TraceSpan span{"resume"};
+        Promise &promise{m_handle.promise()};
+        promise.m_batch.clear();
+        promise.m_capacity = capacity;
+        promise.m_transient = false;
+        if (!m_handle.done())
+        {
+            m_handle.resume();
+        }
+        if (promise.m_exception)
+        {
+            std::rethrow_exception(std::exchange(promise.m_exception, nullptr));
+        }
+        span.setValue(static_cast<std::int64_t>(promise.m_batch.size()));
+        return promise.m_batch;
     }
 
-    SequenceMatch getMatch() const
+    // True if the last resume yielded a TransientMatch.
+    bool transient() const
     {
-        const SequenceMatch match{m_handle.promise().m_data};
-        m_handle.promise().m_data = SequenceMatch{};
-        return match;
+        return m_handle && m_handle.promise().m_transient;
     }
 
 private:
@@ -111,7 +282,26 @@ private:
     Handle m_handle;
 };
 
-MatchGenerator matches(DatabasePtr database, CreditField creditField, std::string_view name);
+// With MatchOrder::SEQUENCE the matches are found first and then yielded by issue and sequence
+// number; this needs the sequences in memory, so it throws for databases that stream them.
+// With a query cache, the rows of a query that was answered before are yielded without scanning,
+// and the rows of a scan run to its end are cached.
+MatchGenerator matches(DatabasePtr database, CreditField creditField, std::string_view name,
+    MatchMode mode = MatchMode::SUBSTRING, MatchOrder order = MatchOrder::SCAN);
+
+// Answer every name in one pass over the sequences, yielding each sequence matching any of them
+// once, tagged with the names it matched.  The names must outlive the generator.
+MatchGenerator matches(DatabasePtr database, CreditField creditField, std::span<const std::string_view> names,
+    MatchMode mode = MatchMode::SUBSTRING, MatchOrder order = MatchOrder::SCAN);
+
+// Answer a query over several credit fields, such as a script by one creator and pencils by
+// another, evaluating every predicate against each sequence in a single pass.  When the database
+// has credit or trigram indexes for the predicates, the smallest of their posting lists drives the
+// query and is intersected with the others (or all of them are merged with Combine::ANY), so only
+// those rows are checked.  With Combine::ANY each match is tagged with the positions of the
+// predicates it matched.  The predicates must outlive the generator.
+MatchGenerator matches(DatabasePtr database, std::span<const CreditPredicate> predicates,
+    Combine combine = Combine::ALL, MatchMode mode = MatchMode::SUBSTRING, MatchOrder order = MatchOrder::SCAN);
 
 } // namespace coroutine
 } // namespace comics
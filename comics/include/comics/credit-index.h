@@ -0,0 +1,131 @@
+#pragma once
+
+#include "comics/table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace comics
+{
+
+// Normalize a single creator name: collapse runs of whitespace, drop a trailing
+// uncertainty marker ('?') and fold ASCII letters to lower case.
+std::string normalizeCreator(std::string_view name);
+
+// Split a GCD credit string such as "Stan Lee (signed as Stan Lee [early]); Sol Brodsky ?"
+// into normalized creator names, dropping (...) and [...] annotations.
+void creatorNames(std::vector<std::string> &names, std::string_view credits);
+
+// True if the credits name the creator, which must already be normalized.
+bool creditsName(std::string_view credits, std::string_view creator);
+
+// Ascending row numbers, stored as LEB128 encoded deltas.
+class PostingList
+{
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::uint32_t *;
+        using reference = std::uint32_t;
+
+        Iterator() = default;
+        Iterator(const std::uint8_t *pos, const std::uint8_t *end) :
+            m_pos(pos),
+            m_end(end)
+        {
+            decode();
+        }
+
+        std::uint32_t operator*() const
+        {
+            return m_row;
+        }
+        Iterator &operator++()
+        {
+            decode();
+            return *this;
+        }
+        bool operator==(const Iterator &rhs) const
+        {
+            return m_done == rhs.m_done && (m_done || m_pos == rhs.m_pos);
+        }
+
+    private:
+        void decode();
+
+        const std::uint8_t *m_pos{};
+        const std::uint8_t *m_end{};
+        std::uint32_t m_row{};
+        bool m_done{true};
+    };
+
+    // Rows must be appended in ascending order; repeating the last row is ignored.
+    void append(std::uint32_t row);
+
+    std::size_t size() const
+    {
+        return m_count;
+    }
+    bool empty() const
+    {
+        return m_count == 0;
+    }
+    std::size_t bytes() const
+    {
+        return m_bytes.size();
+    }
+    // The encoded deltas, which Iterator decodes.
+    std::span<const std::uint8_t> encoded() const
+    {
+        return m_bytes;
+    }
+
+    Iterator begin() const
+    {
+        return {m_bytes.data(), m_bytes.data() + m_bytes.size()};
+    }
+    Iterator end() const
+    {
+        return {};
+    }
+
+private:
+    std::vector<std::uint8_t> m_bytes;
+    std::uint32_t m_last{};
+    std::size_t m_count{};
+};
+
+// Maps normalized creator names of one credit field to the rows crediting them.
+class CreditIndex
+{
+public:
+    // Rows must be added in ascending order.
+    void add(std::uint32_t row, std::string_view credits);
+
+    // Rows whose credits name the creator, or nullptr if there are none.
+    const PostingList *find(std::string_view creator) const;
+
+    std::size_t creators() const
+    {
+        return m_postings.size();
+    }
+
+private:
+    std::unordered_map<std::string, PostingList> m_postings;
+    std::vector<std::string> m_names;
+};
+
+// Index a credit column of a sequence table; rows are table rows.
+CreditIndex buildCreditIndex(const StringColumn &column);
+
+} // namespace comics
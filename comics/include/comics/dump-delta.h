@@ -0,0 +1,115 @@
+#pragma once
+
+#include "comics/snapshot.h"
+#include "comics/table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace comics
+{
+
+// Record list written beside a converted dump, so the next conversion of the dump only converts
+// the records that changed.  Layout, all values in host byte order:
+//   RecordListHeader
+//   RecordEntry[recordCount], in output order
+constexpr char RECORDS_MAGIC[8]{'G', 'C', 'D', 'R', 'E', 'C', 'S', '\0'};
+constexpr std::uint32_t RECORDS_VERSION{2};
+
+// The output options a record list was written with; records are only reused with the same options.
+enum RecordFlags : std::uint32_t
+{
+    RECORDS_SINGLE_LINE = 1,
+    RECORDS_NDJSON = 2,
+    RECORDS_SNAPSHOT = 4,
+};
+
+struct RecordListHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t recordCount;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+    FileStamp json; // of the output the records were written to, once complete
+};
+
+struct RecordEntry
+{
+    std::uint64_t key;    // recordKey of the record's ids
+    std::uint64_t hash;   // hashRecord of the record's lines in the dump
+    std::uint64_t offset; // of the record's JSON object in the output
+    std::uint32_t length; // of the record's JSON object
+    std::uint32_t row;    // of the record in the snapshot, if one was written
+};
+
+inline std::uint64_t recordKey(std::int32_t recordId, std::int32_t sequenceId)
+{
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(recordId)) << 32 | static_cast<std::uint32_t>(sequenceId);
+}
+
+// Hash of the dump lines of a record; equal lines convert to equal JSON.
+std::uint64_t hashRecord(std::string_view lines);
+
+// Write the records of the output json, which must be complete and in its final place.
+void writeRecordList(const std::filesystem::path &path, std::uint32_t flags, const std::filesystem::path &json,
+    std::span<const RecordEntry> records);
+
+// The output of an earlier conversion of a dump, mapped read-only.
+class PreviousConversion
+{
+public:
+    // Throws if a file is missing, was written with other flags or columns, or the JSON was
+    // rewritten since the record list was.  The snapshot is only read with RECORDS_SNAPSHOT.
+    PreviousConversion(const std::filesystem::path &records, const std::filesystem::path &json,
+        const std::filesystem::path &snapshot, std::uint32_t flags, const std::vector<ColumnSpec> &columns);
+
+    const RecordEntry *find(std::uint64_t key) const;
+    std::string_view json(const RecordEntry &record) const
+    {
+        return {m_json.data() + record.offset, record.length};
+    }
+    // The snapshot table, or nullptr without RECORDS_SNAPSHOT.
+    const Table *table() const
+    {
+        return m_snapshot ? &m_snapshot->table() : nullptr;
+    }
+    std::size_t records() const
+    {
+        return m_records.size();
+    }
+    // Number of previous records with none of the keys of the new records.
+    std::size_t removed(std::span<const RecordEntry> records) const;
+
+private:
+    MappedFile m_file;
+    MappedFile m_json;
+    std::optional<Snapshot> m_snapshot;
+    std::span<const RecordEntry> m_records;
+    std::unordered_map<std::uint64_t, std::uint32_t> m_index;
+};
+
+// How the records of a conversion compare with those of the previous one.
+struct DeltaCounts
+{
+    std::size_t unchanged{};
+    std::size_t changed{};
+    std::size_t added{};
+};
+
+// The records a conversion writes, and the earlier conversion whose unchanged records it copies.
+struct RecordTracking
+{
+    const PreviousConversion *previous{};
+    std::vector<RecordEntry> records{};
+    DeltaCounts counts{};
+};
+
+} // namespace comics
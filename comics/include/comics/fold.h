@@ -0,0 +1,41 @@
+#pragma once
+
+#include "comics/table.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace comics
+{
+
+// Fold UTF-8 text for case and accent insensitive matching: letters are case folded, Latin
+// letters lose their diacritics ("Mœbius" and "MOEBIUS" both fold to "moebius") and combining
+// marks are dropped.  Greek and Cyrillic letters are case folded; other characters and bytes that
+// aren't valid UTF-8 are kept as they are.
+std::string foldText(std::string_view text);
+
+// Append the folded text to result.
+void appendFolded(std::string &result, std::string_view text);
+
+// A copy of a string column with every value folded, so folded searches scan a column as fast
+// as exact ones.  Rows line up with the source column, and absent values stay absent.
+class FoldedColumn
+{
+public:
+    FoldedColumn() = default;
+    explicit FoldedColumn(const StringColumn &column);
+
+    // The view is invalidated if the folded column is moved or destroyed.
+    StringColumn column() const
+    {
+        return {m_offsets.data(), m_blob.data(), m_offsets.empty() ? 0 : m_offsets.size() - 1};
+    }
+
+private:
+    std::vector<std::uint64_t> m_offsets;
+    std::string m_blob;
+};
+
+} // namespace comics
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "comics/snapshot.h"
+
+#include <simdjson.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace comics
+{
+
+// Collects output in a reusable buffer and hands it to a stream in large writes, so printing
+// many matches costs neither an allocation per field nor a stream call per piece of text.
+// Whatever is still buffered is written when the buffer is destroyed.
+class OutputBuffer
+{
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY{64 * 1024};
+
+    explicit OutputBuffer(std::ostream &str, std::size_t capacity = DEFAULT_CAPACITY);
+    OutputBuffer(const OutputBuffer &rhs) = delete;
+    OutputBuffer &operator=(const OutputBuffer &rhs) = delete;
+    ~OutputBuffer();
+
+    OutputBuffer &operator<<(std::string_view text)
+    {
+        if (m_size + text.size() > m_buffer.size())
+        {
+            appendSlow(text);
+            return *this;
+        }
+        text.copy(m_buffer.data() + m_size, text.size());
+        m_size += text.size();
+        return *this;
+    }
+    OutputBuffer &operator<<(char c)
+    {
+        if (m_size == m_buffer.size())
+        {
+            flush();
+        }
+        m_buffer[m_size++] = c;
+        return *this;
+    }
+    OutputBuffer &operator<<(std::int64_t value);
+
+    // Write the buffered text to the stream.
+    void flush();
+
+    // Bytes given to the buffer so far, written or not.
+    std::uint64_t written() const
+    {
+        return m_flushed + m_size;
+    }
+
+private:
+    void appendSlow(std::string_view text);
+
+    std::ostream &m_str;
+    std::vector<char> m_buffer;
+    std::size_t m_size{};
+    std::uint64_t m_flushed{};
+};
+
+// Print the title, feature and credits of a sequence, one "key: value" line each with the keys
+// right aligned, skipping those the sequence doesn't have.
+void formatSequence(OutputBuffer &out, const SequenceColumns &sequences, std::size_t row);
+void formatSequence(OutputBuffer &out, simdjson::dom::object sequence);
+
+} // namespace comics
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "comics/dump-delta.h"
+#include "comics/formatter.h"
+#include "comics/table.h"
+#include "comics/thread-pool.h"
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace comics
+{
+
+// The name-value dumps of the GCD that gcd-to-json converts.
+enum class DumpKind
+{
+    ISSUES,    // "id", name, value
+    SEQUENCES, // "issue", sequence id, name, value
+};
+
+struct ConvertOptions
+{
+    bool singleLineRecords{};
+    // newline delimited JSON: one record per line, without the enclosing array
+    bool ndjson{};
+};
+
+// Where the lines given to a converter lie in a dump split into parts, so that the JSON of the parts
+// concatenates to that of the whole dump.
+struct DumpPart
+{
+    bool first{true};
+    bool last{true};
+};
+
+// Converts the lines of a GCD name-value dump into JSON records, one record per run of lines with the same
+// id, keys sorted.  Lines are quoted fields separated by tabs; values of "True" and "False" become JSON
+// booleans and doubled quotes become escaped quotes.  Fields are views of the lines, so the dump text
+// must outlive the converter; nothing is allocated per field once the scratch buffers have grown.
+// If a table is given, each record is also appended to it, as in a snapshot.
+class DumpConverter
+{
+public:
+    DumpConverter(DumpKind kind, const ConvertOptions &options, OutputBuffer &json, TableWriter *table = nullptr,
+        DumpPart part = {});
+
+    // Convert one line, without its newline.  Throws for a line with the wrong number of fields.
+    void addLine(std::string_view line);
+
+    // Write the last record and end the JSON.
+    void finish();
+
+    // List each record written in tracking, copying the JSON and snapshot row of a record whose lines
+    // are unchanged since the tracked previous conversion instead of converting it again.
+    void track(RecordTracking &tracking)
+    {
+        m_tracking = &tracking;
+    }
+
+private:
+    void printRecord();
+    void addRow();
+    void writeRecord();
+    void writeEscaped(std::string_view text);
+
+    DumpKind m_kind;
+    ConvertOptions m_options;
+    DumpPart m_part;
+    OutputBuffer &m_json;
+    TableWriter *m_table;
+    const std::vector<ColumnSpec> *m_columns;
+    std::vector<std::string_view> m_fields;
+    // fields of the current record, sorted by name
+    std::vector<std::pair<std::string_view, std::string_view>> m_record;
+    // dump text of the current record's lines
+    const char *m_recordBegin{};
+    const char *m_recordEnd{};
+    RecordTracking *m_tracking{};
+    int m_lastRecordId{-1};
+    int m_lastSequenceId{-1};
+    bool m_firstRecord;
+    std::string m_scratch;
+};
+
+// The decimal integer at the start of text after any white space, as std::stoi reads it.
+int parseLeadingInt(std::string_view text);
+
+constexpr std::size_t DUMP_PART_SIZE{16 * 1024 * 1024};
+
+// Convert a whole dump, calling progress(lines) every thousand lines; returns the number of lines.
+template <typename Progress>
+std::size_t convertDump(std::string_view text, DumpConverter &converter, Progress progress)
+{
+    std::size_t lines{};
+    while (!text.empty())
+    {
+        const std::size_t end{text.find('\n')};
+        converter.addLine(text.substr(0, end));
+        if (++lines % 1000 == 0)
+        {
+            progress(lines);
+        }
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    }
+    converter.finish();
+    return lines;
+}
+
+// Split a dump into parts of about partSize bytes, each ending at the end of a line where the record
+// id changes, so no record spans two parts.
+std::vector<std::string_view> splitDump(std::string_view text, std::size_t partSize);
+
+// Convert a dump with the same output as convertDump, a part per thread of the pool at a time.  The JSON
+// of each round of parts is written to the stream in order once they are all done, and progress(lines)
+// is called after each round.  Records are tracked as DumpConverter::track does if tracking is given.
+// Returns the number of lines.
+std::size_t convertDumpParallel(std::string_view text, DumpKind kind, const ConvertOptions &options, std::ostream &json,
+    TableWriter *table, ThreadPool &pool, RecordTracking *tracking,
+    const std::function<void(std::size_t lines)> &progress, std::size_t partSize = DUMP_PART_SIZE);
+
+} // namespace comics
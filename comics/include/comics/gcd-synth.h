@@ -0,0 +1,83 @@
+#pragma once
+
+#include "comics/formatter.h"
+#include "comics/gcd-converter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace comics
+{
+
+// Shape of a synthetic GCD dataset.  The same options always generate the same dumps.
+struct SynthOptions
+{
+    std::uint64_t seed{1};
+    std::size_t issues{1'000};
+    std::size_t sequences{10'000};
+    // distinct creator names the credit fields draw from
+    std::size_t creators{10'000};
+    // exponent of the Zipf distribution of creator names; 0 draws them uniformly
+    double zipfExponent{1.0};
+};
+
+// Random numbers whose sequence is the same on every platform for a seed, unlike those of the
+// standard distributions.
+class SynthRandom
+{
+public:
+    explicit SynthRandom(std::uint64_t seed) :
+        m_engine(seed)
+    {
+    }
+
+    // In [0, 1).
+    double unit()
+    {
+        return static_cast<double>(m_engine() >> 11) * 0x1.0p-53;
+    }
+    // In [0, count).
+    std::size_t below(std::size_t count)
+    {
+        return static_cast<std::size_t>(unit() * static_cast<double>(count));
+    }
+    bool chance(double probability)
+    {
+        return unit() < probability;
+    }
+
+private:
+    std::mt19937_64 m_engine;
+};
+
+// Ranks in [0, count) where rank k is drawn with probability proportional to 1 / (k + 1)^exponent,
+// by binary search of the cumulative distribution.
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(std::size_t count, double exponent);
+
+    std::size_t operator()(SynthRandom &random) const;
+
+    // Probability of drawing a rank.
+    double probability(std::size_t rank) const;
+
+private:
+    std::vector<double> m_cumulative;
+};
+
+// The creator name of a rank, distinct for every rank.
+std::string creatorName(std::size_t rank);
+
+// Writes the name-value dumps gcd-to-json reads for a synthetic dataset: issues in runs of consecutive
+// numbers of a series, each with a cover and a few stories, ads and fillers whose credits and characters
+// follow Zipf distributions.  Each line is written with its newline to the TSV and, if a converter is
+// given, handed to it without the newline; the converter is finished before returning, as it keeps
+// views of the lines.
+void synthesizeIssues(const SynthOptions &options, OutputBuffer &tsv, DumpConverter *json = nullptr);
+void synthesizeSequences(const SynthOptions &options, OutputBuffer &tsv, DumpConverter *json = nullptr);
+
+} // namespace comics
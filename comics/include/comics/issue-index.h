@@ -0,0 +1,131 @@
+#pragma once
+
+#include "comics/table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace comics
+{
+
+// Flat open-addressing hash table keyed by integer record id.
+// Ids are expected to be non-negative; INT_MIN marks an empty slot.
+template <typename Value>
+class IdIndex
+{
+public:
+    IdIndex() = default;
+    explicit IdIndex(std::size_t count)
+    {
+        reserve(count);
+    }
+
+    void reserve(std::size_t count)
+    {
+        std::size_t capacity{16};
+        while (capacity < count * 2)
+        {
+            capacity *= 2;
+        }
+        if (capacity > m_slots.size())
+        {
+            rehash(capacity);
+        }
+    }
+
+    // Returns false if the id was already present; the existing value is kept.
+    bool insert(int id, const Value &value)
+    {
+        if ((m_size + 1) * 2 > m_slots.size())
+        {
+            rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+        }
+        Slot &slot = m_slots[probe(id)];
+        if (slot.id == id)
+        {
+            return false;
+        }
+        slot.id = id;
+        slot.value = value;
+        ++m_size;
+        return true;
+    }
+
+    const Value *find(int id) const
+    {
+        if (m_slots.empty() || id == EMPTY)
+        {
+            return nullptr;
+        }
+        const Slot &slot = m_slots[probe(id)];
+        return slot.id == id ? &slot.value : nullptr;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+private:
+    static constexpr int EMPTY{std::numeric_limits<int>::min()};
+
+    struct Slot
+    {
+        int id{EMPTY};
+        Value value{};
+    };
+
+    std::size_t bucket(int id) const
+    {
+        // Fibonacci hashing spreads the mostly sequential ids across the table.
+        const std::uint64_t hash = static_cast<std::uint64_t>(static_cast<std::uint32_t>(id)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(hash >> 32) & (m_slots.size() - 1);
+    }
+
+    // Position of the slot holding an id, or of the empty slot where it belongs.
+    std::size_t probe(int id) const
+    {
+        const std::size_t mask{m_slots.size() - 1};
+        for (std::size_t pos = bucket(id);; pos = (pos + 1) & mask)
+        {
+            if (m_slots[pos].id == id || m_slots[pos].id == EMPTY)
+            {
+                return pos;
+            }
+        }
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        std::vector<Slot> slots(capacity);
+        std::swap(slots, m_slots);
+        for (Slot &slot : slots)
+        {
+            if (slot.id != EMPTY)
+            {
+                m_slots[probe(slot.id)] = std::move(slot);
+            }
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    std::size_t m_size{};
+};
+
+using IssueRowIndex = IdIndex<std::size_t>;
+
+// Index the rows of an issue table by its id column.
+IssueRowIndex buildIssueRowIndex(const IntColumn &ids);
+
+// Parse a decimal record id such as the "id" and "issue" keys.
+int parseId(std::string_view text);
+
+} // namespace comics
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "comics/record-reader.h"
+
+#include <simdjson.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace comics
+{
+
+// Reads a file holding one JSON array of records through a fixed size window, so a dump larger
+// than memory can be scanned.  Each window is cut after the last whole record in it and parsed as
+// an array of its own, reusing one parser, so the parser's buffers stay the size of a window.
+// The window only grows if a single record is larger.
+class JSONArrayReader : public RecordReader
+{
+public:
+    static constexpr std::size_t DEFAULT_WINDOW{std::size_t{4} << 20};
+
+    explicit JSONArrayReader(const std::filesystem::path &path, std::size_t window = DEFAULT_WINDOW);
+
+    bool next(simdjson::dom::element &record) override;
+
+    // Bytes of the window, for checking that memory stays bounded.
+    std::size_t window() const
+    {
+        return m_buffer.size() - simdjson::SIMDJSON_PADDING;
+    }
+
+private:
+    bool fill();
+    void scan();
+
+    std::filesystem::path m_path;
+    std::ifstream m_file;
+    // '[' followed by the text of the window, so the records before a cut parse as an array
+    std::vector<char> m_buffer;
+    std::size_t m_size{1};    // bytes in the buffer
+    std::size_t m_scanned{1}; // bytes of the buffer scanned for record boundaries
+    std::size_t m_cut{};      // the comma after the last whole record scanned, or 0
+    std::size_t m_end{};      // one past the array's closing bracket once it is scanned, or 0
+    bool m_finished{};        // the chunk ending with the closing bracket has been parsed
+    // scanner state at m_scanned
+    std::size_t m_depth{};
+    bool m_inString{};
+    bool m_escaped{};
+    simdjson::dom::parser m_parser;
+    simdjson::dom::array::iterator m_record;
+    simdjson::dom::array::iterator m_chunkEnd;
+};
+
+// The window to give each of the issue and sequence readers so that reading and parsing a dump
+// stays within a budget of bytes.  Only one reader is open at a time, but the parser needs roughly
+// 14 bytes for each byte of text it parses.
+std::size_t chunkWindow(std::size_t memoryBudget);
+
+} // namespace comics
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "comics/stats.h"
+
+#include <simdjson.h>
+
+#include <filesystem>
+
+namespace comics
+{
+
+struct JSONPaths
+{
+    std::filesystem::path issues;
+    std::filesystem::path sequences;
+    // whether the issues file comes first in directory order, the order progress is reported in
+    bool issuesFirst;
+};
+
+// Locate the issues and sequences JSON files in a directory; throws if either is missing.
+JSONPaths findJSONFiles(const std::filesystem::path &jsonDir);
+
+// Load the issues and sequences JSON files found by findJSONFiles into their parsers.
+// The two files are read and parsed concurrently, but progress is reported on std::cout
+// in directory order exactly as a serial load would.  Throws if either file can't be read
+// or isn't an array.  Reading and parsing are timed separately in stats, if given.
+void loadJSONFiles(const JSONPaths &paths, simdjson::dom::parser &issueParser,
+    simdjson::simdjson_result<simdjson::dom::element> &issues, simdjson::dom::parser &sequenceParser,
+    simdjson::simdjson_result<simdjson::dom::element> &sequences, QueryStats *stats = nullptr);
+
+} // namespace comics
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "comics/coro.h"
+#include "comics/formatter.h"
+#include "comics/snapshot.h"
+
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace comics
+{
+namespace coroutine
+{
+
+// Prints the matches of one query, heading each run of matches from the same issue with its title.
+class MatchPrinter
+{
+public:
+    explicit MatchPrinter(const Database &database);
+
+    // Print a match; names are the batch query's names, for listing those the match hit.
+    void print(OutputBuffer &out, const SequenceMatch &match, std::span<const std::string_view> names = {});
+
+    // Print every match the generator yields, separated by blank lines; returns the number printed.
+    // Matches are taken from the generator batch at a time and written to the stream in large blocks.
+    std::size_t printAll(
+        std::ostream &str, MatchGenerator &coro, std::span<const std::string_view> names = {}, std::size_t batch = 1);
+
+private:
+    bool isLastTitle(std::string_view seriesName, std::string_view issueNumber) const;
+
+    // Columns of a database loaded from a snapshot or streamed, whose matches refer to table rows.
+    std::optional<IssueColumns> m_issues;
+    std::optional<SequenceColumns> m_sequences;
+    std::string m_lastTitle;
+    QueryStats *m_stats;
+};
+
+} // namespace coroutine
+} // namespace comics
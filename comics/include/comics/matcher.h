@@ -0,0 +1,71 @@
+#pragma once
+
+#include "comics/table.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace comics
+{
+
+// Substring search for one needle against many texts.  The needle is captured once and
+// the search routine is picked at run time for the CPU, like simdjson's implementations.
+class NeedleMatcher
+{
+public:
+    enum class Implementation
+    {
+        SCALAR = 0, // std::string_view::find
+        SSE2 = 1,   // 16 byte first/last byte filter
+        AVX2 = 2,   // 32 byte first/last byte filter
+        NEON = 3    // 16 byte first/last byte filter
+    };
+
+    static constexpr std::size_t npos{std::string_view::npos};
+
+    explicit NeedleMatcher(std::string_view needle);
+    NeedleMatcher(std::string_view needle, Implementation implementation);
+
+    // Position of the first occurrence of the needle in text, or npos.
+    std::size_t find(std::string_view text) const
+    {
+        return m_find(m_needle, text);
+    }
+    bool matches(std::string_view text) const
+    {
+        return find(text) != npos;
+    }
+
+    const std::string &needle() const
+    {
+        return m_needle;
+    }
+    Implementation implementation() const
+    {
+        return m_implementation;
+    }
+
+    // The fastest implementation this CPU supports.
+    static Implementation best();
+    static bool supported(Implementation implementation);
+    static std::string_view name(Implementation implementation);
+
+private:
+    using FindFn = std::size_t (*)(std::string_view needle, std::string_view text);
+
+    std::string m_needle;
+    Implementation m_implementation;
+    FindFn m_find;
+};
+
+// The first row in [row, end) whose value contains the needle, or end if there is none.
+// Searches the column's blob as one contiguous text rather than row by row.
+std::size_t findRow(const StringColumn &column, const NeedleMatcher &matcher, std::size_t row, std::size_t end);
+
+inline std::size_t findRow(const StringColumn &column, const NeedleMatcher &matcher, std::size_t row)
+{
+    return findRow(column, matcher, row, column.size());
+}
+
+} // namespace comics
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace comics
+{
+
+// Substring search for many needles at once with an Aho-Corasick automaton, so each text
+// is read once however many needles there are.  Transitions are a full 256 entry table per
+// state, trading memory for a single lookup per byte.
+class MultiMatcher
+{
+public:
+    explicit MultiMatcher(std::span<const std::string_view> needles);
+
+    // Replace found with the ascending positions in the needles of those the text contains.
+    void find(std::string_view text, std::vector<std::uint32_t> &found) const;
+
+    std::size_t needles() const
+    {
+        return m_needles;
+    }
+    std::size_t states() const
+    {
+        return m_transitions.size() / ALPHABET;
+    }
+
+private:
+    static constexpr std::size_t ALPHABET{256};
+
+    std::size_t m_needles;
+    std::vector<std::uint32_t> m_transitions;
+    // needles ending at state s are m_outputs[m_outputBegin[s]] up to m_outputBegin[s + 1],
+    // including those ending at its suffixes
+    std::vector<std::uint32_t> m_outputBegin;
+    std::vector<std::uint32_t> m_outputs;
+};
+
+} // namespace comics
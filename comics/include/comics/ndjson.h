@@ -0,0 +1,63 @@
+#pragma once
+
+#include "comics/record-reader.h"
+#include "comics/table.h"
+
+#include <simdjson.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+namespace comics
+{
+
+// Reads a file of newline delimited JSON records through a fixed size window, so memory use
+// doesn't depend on the size of the file.  The window only grows if a single record is larger.
+// Records are parsed in place in the window, one line at a time, reusing one parser.
+class NDJSONReader : public RecordReader
+{
+public:
+    static constexpr std::size_t DEFAULT_WINDOW{std::size_t{4} << 20};
+
+    explicit NDJSONReader(const std::filesystem::path &path, std::size_t window = DEFAULT_WINDOW);
+
+    bool next(simdjson::dom::element &record) override;
+
+    // Bytes of the window, for checking that memory stays bounded.
+    std::size_t window() const
+    {
+        return m_buffer.size() - simdjson::SIMDJSON_PADDING;
+    }
+
+private:
+    bool fill();
+
+    std::filesystem::path m_path;
+    std::ifstream m_file;
+    std::vector<char> m_buffer;
+    std::size_t m_size{};     // bytes read into the buffer
+    std::size_t m_complete{}; // bytes of whole lines in the buffer
+    std::size_t m_pos{};      // start of the next line to parse
+    simdjson::dom::parser m_parser;
+};
+
+struct NDJSONPaths
+{
+    std::filesystem::path issues;
+    std::filesystem::path sequences;
+};
+
+// Locate the issues and sequences NDJSON files in a directory, if both are present and neither is
+// older than a .json file beside it with its stem.
+std::optional<NDJSONPaths> findNDJSONFiles(const std::filesystem::path &dir);
+
+// Read the ISSUE_COLUMNS of an issues NDJSON file into a table.
+void readIssueTable(const std::filesystem::path &path, TableWriter &table);
+
+// Read the ISSUE_COLUMNS of the issue records of a reader into a table.
+void readIssueTable(RecordReader &reader, TableWriter &table);
+
+} // namespace comics
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace comics
+{
+
+struct QueryStats;
+
+// Load time settings shared by both database implementations.
+struct DatabaseOptions
+{
+    // Build a trigram index of each credit field on its first substring query,
+    // so later queries of three or more bytes only verify candidate rows.
+    bool trigramIndex{false};
+    // Fold every credit field for case and accent insensitive queries at load, rather than each
+    // field on its first MatchMode::FOLDED query.
+    bool foldCredits{false};
+    // Split full scans of a credit field across this many threads; 1 scans serially.
+    unsigned threads{1};
+    // If set, phase timings and counters of loading and querying are added to it.
+    QueryStats *stats{nullptr};
+    // If not 0, JSON dumps are read in chunks instead of whole, keeping the memory used to read and
+    // parse them within this many bytes; the issue columns kept for joins come on top of it.
+    // Only the coroutine database reads in chunks.
+    std::size_t memoryBudget{0};
+    // If not 0, result sets of single name queries are kept in a QueryCache of this many bytes, so
+    // repeated queries skip the scan.  Databases that stream their sequences don't cache.
+    std::size_t cacheBytes{0};
+    // If set, the query cache is loaded from and saved to this file.
+    std::filesystem::path cachePath;
+};
+
+} // namespace comics
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "comics/table.h"
+
+#include <simdjson.h>
+
+#include <vector>
+
+namespace comics
+{
+
+// Copy the named keys of a JSON record into a new row of a table, so later scans read one
+// contiguous column instead of walking every key of every record.  Integer columns are parsed
+// from decimal strings and booleans are stored as "true" or "false", as gcd-to-json writes
+// snapshots; missing keys are absent.  Throws for values of any other type.
+void projectRecord(TableWriter &table, const std::vector<ColumnSpec> &columns, simdjson::dom::object record);
+
+// Project each record of a JSON array of objects.
+void projectRecords(TableWriter &table, const std::vector<ColumnSpec> &columns, simdjson::dom::element records);
+
+} // namespace comics
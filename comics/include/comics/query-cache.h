@@ -0,0 +1,108 @@
+#pragma once
+
+#include "comics/credit-index.h"
+#include "comics/options.h"
+#include "comics/query.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace comics
+{
+
+// Query cache file layout, all values in host byte order:
+//   QueryCacheHeader
+//   for each entry, most recently used first:
+//     QueryCacheEntry, the key, then the posting list's encoded rows
+constexpr char QUERY_CACHE_MAGIC[8]{'G', 'C', 'D', 'Q', 'C', 'A', 'C', '\0'};
+constexpr std::uint32_t QUERY_CACHE_VERSION{1};
+
+struct QueryCacheHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t fingerprint;
+    std::uint64_t entryCount;
+};
+
+struct QueryCacheEntry
+{
+    std::uint32_t keyLength;
+    std::uint32_t rowCount;
+    std::uint64_t byteCount;
+};
+
+// The key of a query's result set: the credit field's name in the sequences, the match mode and
+// the name as given.
+std::string queryKey(std::string_view field, MatchMode mode, std::string_view name);
+
+// Fingerprint of the files a database was loaded from, from their names, sizes and modification
+// times, so a cache saved for other or rewritten files isn't used.
+std::uint64_t fingerprintFiles(std::span<const std::filesystem::path> files);
+
+// Least recently used cache of query result sets, stored as posting lists of sequence table rows.
+// Entries are evicted once their keys and rows take more than the cache's size.  Given a path,
+// the cache is loaded from it if it was saved with the same fingerprint and saved back to it when
+// destroyed.  Safe to use from several threads.
+class QueryCache
+{
+public:
+    // Approximate bookkeeping per entry, counted against the size besides its key and rows.
+    static constexpr std::size_t ENTRY_OVERHEAD{128};
+
+    // Throws if the file exists but isn't a query cache, so another file isn't overwritten; a truncated
+    // or corrupt cache is dropped and replaced when saving.
+    QueryCache(std::size_t maxBytes, std::uint64_t fingerprint, std::filesystem::path path = {});
+    // Saves the cache if it changed, ignoring errors.
+    ~QueryCache();
+    QueryCache(const QueryCache &) = delete;
+    QueryCache &operator=(const QueryCache &) = delete;
+
+    // The rows stored for a key, or nullptr; the entry becomes the most recently used.
+    std::shared_ptr<const PostingList> find(std::string_view key);
+    // Store the rows of a key, replacing any already stored, unless they alone exceed the size.
+    void insert(std::string_view key, PostingList rows);
+
+    // Write the cache to its path if it has one and changed since it was loaded or last saved.
+    // The file is replaced whole, so a reader never sees a partial cache.  Throws on errors.
+    void save();
+
+    std::size_t entries() const;
+    std::size_t bytes() const;
+
+private:
+    struct Entry
+    {
+        std::string key;
+        std::shared_ptr<const PostingList> rows;
+        std::size_t bytes;
+    };
+
+    void load();
+    void insertLocked(std::string_view key, std::shared_ptr<const PostingList> rows);
+
+    mutable std::mutex m_mutex;
+    std::size_t m_maxBytes;
+    std::uint64_t m_fingerprint;
+    std::filesystem::path m_path;
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index;
+    std::size_t m_bytes{};
+    bool m_changed{};
+};
+
+// The cache the options ask for, fingerprinted with the files a database is loaded from, or
+// nullptr if DatabaseOptions::cacheBytes is 0.
+std::unique_ptr<QueryCache> openQueryCache(
+    const DatabaseOptions &options, const std::filesystem::path &issues, const std::filesystem::path &sequences);
+
+} // namespace comics
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "comics/coro.h"
+#include "comics/query.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace comics
+{
+namespace coroutine
+{
+
+// Line protocol of the resident query server: each request is one line of the form
+// "[-x|-f] (-s|-p|-i|-c|-l) <name>" and each response is the matches, printed as print-comics-coroutine
+// does, followed by a line holding only END_OF_RESPONSE.  A failed request is answered with
+// a single "error: " line before END_OF_RESPONSE.
+constexpr std::string_view END_OF_RESPONSE{"."};
+
+struct Query
+{
+    CreditField field{CreditField::NONE};
+    MatchMode mode{MatchMode::SUBSTRING};
+    std::string name;
+};
+
+// Parse a request line; throws std::runtime_error if it isn't a query.
+Query parseQuery(std::string_view line);
+
+// Answer one request line, writing each match as the scan finds it.
+void answerQuery(std::ostream &str, const DatabasePtr &database, std::string_view line);
+
+// Answer request lines until the input ends, the output fails or a "quit" line.
+void serveQueries(std::istream &in, std::ostream &out, const DatabasePtr &database);
+
+} // namespace coroutine
+} // namespace comics
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace comics
+{
+
+enum class MatchMode
+{
+    SUBSTRING = 0, // the credit contains the name anywhere
+    CREATOR = 1,   // a creator in the credit is the name, ignoring case and annotations
+    FOLDED = 2     // the credit contains the name anywhere, ignoring case and accents
+};
+
+enum class MatchOrder
+{
+    SCAN = 0,    // as the scan or index finds them
+    SEQUENCE = 1 // by issue and then sequence number
+};
+
+} // namespace comics
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <simdjson.h>
+
+namespace comics
+{
+
+// A pass over the records of a dump on disk that holds only some of them in memory at a time.
+class RecordReader
+{
+public:
+    virtual ~RecordReader() = default;
+
+    // Advance to the next record; returns false at the end of the file.
+    // The record stays valid until the next call.
+    virtual bool next(simdjson::dom::element &record) = 0;
+};
+
+} // namespace comics
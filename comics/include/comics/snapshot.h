@@ -0,0 +1,148 @@
+#pragma once
+
+#include "comics/table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace comics
+{
+
+// Size and modification time of a file, recorded by files derived from it to tell when it was
+// rewritten since.
+struct FileStamp
+{
+    std::uint64_t size;
+    std::int64_t modified;
+
+    bool operator==(const FileStamp &) const = default;
+};
+
+// Throws if the file doesn't exist.
+FileStamp stampFile(const std::filesystem::path &path);
+
+// Binary snapshot layout, all values in host byte order:
+//   SnapshotHeader
+//   SnapshotColumnHeader[columnCount]
+//   column data, each section 8 byte aligned:
+//     INT32:  int32_t[rowCount]
+//     STRING: uint64_t offsets[rowCount + 1], followed by the string blob
+constexpr char SNAPSHOT_MAGIC[8]{'G', 'C', 'D', 'S', 'N', 'A', 'P', '\0'};
+constexpr std::uint32_t SNAPSHOT_VERSION{2};
+constexpr std::uint32_t SNAPSHOT_BYTE_ORDER{0x01020304};
+
+struct SnapshotHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t rowCount;
+    std::uint32_t columnCount;
+    std::uint32_t reserved;
+    FileStamp source; // of the JSON converted with the snapshot, or zero if there is none
+};
+
+struct SnapshotColumnHeader
+{
+    char name[32];
+    ColumnType type;
+    std::uint32_t reserved;
+    std::uint64_t dataOffset;
+    std::uint64_t blobOffset;
+    std::uint64_t blobSize;
+};
+
+// Columns stored in issue and sequence snapshots.
+extern const std::vector<ColumnSpec> ISSUE_COLUMNS;
+extern const std::vector<ColumnSpec> SEQUENCE_COLUMNS;
+
+// The ISSUE_COLUMNS of a table, resolved by name once.
+struct IssueColumns
+{
+    explicit IssueColumns(const Table &table);
+
+    IntColumn id;
+    StringColumn seriesName;
+    StringColumn issueNumber;
+};
+
+// The SEQUENCE_COLUMNS of a table, resolved by name once.
+struct SequenceColumns
+{
+    explicit SequenceColumns(const Table &table);
+
+    // Column for a credit key such as "script", or nullptr if the key isn't a credit.
+    const StringColumn *credit(std::string_view key) const;
+
+    IntColumn issue;
+    IntColumn sequenceNumber;
+    StringColumn title;
+    StringColumn feature;
+    StringColumn script;
+    StringColumn pencils;
+    StringColumn inks;
+    StringColumn colors;
+    StringColumn letters;
+};
+
+// Read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const
+    {
+        return m_data;
+    }
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    const char *m_data{};
+    std::size_t m_size{};
+#ifdef _WIN32
+    void *m_file{};
+    void *m_mapping{};
+#endif
+};
+
+// A snapshot file mapped read-only; the table views point directly into the mapping.
+class Snapshot
+{
+public:
+    explicit Snapshot(const std::filesystem::path &path);
+
+    const Table &table() const
+    {
+        return m_table;
+    }
+
+private:
+    MappedFile m_file;
+    Table m_table;
+};
+
+// Write a table as a snapshot of the JSON file source, if given, so it isn't used once the JSON
+// has been rewritten.
+void writeSnapshot(const std::filesystem::path &path, const Table &table, const std::filesystem::path &source = {});
+
+struct SnapshotPaths
+{
+    std::filesystem::path issues;
+    std::filesystem::path sequences;
+};
+
+// Locate the issues and sequences snapshots in a directory, if both are present and current: a
+// snapshot is stale if the .json or .ndjson files beside it with its stem have all been rewritten
+// since it was written, or if it has another version.
+std::optional<SnapshotPaths> findSnapshots(const std::filesystem::path &dir);
+
+} // namespace comics
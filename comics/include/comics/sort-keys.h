@@ -0,0 +1,38 @@
+#pragma once
+
+#include <simdjson.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace comics
+{
+
+// A sequence's issue and sequence number packed into one integer, so ordering keys orders
+// sequences by issue and then by their position in the issue.  Both parts must be non-negative,
+// as GCD ids and sequence numbers are.
+using SequenceKey = std::uint64_t;
+
+inline SequenceKey sequenceKey(std::int32_t issue, std::int32_t sequenceNumber)
+{
+    return static_cast<SequenceKey>(static_cast<std::uint32_t>(issue)) << 32 | static_cast<std::uint32_t>(sequenceNumber);
+}
+
+inline std::int32_t keyIssue(SequenceKey key)
+{
+    return static_cast<std::int32_t>(key >> 32);
+}
+
+// The key of a sequence record from its "issue" and "sequence_number" keys.
+SequenceKey sequenceKey(simdjson::dom::object sequence);
+
+struct KeyedRow
+{
+    SequenceKey key;
+    std::uint32_t row;
+};
+
+// Sort rows by key with a least significant digit radix sort; rows with equal keys stay in order.
+void sortKeyedRows(std::vector<KeyedRow> &rows);
+
+} // namespace comics
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "comics/trace.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace comics
+{
+
+// Where a run of a query program spends its time.
+enum class Phase
+{
+    READ,    // reading files
+    PARSE,   // parsing JSON
+    PROJECT, // copying the queried fields into columns
+    INDEX,   // building issue, credit and trigram indexes
+    SCAN,    // finding matching sequences
+    JOIN,    // looking up the issue of each match
+    SORT,    // ordering matches by issue and sequence number
+    OUTPUT,  // formatting and writing matches
+};
+
+constexpr std::size_t PHASE_COUNT{static_cast<std::size_t>(Phase::OUTPUT) + 1};
+
+std::string_view to_string(Phase phase);
+
+// Timings and counters of one run, collected when DatabaseOptions::stats is set.  Everything is
+// atomic so that loads and scans running on several threads can add to it; the time of a phase is
+// summed over the threads doing it.
+struct QueryStats
+{
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+    std::array<std::atomic<std::int64_t>, PHASE_COUNT> nanoseconds{};
+    std::atomic<std::uint64_t> bytesRead{};
+    std::atomic<std::uint64_t> recordsScanned{};
+    std::atomic<std::uint64_t> matches{};
+    std::atomic<std::uint64_t> joinLookups{};
+    std::atomic<std::uint64_t> outputBytes{};
+    std::atomic<std::uint64_t> cacheHits{};
+};
+
+inline void addCount(QueryStats *stats, std::atomic<std::uint64_t> QueryStats::*counter, std::uint64_t count)
+{
+    if (stats != nullptr)
+    {
+        (stats->*counter).fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+// Adds the time from construction to destruction to a phase, or nothing without stats.  Phases are
+// exclusive: a timer started while another is running on the same thread takes its time out of
+// the outer one, so a join timed inside a scan isn't counted twice.  A timer must not span a
+// co_yield, as the coroutine may resume on another thread.  When tracing, the time is also
+// recorded as a span named after the phase.
+class PhaseTimer
+{
+public:
+    PhaseTimer(QueryStats *stats, Phase phase);
+    ~PhaseTimer();
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+    QueryStats *m_stats;
+    TraceSpan m_span;
+    Phase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::nanoseconds m_nested{};
+    PhaseTimer *m_outer{};
+};
+
+// The most memory the process has had resident at once, in bytes, or 0 if it isn't known.
+std::uint64_t peakResidentBytes();
+
+// A summary for people, one phase or counter per line, ending with the peak resident memory.
+void printStats(std::ostream &str, const QueryStats &stats);
+
+// The same as one JSON object, for scripts collecting metrics.
+void printStatsJSON(std::ostream &str, const QueryStats &stats);
+
+} // namespace comics
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace comics
+{
+
+enum class ColumnType : std::uint32_t
+{
+    INT32 = 0,
+    STRING = 1
+};
+
+struct ColumnSpec
+{
+    std::string_view name;
+    ColumnType type;
+};
+
+// Non-owning view of a column of fixed-width integers.
+class IntColumn
+{
+public:
+    IntColumn() = default;
+    IntColumn(const std::int32_t *data, std::size_t size) :
+        m_data(data),
+        m_size(size)
+    {
+    }
+
+    int operator[](std::size_t row) const
+    {
+        return m_data[row];
+    }
+    std::size_t size() const
+    {
+        return m_size;
+    }
+    const std::int32_t *data() const
+    {
+        return m_data;
+    }
+
+private:
+    const std::int32_t *m_data{};
+    std::size_t m_size{};
+};
+
+// Non-owning view of a column of strings, stored as size() + 1 offsets into a blob.
+// Row i spans [offsets[i], offsets[i + 1]); ABSENT set on the end offset marks a missing value.
+class StringColumn
+{
+public:
+    static constexpr std::uint64_t ABSENT{1ULL << 63};
+
+    StringColumn() = default;
+    StringColumn(const std::uint64_t *offsets, const char *blob, std::size_t size) :
+        m_offsets(offsets),
+        m_blob(blob),
+        m_size(size)
+    {
+    }
+
+    // Returns a view with a null data() when the value is absent.
+    std::string_view operator[](std::size_t row) const
+    {
+        const std::uint64_t end{m_offsets[row + 1]};
+        if (end & ABSENT)
+        {
+            return {};
+        }
+        const std::uint64_t begin{m_offsets[row] & ~ABSENT};
+        return {m_blob + begin, static_cast<std::size_t>(end - begin)};
+    }
+    bool present(std::size_t row) const
+    {
+        return (m_offsets[row + 1] & ABSENT) == 0;
+    }
+    std::size_t size() const
+    {
+        return m_size;
+    }
+    const std::uint64_t *offsets() const
+    {
+        return m_offsets;
+    }
+    const char *blob() const
+    {
+        return m_blob;
+    }
+    std::size_t blobSize() const
+    {
+        return m_size == 0 ? 0 : static_cast<std::size_t>(m_offsets[m_size] & ~ABSENT);
+    }
+
+private:
+    const std::uint64_t *m_offsets{};
+    const char *m_blob{};
+    std::size_t m_size{};
+};
+
+// Non-owning view of a set of named, equal length columns.
+class Table
+{
+public:
+    struct Column
+    {
+        std::string name;
+        ColumnType type;
+        IntColumn ints;
+        StringColumn strings;
+    };
+
+    Table() = default;
+    explicit Table(std::size_t rows) :
+        m_rows(rows)
+    {
+    }
+
+    void addColumn(std::string_view name, IntColumn column);
+    void addColumn(std::string_view name, StringColumn column);
+
+    std::size_t rows() const
+    {
+        return m_rows;
+    }
+    const std::vector<Column> &columns() const
+    {
+        return m_columns;
+    }
+    bool hasColumn(std::string_view name) const;
+
+    // These throw if there is no column of that name and type.
+    const IntColumn &intColumn(std::string_view name) const;
+    const StringColumn &stringColumn(std::string_view name) const;
+
+private:
+    const Column &column(std::string_view name, ColumnType type) const;
+
+    std::size_t m_rows{};
+    std::vector<Column> m_columns;
+};
+
+// Accumulates rows in memory; values not set before endRow() are 0 or absent.
+class TableWriter
+{
+public:
+    explicit TableWriter(std::vector<ColumnSpec> columns);
+
+    void set(std::size_t column, int value);
+    void set(std::size_t column, std::string_view value);
+    void endRow();
+    // Append the rows of a writer with the same columns.
+    void append(const TableWriter &rows);
+    // Append a row of a table whose columns are those of the writer, in the same order.
+    void appendRow(const Table &table, std::size_t row);
+
+    std::size_t rows() const
+    {
+        return m_rows;
+    }
+
+    // The view is invalidated by further writes.
+    Table table() const;
+
+private:
+    std::vector<ColumnSpec> m_specs;
+    std::vector<std::vector<std::int32_t>> m_ints;
+    std::vector<std::vector<std::uint64_t>> m_offsets;
+    std::vector<std::string> m_blobs;
+    std::vector<bool> m_set;
+    std::size_t m_rows{};
+};
+
+} // namespace comics
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "comics/trace.h"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+namespace comics
+{
+
+// Fixed set of worker threads that split a range of rows between them.
+class ThreadPool
+{
+public:
+    // threads counts the calling thread, which runs the first part of every range itself.
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned threads() const
+    {
+        return static_cast<unsigned>(m_workers.size()) + 1;
+    }
+
+    // Number of parts parallelFor splits count rows into.
+    std::size_t parts(std::size_t count) const;
+
+    // Call fn(part, begin, end) for contiguous ascending ranges covering [0, count) and wait
+    // for all of them.  If any part throws, the exception of the lowest part is rethrown.
+    void parallelFor(
+        std::size_t count, const std::function<void(std::size_t part, std::size_t begin, std::size_t end)> &fn);
+
+private:
+    void work();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::deque<std::function<void()>> m_tasks;
+    // released once per queued task, and once per worker when stopping
+    std::counting_semaphore<> m_ready{0};
+};
+
+// Run scan(begin, end, matches) over the parts of [0, count) and concatenate the matches in part
+// order, so the result is the same as a serial scan of the whole range.
+template <typename Match, typename Scan>
+std::vector<Match> parallelCollect(ThreadPool &pool, std::size_t count, Scan scan)
+{
+    std::vector<std::vector<Match>> parts(pool.parts(count));
+    pool.parallelFor(count,
+        [&](std::size_t part, std::size_t begin, std::size_t end)
+        {
+            TraceSpan span{"scan part"};
+            span.setValue(static_cast<std::int64_t>(end - begin));
+            scan(begin, end, parts[part]);
+        });
+    std::vector<Match> result;
+    for (std::vector<Match> &part : parts)
+    {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+} // namespace comics
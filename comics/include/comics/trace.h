@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace comics
+{
+
+// Records spans of work on each thread for viewing as a timeline in Perfetto or chrome://tracing.
+// Each thread writes to its own ring buffer without locking, keeping its most recent events once
+// the buffer is full.  Tracing is off until a recorder is made active; then spans are recorded
+// from every thread until it is made inactive again.
+class TraceRecorder
+{
+public:
+    static constexpr std::size_t DEFAULT_EVENTS_PER_THREAD{std::size_t{1} << 16};
+
+    explicit TraceRecorder(std::size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+    ~TraceRecorder();
+    TraceRecorder(const TraceRecorder &) = delete;
+    TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+    // The recorder spans are added to, or nullptr when tracing is off.
+    static TraceRecorder *active()
+    {
+        return s_active.load(std::memory_order_acquire);
+    }
+    // Make a recorder active, or turn tracing off with nullptr.  Recording must have stopped on
+    // every thread before the active recorder is destroyed.
+    static void setActive(TraceRecorder *recorder);
+
+    // Name must be a string literal or otherwise outlive the recorder.  A negative duration marks
+    // an instant; a negative value is left out of the event.
+    void record(const char *name, std::int64_t startNanoseconds, std::int64_t durationNanoseconds,
+        std::int64_t value = -1);
+
+    // Nanoseconds since the recorder was created.
+    std::int64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start)
+            .count();
+    }
+
+    // Events lost because a thread's buffer wrapped around.
+    std::uint64_t dropped() const;
+
+    // Write the events as a Chrome trace event JSON object.  Call once the traced work is done.
+    void writeChromeTrace(std::ostream &str) const;
+
+private:
+    struct Event
+    {
+        const char *name;
+        std::int64_t start;
+        std::int64_t duration;
+        std::int64_t value;
+    };
+    struct ThreadBuffer
+    {
+        std::vector<Event> events;
+        std::uint64_t written{};
+        std::uint32_t tid{};
+    };
+
+    ThreadBuffer &threadBuffer();
+
+    static std::atomic<TraceRecorder *> s_active;
+
+    const std::uint64_t m_id;
+    const std::size_t m_eventsPerThread;
+    const std::chrono::steady_clock::time_point m_start{std::chrono::steady_clock::now()};
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+};
+
+// Records the time from construction to destruction as a span of the active recorder, if any.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name) :
+        m_recorder(TraceRecorder::active()),
+        m_name(name)
+    {
+        if (m_recorder != nullptr)
+        {
+            m_start = m_recorder->now();
+        }
+    }
+    ~TraceSpan()
+    {
+        if (m_recorder != nullptr)
+        {
+            m_recorder->record(m_name, m_start, m_recorder->now() - m_start, m_value);
+        }
+    }
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    // A count shown with the span, such as the rows it covered.
+    void setValue(std::int64_t value)
+    {
+        m_value = value;
+    }
+
+private:
+    TraceRecorder *m_recorder;
+    const char *m_name;
+    std::int64_t m_start{};
+    std::int64_t m_value{-1};
+};
+
+// Record a point in time, such as a coroutine suspending, on the active recorder, if any.
+inline void traceInstant(const char *name, std::int64_t value = -1)
+{
+    if (TraceRecorder *recorder = TraceRecorder::active())
+    {
+        recorder->record(name, recorder->now(), -1, value);
+    }
+}
+
+} // namespace comics
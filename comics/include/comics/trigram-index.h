@@ -0,0 +1,41 @@
+#pragma once
+
+#include "comics/credit-index.h"
+#include "comics/table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace comics
+{
+
+// Maps each three byte sequence of a credit field to the rows containing it,
+// so substring queries only verify rows containing all of the needle's trigrams.
+class TrigramIndex
+{
+public:
+    static constexpr std::size_t MIN_NEEDLE{3};
+
+    // Rows must be added in ascending order.
+    void add(std::uint32_t row, std::string_view text);
+
+    // Ascending rows that may contain the needle, which must be at least MIN_NEEDLE bytes;
+    // every row that does contain it is included.
+    std::vector<std::uint32_t> candidates(std::string_view needle) const;
+
+    std::size_t trigrams() const
+    {
+        return m_postings.size();
+    }
+
+private:
+    std::unordered_map<std::uint32_t, PostingList> m_postings;
+};
+
+// Index a credit column of a sequence table; rows are table rows.
+TrigramIndex buildTrigramIndex(const StringColumn &column);
+
+} // namespace comics
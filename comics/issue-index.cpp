@@ -0,0 +1,31 @@
+#include "comics/issue-index.h"
+
+#include <charconv>
+#include <stdexcept>
+#include <string>
+
+namespace comics
+{
+
+int parseId(std::string_view text)
+{
+    int id{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), id);
+    if (error != std::errc{} || end != text.data() + text.size())
+    {
+        throw std::runtime_error("Invalid record id '" + std::string{text} + "'");
+    }
+    return id;
+}
+
+IssueRowIndex buildIssueRowIndex(const IntColumn &ids)
+{
+    IssueRowIndex index(ids.size());
+    for (std::size_t row = 0; row < ids.size(); ++row)
+    {
+        index.insert(ids[row], row);
+    }
+    return index;
+}
+
+} // namespace comics
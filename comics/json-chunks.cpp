@@ -0,0 +1,182 @@
+#include "comics/json-chunks.h"
+
+#include "comics/trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace comics
+{
+
+namespace
+{
+
+// Bytes of memory for each byte of window: the window itself, and the tape, string buffer and
+// structural indexes the parser allocates for a document of that size, with some to spare.
+constexpr std::size_t BYTES_PER_WINDOW_BYTE{16};
+
+constexpr std::size_t MIN_WINDOW{4096};
+
+} // namespace
+
+JSONArrayReader::JSONArrayReader(const std::filesystem::path &path, std::size_t window) :
+    m_path(path),
+    m_file(path, std::ios::binary),
+    m_buffer(std::max<std::size_t>(window, 2) + simdjson::SIMDJSON_PADDING)
+{
+    if (!m_file)
+    {
+        throw std::runtime_error("Couldn't open " + path.string());
+    }
+    char c{};
+    while (m_file.get(c) && (c == ' ' || c == '\t' || c == '\r' || c == '\n'))
+    {
+    }
+    if (!m_file || c != '[')
+    {
+        throw std::runtime_error("JSON file should be an array of records: " + path.string());
+    }
+    m_buffer[0] = '[';
+}
+
+void JSONArrayReader::scan()
+{
+    for (; m_scanned < m_size && m_end == 0; ++m_scanned)
+    {
+        const char c{m_buffer[m_scanned]};
+        if (m_inString)
+        {
+            if (m_escaped)
+            {
+                m_escaped = false;
+            }
+            else if (c == '\\')
+            {
+                m_escaped = true;
+            }
+            else if (c == '"')
+            {
+                m_inString = false;
+            }
+            continue;
+        }
+        switch (c)
+        {
+        case '"':
+            m_inString = true;
+            break;
+        case '{':
+        case '[':
+            ++m_depth;
+            break;
+        case '}':
+            // malformed text is left for the parser to report
+            m_depth -= m_depth > 0 ? 1 : 0;
+            break;
+        case ']':
+            if (m_depth == 0)
+            {
+                m_end = m_scanned + 1;
+            }
+            else
+            {
+                --m_depth;
+            }
+            break;
+        case ',':
+            if (m_depth == 0)
+            {
+                m_cut = m_scanned;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+bool JSONArrayReader::fill()
+{
+    if (m_finished)
+    {
+        return false;
+    }
+    TraceSpan span{"read chunk"};
+    if (m_cut != 0)
+    {
+        // keep the text after the cut, which has been scanned already, for the next chunk
+        const std::size_t rest{m_cut + 1};
+        std::memmove(m_buffer.data() + 1, m_buffer.data() + rest, m_size - rest);
+        m_size -= m_cut;
+        m_scanned -= m_cut;
+        m_end -= m_end != 0 ? m_cut : 0;
+        m_cut = 0;
+    }
+    std::size_t chunk{};
+    for (;;)
+    {
+        if (m_end == 0)
+        {
+            m_file.read(m_buffer.data() + m_size, static_cast<std::streamsize>(window() - m_size));
+            m_size += static_cast<std::size_t>(m_file.gcount());
+            scan();
+        }
+        if (m_end != 0)
+        {
+            chunk = m_end;
+            m_finished = true;
+            break;
+        }
+        if (m_cut != 0)
+        {
+            // the comma after the last whole record closes the chunk's array
+            m_buffer[m_cut] = ']';
+            chunk = m_cut + 1;
+            break;
+        }
+        if (!m_file)
+        {
+            throw std::runtime_error("Unexpected end of JSON array in " + m_path.string());
+        }
+        // a single record is larger than the window
+        m_buffer.resize(window() * 2 + simdjson::SIMDJSON_PADDING);
+    }
+    span.setValue(static_cast<std::int64_t>(chunk));
+
+    // the window always has SIMDJSON_PADDING bytes after its end, so no copy is needed
+    simdjson::dom::array records;
+    if (const simdjson::error_code error = m_parser.parse(m_buffer.data(), chunk, false).get_array().get(records))
+    {
+        throw std::runtime_error(
+            "Couldn't parse records in " + m_path.string() + ": " + simdjson::error_message(error));
+    }
+    m_record = records.begin();
+    m_chunkEnd = records.end();
+    return true;
+}
+
+bool JSONArrayReader::next(simdjson::dom::element &record)
+{
+    for (;;)
+    {
+        if (m_record != m_chunkEnd)
+        {
+            record = *m_record;
+            ++m_record;
+            return true;
+        }
+        if (!fill())
+        {
+            return false;
+        }
+    }
+}
+
+std::size_t chunkWindow(std::size_t memoryBudget)
+{
+    return std::max(memoryBudget / BYTES_PER_WINDOW_BYTE, MIN_WINDOW);
+}
+
+} // namespace comics
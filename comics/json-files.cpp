@@ -0,0 +1,117 @@
+#include "comics/json-files.h"
+
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace comics
+{
+
+namespace
+{
+
+bool endsWith(const std::string &text, const std::string &suffix)
+{
+    return text.length() >= suffix.length() && text.substr(text.length() - suffix.length()) == suffix;
+}
+
+simdjson::simdjson_result<simdjson::dom::element> load(
+    simdjson::dom::parser &parser, const std::filesystem::path &path, QueryStats *stats)
+{
+    // the parser copies the strings it needs into its document, so the text is freed after parsing
+    simdjson::padded_string json;
+    {
+        const PhaseTimer timer{stats, Phase::READ};
+        if (const simdjson::error_code error = simdjson::padded_string::load(path.string()).get(json))
+        {
+            return error;
+        }
+    }
+    addCount(stats, &QueryStats::bytesRead, json.size());
+    const PhaseTimer timer{stats, Phase::PARSE};
+    return parser.parse(json);
+}
+
+} // namespace
+
+JSONPaths findJSONFiles(const std::filesystem::path &jsonDir)
+{
+    std::filesystem::path issuesPath;
+    std::filesystem::path sequencesPath;
+    bool issuesFirst{false};
+    for (const auto &entry : std::filesystem::directory_iterator(jsonDir))
+    {
+        if (!entry.is_regular_file())
+        {
+            continue;
+        }
+        const std::filesystem::path &path{entry.path()};
+        const std::string filename{path.filename().string()};
+        if (endsWith(filename, "issues.json"))
+        {
+            issuesFirst = issuesFirst || sequencesPath.empty();
+            issuesPath = path;
+        }
+        else if (endsWith(filename, "sequences.json"))
+        {
+            sequencesPath = path;
+        }
+    }
+    if (issuesPath.empty() || sequencesPath.empty())
+    {
+        if (!issuesPath.empty())
+        {
+            throw std::runtime_error("Couldn't find sequences JSON file in " + jsonDir.string());
+        }
+        if (!sequencesPath.empty())
+        {
+            throw std::runtime_error("Couldn't find issues JSON file in " + jsonDir.string());
+        }
+        throw std::runtime_error("Couldn't find either issues or sequences JSON file in " + jsonDir.string());
+    }
+    return {issuesPath, sequencesPath, issuesFirst};
+}
+
+void loadJSONFiles(const JSONPaths &paths, simdjson::dom::parser &issueParser,
+    simdjson::simdjson_result<simdjson::dom::element> &issues, simdjson::dom::parser &sequenceParser,
+    simdjson::simdjson_result<simdjson::dom::element> &sequences, QueryStats *stats)
+{
+    // The parsers are independent, so the issues load on another thread while this one
+    // loads the sequences, overlapping the I/O of each file with parsing of the other.
+    std::cout << (paths.issuesFirst ? "Reading issues...\n" : "Reading sequences...\n") << std::flush;
+    std::future<simdjson::simdjson_result<simdjson::dom::element>> issuesLoaded{
+        std::async(std::launch::async, [&] { return load(issueParser, paths.issues, stats); })};
+    sequences = load(sequenceParser, paths.sequences, stats);
+    issues = issuesLoaded.get();
+
+    const auto checkIssues = [&]
+    {
+        if (!issues.is_array())
+        {
+            throw std::runtime_error("JSON issues file should be an array of objects");
+        }
+    };
+    const auto checkSequences = [&]
+    {
+        if (!sequences.is_array())
+        {
+            throw std::runtime_error("JSON sequences file should be an array of objects");
+        }
+    };
+    std::cout << "done.\n";
+    if (paths.issuesFirst)
+    {
+        checkIssues();
+        std::cout << "Reading sequences...\ndone.\n";
+        checkSequences();
+    }
+    else
+    {
+        checkSequences();
+        std::cout << "Reading issues...\ndone.\n";
+        checkIssues();
+    }
+}
+
+} // namespace comics
@@ -0,0 +1,103 @@
+#include "comics/match-printer.h"
+
+#include <string>
+
+namespace comics
+{
+namespace coroutine
+{
+
+MatchPrinter::MatchPrinter(const Database &database) :
+    m_stats(database.getStats())
+{
+    if (const Table *issues = database.getIssueTable())
+    {
+        m_issues.emplace(*issues);
+    }
+    if (const Table *sequences = database.getSequenceTable())
+    {
+        m_sequences.emplace(*sequences);
+    }
+}
+
+void MatchPrinter::print(OutputBuffer &out, const SequenceMatch &match, std::span<const std::string_view> names)
+{
+    std::string_view seriesName;
+    std::string_view issueNumber;
+    if (match.issueRow != NO_ROW)
+    {
+        seriesName = m_issues->seriesName[match.issueRow];
+        issueNumber = m_issues->issueNumber[match.issueRow];
+    }
+    else
+    {
+        seriesName = match.issue.at_key("series name").get_string().value();
+        issueNumber = match.issue.at_key("issue number").get_string().value();
+    }
+    if (!isLastTitle(seriesName, issueNumber))
+    {
+        out << seriesName << " #" << issueNumber << '\n';
+        // assigning in pieces reuses the string's storage from one issue to the next
+        m_lastTitle.assign(seriesName).append(" #").append(issueNumber);
+    }
+    if (match.sequenceRow != NO_ROW)
+    {
+        formatSequence(out, *m_sequences, match.sequenceRow);
+    }
+    else
+    {
+        formatSequence(out, match.sequence);
+    }
+    if (!match.names.empty())
+    {
+        out << "           matched: ";
+        bool first{true};
+        for (const std::uint32_t name : match.names)
+        {
+            out << (first ? "" : "; ") << names[name];
+            first = false;
+        }
+        out << '\n';
+    }
+}
+
+bool MatchPrinter::isLastTitle(std::string_view seriesName, std::string_view issueNumber) const
+{
+    const std::string_view last{m_lastTitle};
+    return last.size() == seriesName.size() + 2 + issueNumber.size() && last.starts_with(seriesName) &&
+        last.substr(seriesName.size(), 2) == " #" && last.ends_with(issueNumber);
+}
+
+std::size_t MatchPrinter::printAll(
+    std::ostream &str, MatchGenerator &coro, std::span<const std::string_view> names, std::size_t batch)
+{
+    OutputBuffer out{str};
+    std::size_t count{};
+    // the scan runs while the generator resumes, so resuming is timed as the scan
+    const auto resume = [&]
+    {
+        const PhaseTimer timer{m_stats, Phase::SCAN};
+        return coro.resumeBatch(batch);
+    };
+    for (std::span<const SequenceMatch> matches = resume(); !matches.empty(); matches = resume())
+    {
+        const PhaseTimer timer{m_stats, Phase::OUTPUT};
+        for (const SequenceMatch &match : matches)
+        {
+            if (count != 0)
+            {
+                out << '\n';
+            }
+            print(out, match, names);
+            ++count;
+        }
+    }
+    const PhaseTimer timer{m_stats, Phase::OUTPUT};
+    out.flush();
+    addCount(m_stats, &QueryStats::matches, count);
+    addCount(m_stats, &QueryStats::outputBytes, out.written());
+    return count;
+}
+
+} // namespace coroutine
+} // namespace comics
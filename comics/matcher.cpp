@@ -0,0 +1,298 @@
+#include "comics/matcher.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define COMICS_MATCHER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define COMICS_MATCHER_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define COMICS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define COMICS_TARGET_AVX2
+#endif
+
+namespace comics
+{
+
+namespace
+{
+
+// Most credits are shorter than a couple of SIMD blocks, where setting up the block loop costs
+// more than it saves; those and single byte needles are left to the library search, which
+// already scans for the first byte with a vectorized memchr.
+std::size_t findScalar(std::string_view needle, std::string_view text)
+{
+    return text.find(needle);
+}
+
+// Check a candidate whose first and last bytes already match.
+bool middleMatches(std::string_view needle, const char *candidate)
+{
+    return needle.size() <= 2 || std::memcmp(candidate + 1, needle.data() + 1, needle.size() - 2) == 0;
+}
+
+// The SIMD routines compare a block of text against the needle's first byte and the block
+// needle.size() - 1 bytes later against its last byte; only positions where both agree are
+// compared in full.  The remainder after the last whole block is handed to the scalar search.
+#ifdef COMICS_MATCHER_X86
+std::size_t findSse2(std::string_view needle, std::string_view text)
+{
+    const std::size_t n{needle.size()};
+    if (n < 2 || text.size() < n + 2 * 16)
+    {
+        return findScalar(needle, text);
+    }
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    std::size_t pos{};
+    for (; pos + n - 1 + 16 <= text.size(); pos += 16)
+    {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + pos));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + pos + n - 1));
+        auto mask = static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+        while (mask != 0)
+        {
+            const std::size_t hit{pos + std::countr_zero(mask)};
+            if (middleMatches(needle, text.data() + hit))
+            {
+                return hit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return text.find(needle, pos);
+}
+
+COMICS_TARGET_AVX2 std::size_t findAvx2(std::string_view needle, std::string_view text)
+{
+    const std::size_t n{needle.size()};
+    if (n < 2 || text.size() < n + 2 * 32)
+    {
+        return findScalar(needle, text);
+    }
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[n - 1]);
+    std::size_t pos{};
+    for (; pos + n - 1 + 32 <= text.size(); pos += 32)
+    {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text.data() + pos));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text.data() + pos + n - 1));
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast))));
+        while (mask != 0)
+        {
+            const std::size_t hit{pos + std::countr_zero(mask)};
+            if (middleMatches(needle, text.data() + hit))
+            {
+                return hit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    // finish with 16 byte blocks before falling back to the scalar search
+    const std::size_t rest{findSse2(needle, text.substr(pos))};
+    return rest == NeedleMatcher::npos ? rest : pos + rest;
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4]{};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave{(info[2] & (1 << 27)) != 0};
+    const bool avx{(info[2] & (1 << 28)) != 0};
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef COMICS_MATCHER_NEON
+std::size_t findNeon(std::string_view needle, std::string_view text)
+{
+    const std::size_t n{needle.size()};
+    if (n < 2 || text.size() < n + 2 * 16)
+    {
+        return findScalar(needle, text);
+    }
+    const uint8x16_t first = vdupq_n_u8(static_cast<std::uint8_t>(needle[0]));
+    const uint8x16_t last = vdupq_n_u8(static_cast<std::uint8_t>(needle[n - 1]));
+    std::size_t pos{};
+    for (; pos + n - 1 + 16 <= text.size(); pos += 16)
+    {
+        const uint8x16_t blockFirst = vld1q_u8(reinterpret_cast<const std::uint8_t *>(text.data() + pos));
+        const uint8x16_t blockLast = vld1q_u8(reinterpret_cast<const std::uint8_t *>(text.data() + pos + n - 1));
+        const uint8x16_t eq = vandq_u8(vceqq_u8(first, blockFirst), vceqq_u8(last, blockLast));
+        // narrow each byte of the comparison to a nibble of a 64 bit mask
+        std::uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask != 0)
+        {
+            const std::size_t hit{pos + std::countr_zero(mask) / 4};
+            if (middleMatches(needle, text.data() + hit))
+            {
+                return hit;
+            }
+            mask &= ~(std::uint64_t{0xF} << (std::countr_zero(mask) & ~3));
+        }
+    }
+    return text.find(needle, pos);
+}
+#endif
+
+} // namespace
+
+NeedleMatcher::NeedleMatcher(std::string_view needle) :
+    NeedleMatcher(needle, best())
+{
+}
+
+NeedleMatcher::NeedleMatcher(std::string_view needle, Implementation implementation) :
+    m_needle(needle),
+    m_implementation(implementation),
+    m_find(findScalar)
+{
+    if (!supported(implementation))
+    {
+        throw std::runtime_error("Matcher implementation " + std::string{name(implementation)} + " is not supported");
+    }
+    switch (implementation)
+    {
+    case Implementation::SCALAR:
+        break;
+#ifdef COMICS_MATCHER_X86
+    case Implementation::SSE2:
+        m_find = findSse2;
+        break;
+    case Implementation::AVX2:
+        m_find = findAvx2;
+        break;
+#endif
+#ifdef COMICS_MATCHER_NEON
+    case Implementation::NEON:
+        m_find = findNeon;
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
+NeedleMatcher::Implementation NeedleMatcher::best()
+{
+    static const Implementation implementation = []
+    {
+        for (const Implementation candidate : {Implementation::AVX2, Implementation::NEON, Implementation::SSE2})
+        {
+            if (supported(candidate))
+            {
+                return candidate;
+            }
+        }
+        return Implementation::SCALAR;
+    }();
+    return implementation;
+}
+
+bool NeedleMatcher::supported(Implementation implementation)
+{
+    switch (implementation)
+    {
+    case Implementation::SCALAR:
+        return true;
+#ifdef COMICS_MATCHER_X86
+    case Implementation::SSE2:
+        return true;
+    case Implementation::AVX2:
+    {
+        static const bool avx2{cpuHasAvx2()};
+        return avx2;
+    }
+#endif
+#ifdef COMICS_MATCHER_NEON
+    case Implementation::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+std::string_view NeedleMatcher::name(Implementation implementation)
+{
+    switch (implementation)
+    {
+    case Implementation::SCALAR:
+        return "scalar";
+    case Implementation::SSE2:
+        return "sse2";
+    case Implementation::AVX2:
+        return "avx2";
+    case Implementation::NEON:
+        return "neon";
+    }
+    return "?";
+}
+
+std::size_t findRow(const StringColumn &column, const NeedleMatcher &matcher, std::size_t row, std::size_t end)
+{
+    const std::uint64_t *offsets = column.offsets();
+    const auto begin = [=](std::size_t i) { return static_cast<std::size_t>(offsets[i] & ~StringColumn::ABSENT); };
+    const std::size_t length{matcher.needle().size()};
+    if (length == 0)
+    {
+        while (row < end && !column.present(row))
+        {
+            ++row;
+        }
+        return row;
+    }
+
+    const std::string_view blob{column.blob(), row < end ? begin(end) : 0};
+    std::size_t pos{row < end ? begin(row) : blob.size()};
+    while (pos < blob.size())
+    {
+        const std::size_t found{matcher.find(blob.substr(pos))};
+        if (found == NeedleMatcher::npos)
+        {
+            break;
+        }
+        const std::size_t hit{pos + found};
+        // the last row starting at or before the hit; offsets without the ABSENT bit are ascending
+        const std::uint64_t *next = std::upper_bound(offsets + row + 1, offsets + end + 1, hit,
+            [](std::size_t value, std::uint64_t offset) { return value < (offset & ~StringColumn::ABSENT); });
+        row = static_cast<std::size_t>(next - offsets) - 1;
+        if (hit + length <= begin(row + 1))
+        {
+            return row;
+        }
+        // the occurrence straddles two rows; keep looking after its start
+        pos = hit + 1;
+    }
+    return end;
+}
+
+} // namespace comics
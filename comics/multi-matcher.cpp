@@ -0,0 +1,90 @@
+#include "comics/multi-matcher.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace comics
+{
+
+MultiMatcher::MultiMatcher(std::span<const std::string_view> needles) :
+    m_needles(needles.size()),
+    m_transitions(ALPHABET, 0)
+{
+    // build the trie; 0 means no edge until the failure links fill in the gaps
+    std::vector<std::vector<std::uint32_t>> outputs(1);
+    for (std::uint32_t needle = 0; needle < needles.size(); ++needle)
+    {
+        std::uint32_t state{};
+        for (const char c : needles[needle])
+        {
+            const std::size_t edge{state * ALPHABET + static_cast<unsigned char>(c)};
+            if (m_transitions[edge] == 0)
+            {
+                m_transitions[edge] = static_cast<std::uint32_t>(outputs.size());
+                outputs.emplace_back();
+                m_transitions.resize(m_transitions.size() + ALPHABET, 0);
+            }
+            state = m_transitions[edge];
+        }
+        outputs[state].push_back(needle);
+    }
+
+    // breadth first, turn the trie into a DFA and merge each state's outputs with its failure state's
+    std::vector<std::uint32_t> failure(outputs.size(), 0);
+    std::deque<std::uint32_t> queue;
+    for (std::size_t c = 0; c < ALPHABET; ++c)
+    {
+        if (const std::uint32_t next = m_transitions[c]; next != 0)
+        {
+            queue.push_back(next);
+        }
+    }
+    while (!queue.empty())
+    {
+        const std::uint32_t state{queue.front()};
+        queue.pop_front();
+        const std::vector<std::uint32_t> &inherited = outputs[failure[state]];
+        outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+        for (std::size_t c = 0; c < ALPHABET; ++c)
+        {
+            std::uint32_t &next = m_transitions[state * ALPHABET + c];
+            const std::uint32_t fallback = m_transitions[failure[state] * ALPHABET + c];
+            if (next == 0)
+            {
+                next = fallback;
+            }
+            else
+            {
+                failure[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    m_outputBegin.reserve(outputs.size() + 1);
+    for (std::vector<std::uint32_t> &needlesAtState : outputs)
+    {
+        m_outputBegin.push_back(static_cast<std::uint32_t>(m_outputs.size()));
+        std::sort(needlesAtState.begin(), needlesAtState.end());
+        m_outputs.insert(m_outputs.end(), needlesAtState.begin(), needlesAtState.end());
+    }
+    m_outputBegin.push_back(static_cast<std::uint32_t>(m_outputs.size()));
+}
+
+void MultiMatcher::find(std::string_view text, std::vector<std::uint32_t> &found) const
+{
+    found.clear();
+    // empty needles are found in every text
+    found.insert(found.end(), m_outputs.begin() + m_outputBegin[0], m_outputs.begin() + m_outputBegin[1]);
+    std::uint32_t state{};
+    for (const char c : text)
+    {
+        state = m_transitions[state * ALPHABET + static_cast<unsigned char>(c)];
+        found.insert(
+            found.end(), m_outputs.begin() + m_outputBegin[state], m_outputs.begin() + m_outputBegin[state + 1]);
+    }
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+}
+
+} // namespace comics
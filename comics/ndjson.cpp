@@ -0,0 +1,151 @@
+#include "comics/ndjson.h"
+
+#include "comics/projection.h"
+#include "comics/snapshot.h"
+#include "comics/trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace comics
+{
+
+namespace
+{
+
+bool endsWith(const std::string &text, const std::string &suffix)
+{
+    return text.length() >= suffix.length() && text.substr(text.length() - suffix.length()) == suffix;
+}
+
+// Whether the JSON array file beside an NDJSON file was written after it, so it is the current dump.
+bool superseded(const std::filesystem::path &path)
+{
+    const std::filesystem::path json{std::filesystem::path(path).replace_extension(".json")};
+    return std::filesystem::is_regular_file(json) &&
+        std::filesystem::last_write_time(json) > std::filesystem::last_write_time(path);
+}
+
+} // namespace
+
+NDJSONReader::NDJSONReader(const std::filesystem::path &path, std::size_t window) :
+    m_path(path),
+    m_file(path, std::ios::binary),
+    m_buffer(window + simdjson::SIMDJSON_PADDING)
+{
+    if (!m_file)
+    {
+        throw std::runtime_error("Couldn't open " + path.string());
+    }
+}
+
+bool NDJSONReader::fill()
+{
+    const TraceSpan span{"read window"};
+    // keep the partial line after the last complete record for the next window
+    std::memmove(m_buffer.data(), m_buffer.data() + m_complete, m_size - m_complete);
+    m_size -= m_complete;
+    m_complete = 0;
+    m_pos = 0;
+    for (;;)
+    {
+        m_file.read(m_buffer.data() + m_size, static_cast<std::streamsize>(window() - m_size));
+        m_size += static_cast<std::size_t>(m_file.gcount());
+        const auto lastNewline = std::find(std::make_reverse_iterator(m_buffer.begin() + m_size),
+            std::make_reverse_iterator(m_buffer.begin()), '\n');
+        if (lastNewline.base() != m_buffer.begin())
+        {
+            m_complete = static_cast<std::size_t>(lastNewline.base() - m_buffer.begin());
+            return true;
+        }
+        if (!m_file)
+        {
+            // the last record may not end with a newline
+            m_complete = m_size;
+            return m_size > 0;
+        }
+        // a single record is larger than the window
+        m_buffer.resize(window() * 2 + simdjson::SIMDJSON_PADDING);
+    }
+}
+
+bool NDJSONReader::next(simdjson::dom::element &record)
+{
+    for (;;)
+    {
+        while (m_pos < m_complete)
+        {
+            const char *begin = m_buffer.data() + m_pos;
+            const char *end = std::find(begin, begin + (m_complete - m_pos), '\n');
+            m_pos += static_cast<std::size_t>(end - begin) + 1;
+            if (std::all_of(begin, end, [](char c) { return c == ' ' || c == '\t' || c == '\r'; }))
+            {
+                continue;
+            }
+            // the window always has SIMDJSON_PADDING bytes after its end, so no copy is needed.
+            // parse_many would index the whole window in one pass, but with threaded simdjson its
+            // document_stream links std::condition_variable symbols newer than the libstdc++ the
+            // dependencies are built against, so each line is parsed on its own.
+            if (const simdjson::error_code error =
+                    m_parser.parse(begin, static_cast<std::size_t>(end - begin), false).get(record))
+            {
+                throw std::runtime_error(
+                    "Couldn't parse record in " + m_path.string() + ": " + simdjson::error_message(error));
+            }
+            return true;
+        }
+        if (!fill())
+        {
+            return false;
+        }
+    }
+}
+
+std::optional<NDJSONPaths> findNDJSONFiles(const std::filesystem::path &dir)
+{
+    NDJSONPaths paths;
+    for (const auto &entry : std::filesystem::directory_iterator(dir))
+    {
+        if (!entry.is_regular_file())
+        {
+            continue;
+        }
+        const std::string filename{entry.path().filename().string()};
+        if (endsWith(filename, "issues.ndjson"))
+        {
+            paths.issues = entry.path();
+        }
+        else if (endsWith(filename, "sequences.ndjson"))
+        {
+            paths.sequences = entry.path();
+        }
+    }
+    if (paths.issues.empty() || paths.sequences.empty() || superseded(paths.issues) || superseded(paths.sequences))
+    {
+        return {};
+    }
+    return paths;
+}
+
+void readIssueTable(const std::filesystem::path &path, TableWriter &table)
+{
+    NDJSONReader reader{path};
+    readIssueTable(reader, table);
+}
+
+void readIssueTable(RecordReader &reader, TableWriter &table)
+{
+    simdjson::dom::element record;
+    while (reader.next(record))
+    {
+        if (!record.is_object())
+        {
+            throw std::runtime_error("Issue record should be an object");
+        }
+        projectRecord(table, ISSUE_COLUMNS, record.get_object().value());
+    }
+}
+
+} // namespace comics
@@ -0,0 +1,64 @@
+#include "comics/projection.h"
+
+#include "comics/issue-index.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace comics
+{
+
+void projectRecord(TableWriter &table, const std::vector<ColumnSpec> &columns, simdjson::dom::object record)
+{
+    for (std::size_t i = 0; i < columns.size(); ++i)
+    {
+        simdjson::dom::element value;
+        if (record.at_key(columns[i].name).get(value) != simdjson::SUCCESS)
+        {
+            continue;
+        }
+        if (value.is_string())
+        {
+            const std::string_view text{value.get_string().value()};
+            if (columns[i].type == ColumnType::INT32)
+            {
+                table.set(i, parseId(text));
+            }
+            else
+            {
+                table.set(i, text);
+            }
+        }
+        else if (value.is_int64() && columns[i].type == ColumnType::INT32)
+        {
+            table.set(i, static_cast<int>(value.get_int64().value()));
+        }
+        else if (value.is_bool() && columns[i].type == ColumnType::STRING)
+        {
+            table.set(i, value.get_bool().value() ? "true" : "false");
+        }
+        else
+        {
+            std::ostringstream typeName;
+            typeName << value.type();
+            throw std::runtime_error(
+                "Unexpected type for field '" + std::string{columns[i].name} + "', got " + typeName.str());
+        }
+    }
+    table.endRow();
+}
+
+void projectRecords(TableWriter &table, const std::vector<ColumnSpec> &columns, simdjson::dom::element records)
+{
+    for (const simdjson::dom::element record : records.get_array())
+    {
+        if (!record.is_object())
+        {
+            throw std::runtime_error("JSON array element should be an object");
+        }
+        projectRecord(table, columns, record.get_object().value());
+    }
+}
+
+} // namespace comics
@@ -0,0 +1,281 @@
+#include "comics/query-cache.h"
+
+#include "comics/snapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace comics
+{
+
+namespace
+{
+
+constexpr std::uint64_t FNV_OFFSET{0xCBF29CE484222325ULL};
+constexpr std::uint64_t FNV_PRIME{0x100000001B3ULL};
+
+std::uint64_t hashBytes(std::uint64_t hash, const void *data, std::size_t size)
+{
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+using LoadedEntry = std::pair<std::string_view, std::shared_ptr<const PostingList>>;
+
+// Decode count entries of a saved cache starting at pos, most recently used first.
+// Returns false if the data ends early or an entry doesn't decode to its row count.
+bool readEntries(const std::string &data, std::size_t pos, std::uint64_t count, std::vector<LoadedEntry> &loaded)
+{
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        QueryCacheEntry entry;
+        if (data.size() - pos < sizeof(entry))
+        {
+            return false;
+        }
+        std::memcpy(&entry, data.data() + pos, sizeof(entry));
+        pos += sizeof(entry);
+        if (data.size() - pos < entry.keyLength || data.size() - pos - entry.keyLength < entry.byteCount)
+        {
+            return false;
+        }
+        const std::string_view key{data.data() + pos, entry.keyLength};
+        pos += entry.keyLength;
+        const auto *begin = reinterpret_cast<const std::uint8_t *>(data.data() + pos);
+        const auto *end = begin + entry.byteCount;
+        pos += entry.byteCount;
+        // the last byte of an encoding ends a row, so decoding stays within the entry
+        if (entry.byteCount != 0 && (end[-1] & 0x80) != 0)
+        {
+            return false;
+        }
+        PostingList rows;
+        for (PostingList::Iterator row{begin, end}; row != PostingList::Iterator{}; ++row)
+        {
+            rows.append(*row);
+        }
+        if (rows.size() != entry.rowCount)
+        {
+            return false;
+        }
+        loaded.emplace_back(key, std::make_shared<const PostingList>(std::move(rows)));
+    }
+    return true;
+}
+
+} // namespace
+
+std::string queryKey(std::string_view field, MatchMode mode, std::string_view name)
+{
+    // the field and mode never contain a NUL, so keys of different queries never collide
+    std::string key{field};
+    key += '\0';
+    key += static_cast<char>('0' + static_cast<int>(mode));
+    key += '\0';
+    key += name;
+    return key;
+}
+
+std::uint64_t fingerprintFiles(std::span<const std::filesystem::path> files)
+{
+    std::uint64_t hash{FNV_OFFSET};
+    for (const std::filesystem::path &file : files)
+    {
+        // the name without its directory, so the cache stays valid if the data is moved
+        const std::string name{file.filename().string()};
+        const std::uint64_t size{std::filesystem::file_size(file)};
+        const std::int64_t modified{
+            static_cast<std::int64_t>(std::filesystem::last_write_time(file).time_since_epoch().count())};
+        hash = hashBytes(hash, name.data(), name.size() + 1);
+        hash = hashBytes(hash, &size, sizeof(size));
+        hash = hashBytes(hash, &modified, sizeof(modified));
+    }
+    return hash;
+}
+
+QueryCache::QueryCache(std::size_t maxBytes, std::uint64_t fingerprint, std::filesystem::path path) :
+    m_maxBytes(maxBytes),
+    m_fingerprint(fingerprint),
+    m_path(std::move(path))
+{
+    if (!m_path.empty())
+    {
+        load();
+    }
+}
+
+QueryCache::~QueryCache()
+{
+    try
+    {
+        save();
+    }
+    catch (...)
+    {
+        // the cache only saves time, so failing to keep it mustn't fail the program
+    }
+}
+
+std::shared_ptr<const PostingList> QueryCache::find(std::string_view key)
+{
+    const std::lock_guard lock{m_mutex};
+    const auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+        return nullptr;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->rows;
+}
+
+void QueryCache::insert(std::string_view key, PostingList rows)
+{
+    const std::lock_guard lock{m_mutex};
+    insertLocked(key, std::make_shared<const PostingList>(std::move(rows)));
+    m_changed = true;
+}
+
+void QueryCache::insertLocked(std::string_view key, std::shared_ptr<const PostingList> rows)
+{
+    const std::size_t bytes{key.size() + rows->bytes() + ENTRY_OVERHEAD};
+    if (const auto it = m_index.find(key); it != m_index.end())
+    {
+        m_bytes -= it->second->bytes;
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+    if (bytes > m_maxBytes)
+    {
+        return;
+    }
+    while (m_bytes + bytes > m_maxBytes)
+    {
+        m_bytes -= m_entries.back().bytes;
+        m_index.erase(m_entries.back().key);
+        m_entries.pop_back();
+    }
+    m_entries.push_front(Entry{std::string{key}, std::move(rows), bytes});
+    m_index.emplace(m_entries.front().key, m_entries.begin());
+    m_bytes += bytes;
+}
+
+void QueryCache::load()
+{
+    std::ifstream str(m_path, std::ios::binary);
+    if (!str)
+    {
+        // not saved yet
+        return;
+    }
+    const std::string data{std::istreambuf_iterator<char>(str), std::istreambuf_iterator<char>()};
+    // a file cut short within the magic may still be a cache, but anything else is another file
+    if (std::memcmp(data.data(), QUERY_CACHE_MAGIC, std::min(data.size(), sizeof(QUERY_CACHE_MAGIC))) != 0)
+    {
+        throw std::runtime_error(m_path.string() + " is not a query cache");
+    }
+    QueryCacheHeader header;
+    if (data.size() < sizeof(header))
+    {
+        // truncated within the header; replace it when saving
+        m_changed = true;
+        return;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.version != QUERY_CACHE_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER
+        || header.fingerprint != m_fingerprint)
+    {
+        // saved by another version or for other files; replace it when saving
+        m_changed = true;
+        return;
+    }
+
+    std::vector<LoadedEntry> loaded;
+    if (!readEntries(data, sizeof(header), header.entryCount, loaded))
+    {
+        // truncated or corrupt; the cache only saves time, so start empty and replace it when saving
+        m_changed = true;
+        return;
+    }
+    // entries were saved most recently used first
+    for (auto it = loaded.rbegin(); it != loaded.rend(); ++it)
+    {
+        insertLocked(it->first, std::move(it->second));
+    }
+}
+
+void QueryCache::save()
+{
+    const std::lock_guard lock{m_mutex};
+    if (m_path.empty() || !m_changed)
+    {
+        return;
+    }
+    QueryCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, QUERY_CACHE_MAGIC, sizeof(QUERY_CACHE_MAGIC));
+    header.version = QUERY_CACHE_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.fingerprint = m_fingerprint;
+    header.entryCount = m_entries.size();
+
+    std::filesystem::path temporary{m_path};
+    temporary += ".tmp";
+    {
+        std::ofstream str(temporary, std::ios::binary | std::ios::trunc);
+        if (!str)
+        {
+            throw std::runtime_error("Couldn't create " + temporary.string());
+        }
+        str.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (const Entry &entry : m_entries)
+        {
+            const std::span<const std::uint8_t> encoded{entry.rows->encoded()};
+            const QueryCacheEntry record{static_cast<std::uint32_t>(entry.key.size()),
+                static_cast<std::uint32_t>(entry.rows->size()), encoded.size()};
+            str.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            str.write(entry.key.data(), static_cast<std::streamsize>(entry.key.size()));
+            str.write(reinterpret_cast<const char *>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        }
+        if (!str.flush())
+        {
+            throw std::runtime_error("Couldn't write " + temporary.string());
+        }
+    }
+    std::filesystem::rename(temporary, m_path);
+    m_changed = false;
+}
+
+std::size_t QueryCache::entries() const
+{
+    const std::lock_guard lock{m_mutex};
+    return m_entries.size();
+}
+
+std::size_t QueryCache::bytes() const
+{
+    const std::lock_guard lock{m_mutex};
+    return m_bytes;
+}
+
+std::unique_ptr<QueryCache> openQueryCache(
+    const DatabaseOptions &options, const std::filesystem::path &issues, const std::filesystem::path &sequences)
+{
+    if (options.cacheBytes == 0)
+    {
+        return nullptr;
+    }
+    const std::array files{issues, sequences};
+    return std::make_unique<QueryCache>(options.cacheBytes, fingerprintFiles(files), options.cachePath);
+}
+
+} // namespace comics
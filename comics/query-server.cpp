@@ -0,0 +1,118 @@
+#include "comics/query-server.h"
+
+#include "comics/match-printer.h"
+
+#include <stdexcept>
+
+namespace comics
+{
+namespace coroutine
+{
+
+namespace
+{
+
+std::string_view nextWord(std::string_view &line)
+{
+    const std::size_t begin{std::min(line.find_first_not_of(" \t"), line.size())};
+    line.remove_prefix(begin);
+    const std::size_t end{std::min(line.find_first_of(" \t"), line.size())};
+    const std::string_view word{line.substr(0, end)};
+    line.remove_prefix(end);
+    return word;
+}
+
+std::string_view trim(std::string_view text)
+{
+    const std::size_t begin{text.find_first_not_of(" \t\r")};
+    if (begin == std::string_view::npos)
+    {
+        return {};
+    }
+    return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+}
+
+} // namespace
+
+Query parseQuery(std::string_view line)
+{
+    Query query;
+    std::string_view option{nextWord(line)};
+    if (option == "-x")
+    {
+        query.mode = MatchMode::CREATOR;
+        option = nextWord(line);
+    }
+    else if (option == "-f")
+    {
+        query.mode = MatchMode::FOLDED;
+        option = nextWord(line);
+    }
+    if (option == "-s")
+    {
+        query.field = CreditField::SCRIPT;
+    }
+    else if (option == "-p")
+    {
+        query.field = CreditField::PENCIL;
+    }
+    else if (option == "-i")
+    {
+        query.field = CreditField::INK;
+    }
+    else if (option == "-c")
+    {
+        query.field = CreditField::COLOR;
+    }
+    else if (option == "-l")
+    {
+        query.field = CreditField::LETTER;
+    }
+    else
+    {
+        throw std::runtime_error("Expected -s, -p, -i, -c or -l, got '" + std::string{option} + "'");
+    }
+    // the name is the rest of the line, which may contain spaces
+    query.name = trim(line);
+    if (query.name.empty())
+    {
+        throw std::runtime_error("Missing name");
+    }
+    return query;
+}
+
+void answerQuery(std::ostream &str, const DatabasePtr &database, std::string_view line)
+{
+    try
+    {
+        const Query query{parseQuery(line)};
+        MatchGenerator coro{matches(database, query.field, query.name, query.mode)};
+        MatchPrinter{*database}.printAll(str, coro);
+    }
+    catch (const std::exception &bang)
+    {
+        str << "error: " << bang.what() << '\n';
+    }
+    str << END_OF_RESPONSE << '\n' << std::flush;
+}
+
+void serveQueries(std::istream &in, std::ostream &out, const DatabasePtr &database)
+{
+    std::string line;
+    while (out && std::getline(in, line))
+    {
+        const std::string_view request{trim(line)};
+        if (request.empty())
+        {
+            continue;
+        }
+        if (request == "quit")
+        {
+            break;
+        }
+        answerQuery(out, database, request);
+    }
+}
+
+} // namespace coroutine
+} // namespace comics
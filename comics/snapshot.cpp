@@ -0,0 +1,409 @@
+#include "comics/snapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace comics
+{
+
+const std::vector<ColumnSpec> ISSUE_COLUMNS{
+    {"id", ColumnType::INT32},
+    {"series name", ColumnType::STRING},
+    {"issue number", ColumnType::STRING},
+};
+
+const std::vector<ColumnSpec> SEQUENCE_COLUMNS{
+    {"issue", ColumnType::INT32},
+    {"sequence_number", ColumnType::INT32},
+    {"title", ColumnType::STRING},
+    {"feature", ColumnType::STRING},
+    {"script", ColumnType::STRING},
+    {"pencils", ColumnType::STRING},
+    {"inks", ColumnType::STRING},
+    {"colors", ColumnType::STRING},
+    {"letters", ColumnType::STRING},
+};
+
+IssueColumns::IssueColumns(const Table &table) :
+    id(table.intColumn("id")),
+    seriesName(table.stringColumn("series name")),
+    issueNumber(table.stringColumn("issue number"))
+{
+}
+
+SequenceColumns::SequenceColumns(const Table &table) :
+    issue(table.intColumn("issue")),
+    sequenceNumber(table.intColumn("sequence_number")),
+    title(table.stringColumn("title")),
+    feature(table.stringColumn("feature")),
+    script(table.stringColumn("script")),
+    pencils(table.stringColumn("pencils")),
+    inks(table.stringColumn("inks")),
+    colors(table.stringColumn("colors")),
+    letters(table.stringColumn("letters"))
+{
+}
+
+const StringColumn *SequenceColumns::credit(std::string_view key) const
+{
+    if (key == "script")
+    {
+        return &script;
+    }
+    if (key == "pencils")
+    {
+        return &pencils;
+    }
+    if (key == "inks")
+    {
+        return &inks;
+    }
+    if (key == "colors")
+    {
+        return &colors;
+    }
+    if (key == "letters")
+    {
+        return &letters;
+    }
+    return nullptr;
+}
+
+namespace
+{
+
+inline bool endsWith(const std::string &text, const std::string &suffix)
+{
+    return text.length() >= suffix.length() && text.substr(text.length() - suffix.length()) == suffix;
+}
+
+std::uint64_t aligned(std::uint64_t offset)
+{
+    return (offset + 7) & ~std::uint64_t{7};
+}
+
+// Whether a snapshot was written with the JSON beside it, or has no JSON to go stale against.  Files
+// that aren't snapshots are left for the Snapshot constructor to reject.
+bool isCurrent(const std::filesystem::path &path)
+{
+    SnapshotHeader header;
+    std::ifstream str(path, std::ios::binary);
+    if (!str.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+    {
+        return true;
+    }
+    if (header.version != SNAPSHOT_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER)
+    {
+        return false;
+    }
+    if (header.source == FileStamp{})
+    {
+        return true;
+    }
+    bool sources{};
+    for (const char *extension : {".json", ".ndjson"})
+    {
+        const std::filesystem::path source{std::filesystem::path(path).replace_extension(extension)};
+        if (std::filesystem::is_regular_file(source))
+        {
+            if (stampFile(source) == header.source)
+            {
+                return true;
+            }
+            sources = true;
+        }
+    }
+    return !sources;
+}
+
+} // namespace
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::filesystem::path &path)
+{
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        throw std::runtime_error("Couldn't open " + path.string());
+    }
+    LARGE_INTEGER size{};
+    GetFileSizeEx(m_file, &size);
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    if (m_size == 0)
+    {
+        return;
+    }
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr)
+    {
+        CloseHandle(m_file);
+        throw std::runtime_error("Couldn't map " + path.string());
+    }
+    m_data = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr)
+    {
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw std::runtime_error("Couldn't map " + path.string());
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr)
+    {
+        CloseHandle(m_file);
+    }
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path &path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Couldn't open " + path.string());
+    }
+    struct stat status
+    {
+    };
+    if (::fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Couldn't stat " + path.string());
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+    if (m_size != 0)
+    {
+        void *data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Couldn't map " + path.string());
+        }
+        m_data = static_cast<const char *>(data);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        ::munmap(const_cast<char *>(m_data), m_size);
+    }
+}
+#endif
+
+FileStamp stampFile(const std::filesystem::path &path)
+{
+    return {std::filesystem::file_size(path),
+        static_cast<std::int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count())};
+}
+
+Snapshot::Snapshot(const std::filesystem::path &path) :
+    m_file(path)
+{
+    const std::string name{path.string()};
+    if (m_file.size() < sizeof(SnapshotHeader))
+    {
+        throw std::runtime_error("Snapshot " + name + " is truncated");
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+    {
+        throw std::runtime_error(name + " is not a snapshot");
+    }
+    if (header.byteOrder != SNAPSHOT_BYTE_ORDER)
+    {
+        throw std::runtime_error("Snapshot " + name + " was written with a different byte order");
+    }
+    if (header.version != SNAPSHOT_VERSION)
+    {
+        throw std::runtime_error("Snapshot " + name + " has version " + std::to_string(header.version) + ", expected " +
+            std::to_string(SNAPSHOT_VERSION));
+    }
+    const std::uint64_t rows{header.rowCount};
+    if (sizeof(SnapshotHeader) + header.columnCount * sizeof(SnapshotColumnHeader) > m_file.size())
+    {
+        throw std::runtime_error("Snapshot " + name + " is truncated");
+    }
+
+    m_table = Table(static_cast<std::size_t>(rows));
+    const auto inFile = [&](std::uint64_t offset, std::uint64_t size)
+    { return offset % 8 == 0 && offset <= m_file.size() && size <= m_file.size() - offset; };
+    for (std::uint32_t i = 0; i < header.columnCount; ++i)
+    {
+        SnapshotColumnHeader column;
+        std::memcpy(&column, m_file.data() + sizeof(SnapshotHeader) + i * sizeof(SnapshotColumnHeader), sizeof(column));
+        const std::string_view columnName{column.name, strnlen(column.name, sizeof(column.name))};
+        const char *data = m_file.data() + column.dataOffset;
+        if (column.type == ColumnType::INT32)
+        {
+            if (!inFile(column.dataOffset, rows * sizeof(std::int32_t)))
+            {
+                throw std::runtime_error("Snapshot " + name + " column '" + std::string{columnName} + "' is truncated");
+            }
+            m_table.addColumn(
+                columnName, IntColumn{reinterpret_cast<const std::int32_t *>(data), static_cast<std::size_t>(rows)});
+        }
+        else if (column.type == ColumnType::STRING)
+        {
+            if (!inFile(column.dataOffset, (rows + 1) * sizeof(std::uint64_t)) ||
+                column.blobOffset != column.dataOffset + (rows + 1) * sizeof(std::uint64_t) ||
+                column.blobSize > m_file.size() - column.blobOffset)
+            {
+                throw std::runtime_error("Snapshot " + name + " column '" + std::string{columnName} + "' is truncated");
+            }
+            // Only the final offset is checked; validating every row would fault in the whole file.
+            const auto *offsets = reinterpret_cast<const std::uint64_t *>(data);
+            if ((offsets[rows] & ~StringColumn::ABSENT) != column.blobSize)
+            {
+                throw std::runtime_error("Snapshot " + name + " column '" + std::string{columnName} + "' is corrupt");
+            }
+            m_table.addColumn(
+                columnName, StringColumn{offsets, m_file.data() + column.blobOffset, static_cast<std::size_t>(rows)});
+        }
+        else
+        {
+            throw std::runtime_error("Snapshot " + name + " column '" + std::string{columnName} + "' has unknown type " +
+                std::to_string(static_cast<std::uint32_t>(column.type)));
+        }
+    }
+}
+
+void writeSnapshot(const std::filesystem::path &path, const Table &table, const std::filesystem::path &source)
+{
+    const std::vector<Table::Column> &columns{table.columns()};
+    const std::uint64_t rows{table.rows()};
+
+    std::vector<SnapshotColumnHeader> headers(columns.size());
+    std::uint64_t offset{aligned(sizeof(SnapshotHeader) + columns.size() * sizeof(SnapshotColumnHeader))};
+    for (std::size_t i = 0; i < columns.size(); ++i)
+    {
+        SnapshotColumnHeader &header = headers[i];
+        std::memset(&header, 0, sizeof(header));
+        if (columns[i].name.size() >= sizeof(header.name))
+        {
+            throw std::runtime_error("Column name '" + columns[i].name + "' too long");
+        }
+        std::memcpy(header.name, columns[i].name.data(), columns[i].name.size());
+        header.type = columns[i].type;
+        header.dataOffset = offset;
+        if (columns[i].type == ColumnType::INT32)
+        {
+            offset = aligned(offset + rows * sizeof(std::int32_t));
+        }
+        else
+        {
+            header.blobOffset = offset + (rows + 1) * sizeof(std::uint64_t);
+            header.blobSize = columns[i].strings.blobSize();
+            offset = aligned(header.blobOffset + header.blobSize);
+        }
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.rowCount = rows;
+    header.columnCount = static_cast<std::uint32_t>(columns.size());
+    if (!source.empty())
+    {
+        header.source = stampFile(source);
+    }
+
+    std::ofstream str(path, std::ios::binary | std::ios::trunc);
+    if (!str)
+    {
+        throw std::runtime_error("Couldn't create " + path.string());
+    }
+    std::uint64_t written{};
+    const auto write = [&](const void *data, std::uint64_t size)
+    {
+        str.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        written += size;
+    };
+    const auto pad = [&]
+    {
+        constexpr char zeros[8]{};
+        write(zeros, aligned(written) - written);
+    };
+    write(&header, sizeof(header));
+    write(headers.data(), headers.size() * sizeof(SnapshotColumnHeader));
+    pad();
+    for (const Table::Column &column : columns)
+    {
+        if (column.type == ColumnType::INT32)
+        {
+            write(column.ints.data(), rows * sizeof(std::int32_t));
+        }
+        else if (rows == 0)
+        {
+            const std::uint64_t zero{};
+            write(&zero, sizeof(zero));
+        }
+        else
+        {
+            write(column.strings.offsets(), (rows + 1) * sizeof(std::uint64_t));
+            write(column.strings.blob(), column.strings.blobSize());
+        }
+        pad();
+    }
+    if (!str)
+    {
+        throw std::runtime_error("Couldn't write " + path.string());
+    }
+}
+
+std::optional<SnapshotPaths> findSnapshots(const std::filesystem::path &dir)
+{
+    SnapshotPaths paths;
+    for (const auto &entry : std::filesystem::directory_iterator(dir))
+    {
+        if (!entry.is_regular_file())
+        {
+            continue;
+        }
+        const std::string filename{entry.path().filename().string()};
+        if (endsWith(filename, "issues.snapshot"))
+        {
+            paths.issues = entry.path();
+        }
+        else if (endsWith(filename, "sequences.snapshot"))
+        {
+            paths.sequences = entry.path();
+        }
+    }
+    if (paths.issues.empty() || paths.sequences.empty() || !isCurrent(paths.issues) || !isCurrent(paths.sequences))
+    {
+        return {};
+    }
+    return paths;
+}
+
+} // namespace comics
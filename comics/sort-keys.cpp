@@ -0,0 +1,52 @@
+#include "comics/sort-keys.h"
+
+#include "comics/issue-index.h"
+
+#include <array>
+#include <cstddef>
+
+namespace comics
+{
+
+SequenceKey sequenceKey(simdjson::dom::object sequence)
+{
+    return sequenceKey(parseId(sequence.at_key("issue").get_string().value()),
+        parseId(sequence.at_key("sequence_number").get_string().value()));
+}
+
+void sortKeyedRows(std::vector<KeyedRow> &rows)
+{
+    constexpr std::size_t DIGITS{sizeof(SequenceKey)};
+    std::array<std::array<std::size_t, 256>, DIGITS> counts{};
+    for (const KeyedRow &row : rows)
+    {
+        for (std::size_t digit = 0; digit < DIGITS; ++digit)
+        {
+            ++counts[digit][(row.key >> (digit * 8)) & 0xFF];
+        }
+    }
+    std::vector<KeyedRow> sorted(rows.size());
+    for (std::size_t digit = 0; digit < DIGITS; ++digit)
+    {
+        std::array<std::size_t, 256> &count{counts[digit]};
+        // most bytes of ids and sequence numbers are the same in every key
+        if (count[(rows.empty() ? 0 : rows.front().key >> (digit * 8)) & 0xFF] == rows.size())
+        {
+            continue;
+        }
+        std::size_t offset{};
+        for (std::size_t &bucket : count)
+        {
+            const std::size_t size{bucket};
+            bucket = offset;
+            offset += size;
+        }
+        for (const KeyedRow &row : rows)
+        {
+            sorted[count[(row.key >> (digit * 8)) & 0xFF]++] = row;
+        }
+        rows.swap(sorted);
+    }
+}
+
+} // namespace comics
@@ -0,0 +1,151 @@
+#include "comics/stats.h"
+
+#include <iomanip>
+#include <ios>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace comics
+{
+
+namespace
+{
+
+// The innermost timer running on each thread.
+thread_local PhaseTimer *t_current{};
+
+double milliseconds(std::int64_t nanoseconds)
+{
+    return static_cast<double>(nanoseconds) / 1e6;
+}
+
+std::int64_t elapsed(const QueryStats &stats)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - stats.start)
+        .count();
+}
+
+} // namespace
+
+std::string_view to_string(Phase phase)
+{
+    switch (phase)
+    {
+    case Phase::READ:
+        return "read";
+    case Phase::PARSE:
+        return "parse";
+    case Phase::PROJECT:
+        return "project";
+    case Phase::INDEX:
+        return "index";
+    case Phase::SCAN:
+        return "scan";
+    case Phase::JOIN:
+        return "join";
+    case Phase::SORT:
+        return "sort";
+    case Phase::OUTPUT:
+        return "output";
+    }
+    return "?";
+}
+
+PhaseTimer::PhaseTimer(QueryStats *stats, Phase phase) :
+    m_stats(stats),
+    m_span(to_string(phase).data()),
+    m_phase(phase)
+{
+    if (m_stats != nullptr)
+    {
+        m_outer = t_current;
+        t_current = this;
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    if (m_stats == nullptr)
+    {
+        return;
+    }
+    const std::chrono::nanoseconds time{std::chrono::steady_clock::now() - m_start};
+    m_stats->nanoseconds[static_cast<std::size_t>(m_phase)].fetch_add(
+        (time - m_nested).count(), std::memory_order_relaxed);
+    if (m_outer != nullptr)
+    {
+        m_outer->m_nested += time;
+    }
+    t_current = m_outer;
+}
+
+std::uint64_t peakResidentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    // Linux reports kilobytes
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+void printStats(std::ostream &str, const QueryStats &stats)
+{
+    const std::ios_base::fmtflags flags{str.flags()};
+    const std::streamsize precision{str.precision()};
+    str << std::fixed << std::setprecision(3);
+    for (std::size_t phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        str << std::setw(16) << to_string(static_cast<Phase>(phase)) << ": "
+            << milliseconds(stats.nanoseconds[phase].load()) << " ms\n";
+    }
+    str << std::setw(16) << "total" << ": " << milliseconds(elapsed(stats)) << " ms\n";
+    str << std::setw(16) << "bytes read" << ": " << stats.bytesRead.load() << '\n'
+        << std::setw(16) << "records scanned" << ": " << stats.recordsScanned.load() << '\n'
+        << std::setw(16) << "matches" << ": " << stats.matches.load() << '\n'
+        << std::setw(16) << "join lookups" << ": " << stats.joinLookups.load() << '\n'
+        << std::setw(16) << "output bytes" << ": " << stats.outputBytes.load() << '\n'
+        << std::setw(16) << "cache hits" << ": " << stats.cacheHits.load() << '\n'
+        << std::setw(16) << "peak memory" << ": " << peakResidentBytes() << '\n';
+    str.flags(flags);
+    str.precision(precision);
+}
+
+void printStatsJSON(std::ostream &str, const QueryStats &stats)
+{
+    str << "{\"phases_ns\": {";
+    for (std::size_t phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        str << (phase == 0 ? "" : ", ") << '"' << to_string(static_cast<Phase>(phase))
+            << "\": " << stats.nanoseconds[phase].load();
+    }
+    str << "}, \"total_ns\": " << elapsed(stats) << ", \"bytes_read\": " << stats.bytesRead.load()
+        << ", \"records_scanned\": " << stats.recordsScanned.load() << ", \"matches\": " << stats.matches.load()
+        << ", \"join_lookups\": " << stats.joinLookups.load() << ", \"output_bytes\": " << stats.outputBytes.load()
+        << ", \"cache_hits\": " << stats.cacheHits.load()
+        << ", \"peak_memory_bytes\": " << peakResidentBytes() << "}\n";
+}
+
+} // namespace comics
@@ -0,0 +1,179 @@
+#include "comics/table.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace comics
+{
+
+void Table::addColumn(std::string_view name, IntColumn column)
+{
+    m_columns.push_back(Column{std::string{name}, ColumnType::INT32, column, {}});
+}
+
+void Table::addColumn(std::string_view name, StringColumn column)
+{
+    m_columns.push_back(Column{std::string{name}, ColumnType::STRING, {}, column});
+}
+
+bool Table::hasColumn(std::string_view name) const
+{
+    return std::any_of(m_columns.begin(), m_columns.end(), [=](const Column &column) { return column.name == name; });
+}
+
+const Table::Column &Table::column(std::string_view name, ColumnType type) const
+{
+    const auto it = std::find_if(m_columns.begin(), m_columns.end(),
+        [=](const Column &column) { return column.name == name && column.type == type; });
+    if (it == m_columns.end())
+    {
+        throw std::runtime_error("Table has no " + std::string{type == ColumnType::INT32 ? "integer" : "string"} +
+            " column '" + std::string{name} + "'");
+    }
+    return *it;
+}
+
+const IntColumn &Table::intColumn(std::string_view name) const
+{
+    return column(name, ColumnType::INT32).ints;
+}
+
+const StringColumn &Table::stringColumn(std::string_view name) const
+{
+    return column(name, ColumnType::STRING).strings;
+}
+
+TableWriter::TableWriter(std::vector<ColumnSpec> columns) :
+    m_specs(std::move(columns)),
+    m_ints(m_specs.size()),
+    m_offsets(m_specs.size()),
+    m_blobs(m_specs.size()),
+    m_set(m_specs.size())
+{
+    for (std::size_t i = 0; i < m_specs.size(); ++i)
+    {
+        if (m_specs[i].type == ColumnType::STRING)
+        {
+            m_offsets[i].push_back(0);
+        }
+    }
+}
+
+void TableWriter::set(std::size_t column, int value)
+{
+    if (m_specs.at(column).type != ColumnType::INT32)
+    {
+        throw std::runtime_error("Column '" + std::string{m_specs[column].name} + "' is not an integer column");
+    }
+    if (!m_set[column])
+    {
+        m_ints[column].push_back(value);
+        m_set[column] = true;
+    }
+    else
+    {
+        m_ints[column].back() = value;
+    }
+}
+
+void TableWriter::set(std::size_t column, std::string_view value)
+{
+    if (m_specs.at(column).type != ColumnType::STRING)
+    {
+        throw std::runtime_error("Column '" + std::string{m_specs[column].name} + "' is not a string column");
+    }
+    std::string &blob = m_blobs[column];
+    std::vector<std::uint64_t> &offsets = m_offsets[column];
+    if (m_set[column])
+    {
+        // replace the value already written for this row
+        blob.resize(static_cast<std::size_t>(offsets[offsets.size() - 2] & ~StringColumn::ABSENT));
+        offsets.pop_back();
+    }
+    blob.append(value);
+    offsets.push_back(blob.size());
+    m_set[column] = true;
+}
+
+void TableWriter::endRow()
+{
+    for (std::size_t i = 0; i < m_specs.size(); ++i)
+    {
+        if (!m_set[i])
+        {
+            if (m_specs[i].type == ColumnType::INT32)
+            {
+                m_ints[i].push_back(0);
+            }
+            else
+            {
+                m_offsets[i].push_back(m_blobs[i].size() | StringColumn::ABSENT);
+            }
+        }
+        m_set[i] = false;
+    }
+    ++m_rows;
+}
+
+void TableWriter::append(const TableWriter &rows)
+{
+    if (rows.m_specs.size() != m_specs.size() ||
+        !std::equal(m_specs.begin(), m_specs.end(), rows.m_specs.begin(),
+            [](const ColumnSpec &lhs, const ColumnSpec &rhs) { return lhs.name == rhs.name && lhs.type == rhs.type; }))
+    {
+        throw std::runtime_error("Appended rows have different columns");
+    }
+    for (std::size_t i = 0; i < m_specs.size(); ++i)
+    {
+        if (m_specs[i].type == ColumnType::INT32)
+        {
+            m_ints[i].insert(m_ints[i].end(), rows.m_ints[i].begin(), rows.m_ints[i].end());
+            continue;
+        }
+        // the appended offsets are relative to their own blob
+        const std::uint64_t base{m_blobs[i].size()};
+        for (auto it = rows.m_offsets[i].begin() + 1; it != rows.m_offsets[i].end(); ++it)
+        {
+            m_offsets[i].push_back(((*it & ~StringColumn::ABSENT) + base) | (*it & StringColumn::ABSENT));
+        }
+        m_blobs[i].append(rows.m_blobs[i]);
+    }
+    m_rows += rows.m_rows;
+}
+
+void TableWriter::appendRow(const Table &table, std::size_t row)
+{
+    const std::vector<Table::Column> &columns{table.columns()};
+    for (std::size_t i = 0; i < m_specs.size(); ++i)
+    {
+        if (columns.at(i).type == ColumnType::INT32)
+        {
+            set(i, columns[i].ints[row]);
+        }
+        else if (columns[i].strings.present(row))
+        {
+            set(i, columns[i].strings[row]);
+        }
+    }
+    endRow();
+}
+
+Table TableWriter::table() const
+{
+    Table table(m_rows);
+    for (std::size_t i = 0; i < m_specs.size(); ++i)
+    {
+        if (m_specs[i].type == ColumnType::INT32)
+        {
+            table.addColumn(m_specs[i].name, IntColumn{m_ints[i].data(), m_rows});
+        }
+        else
+        {
+            table.addColumn(m_specs[i].name, StringColumn{m_offsets[i].data(), m_blobs[i].data(), m_rows});
+        }
+    }
+    return table;
+}
+
+} // namespace comics
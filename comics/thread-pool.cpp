@@ -0,0 +1,106 @@
+#include "comics/thread-pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <latch>
+#include <stdexcept>
+
+namespace comics
+{
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+    if (threads == 0)
+    {
+        throw std::runtime_error("Thread pool needs at least one thread");
+    }
+    m_workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        m_workers.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    m_ready.release(static_cast<std::ptrdiff_t>(m_workers.size()));
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::work()
+{
+    for (;;)
+    {
+        m_ready.acquire();
+        std::function<void()> task;
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_tasks.empty())
+            {
+                // a release without a task asks the worker to stop
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+std::size_t ThreadPool::parts(std::size_t count) const
+{
+    return std::min<std::size_t>(count, threads());
+}
+
+void ThreadPool::parallelFor(
+    std::size_t count, const std::function<void(std::size_t part, std::size_t begin, std::size_t end)> &fn)
+{
+    const std::size_t numParts{parts(count)};
+    if (numParts == 0)
+    {
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(numParts);
+    const auto runPart = [&](std::size_t part)
+    {
+        try
+        {
+            fn(part, count * part / numParts, count * (part + 1) / numParts);
+        }
+        catch (...)
+        {
+            errors[part] = std::current_exception();
+        }
+    };
+
+    std::latch done{static_cast<std::ptrdiff_t>(numParts - 1)};
+    {
+        std::lock_guard lock(m_mutex);
+        for (std::size_t part = 1; part < numParts; ++part)
+        {
+            m_tasks.emplace_back(
+                [&, part]
+                {
+                    runPart(part);
+                    done.count_down();
+                });
+        }
+    }
+    m_ready.release(static_cast<std::ptrdiff_t>(numParts - 1));
+    runPart(0);
+    done.wait();
+
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace comics
@@ -0,0 +1,127 @@
+#include "comics/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace comics
+{
+
+namespace
+{
+
+std::atomic<std::uint64_t> g_nextRecorderId{1};
+
+// The buffer this thread last wrote to, and the recorder it belongs to.  Recorders are told apart by
+// id rather than address, as a new recorder may be created where an old one was.
+struct ThreadSlot
+{
+    std::uint64_t recorder{};
+    void *buffer{};
+};
+
+thread_local ThreadSlot t_slot;
+
+// Microseconds with nanosecond precision, as trace event timestamps are in microseconds.
+void writeMicroseconds(std::ostream &str, std::int64_t nanoseconds)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%lld.%03lld", static_cast<long long>(nanoseconds / 1000),
+        static_cast<long long>(nanoseconds % 1000));
+    str << text;
+}
+
+} // namespace
+
+std::atomic<TraceRecorder *> TraceRecorder::s_active{};
+
+TraceRecorder::TraceRecorder(std::size_t eventsPerThread) :
+    m_id(g_nextRecorderId.fetch_add(1)),
+    m_eventsPerThread(std::max<std::size_t>(eventsPerThread, 1))
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    TraceRecorder *self{this};
+    s_active.compare_exchange_strong(self, nullptr);
+}
+
+void TraceRecorder::setActive(TraceRecorder *recorder)
+{
+    s_active.store(recorder, std::memory_order_release);
+}
+
+TraceRecorder::ThreadBuffer &TraceRecorder::threadBuffer()
+{
+    if (t_slot.recorder != m_id)
+    {
+        const std::lock_guard lock{m_mutex};
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->events.resize(m_eventsPerThread);
+        buffer->tid = static_cast<std::uint32_t>(m_threads.size() + 1);
+        t_slot = {m_id, buffer.get()};
+        m_threads.push_back(std::move(buffer));
+    }
+    return *static_cast<ThreadBuffer *>(t_slot.buffer);
+}
+
+void TraceRecorder::record(
+    const char *name, std::int64_t startNanoseconds, std::int64_t durationNanoseconds, std::int64_t value)
+{
+    ThreadBuffer &buffer{threadBuffer()};
+    buffer.events[buffer.written % buffer.events.size()] = Event{name, startNanoseconds, durationNanoseconds, value};
+    ++buffer.written;
+}
+
+std::uint64_t TraceRecorder::dropped() const
+{
+    const std::lock_guard lock{m_mutex};
+    std::uint64_t count{};
+    for (const std::unique_ptr<ThreadBuffer> &buffer : m_threads)
+    {
+        count += buffer->written - std::min<std::uint64_t>(buffer->written, buffer->events.size());
+    }
+    return count;
+}
+
+void TraceRecorder::writeChromeTrace(std::ostream &str) const
+{
+    const std::uint64_t lost{dropped()};
+    const std::lock_guard lock{m_mutex};
+    str << "{\"displayTimeUnit\": \"ns\", \"otherData\": {\"dropped_events\": " << lost << "},\n"
+        << "\"traceEvents\": [\n";
+    bool first{true};
+    for (const std::unique_ptr<ThreadBuffer> &buffer : m_threads)
+    {
+        // threads are numbered in the order they first recorded a span
+        str << (first ? "" : ",\n") << R"({"name": "thread_name", "ph": "M", "pid": 1, "tid": )" << buffer->tid
+            << R"(, "args": {"name": "thread )" << buffer->tid << "\"}}";
+        first = false;
+
+        const std::uint64_t count{std::min<std::uint64_t>(buffer->written, buffer->events.size())};
+        for (std::uint64_t i = buffer->written - count; i < buffer->written; ++i)
+        {
+            const Event &event{buffer->events[i % buffer->events.size()]};
+            str << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"comics\", \"pid\": 1, \"tid\": " << buffer->tid
+                << ", \"ts\": ";
+            writeMicroseconds(str, event.start);
+            if (event.duration >= 0)
+            {
+                str << ", \"ph\": \"X\", \"dur\": ";
+                writeMicroseconds(str, event.duration);
+            }
+            else
+            {
+                str << R"(, "ph": "i", "s": "t")";
+            }
+            if (event.value >= 0)
+            {
+                str << ", \"args\": {\"n\": " << event.value << '}';
+            }
+            str << '}';
+        }
+    }
+    str << "\n]}\n";
+}
+
+} // namespace comics
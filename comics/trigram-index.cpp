@@ -0,0 +1,96 @@
+#include "comics/trigram-index.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace comics
+{
+
+namespace
+{
+
+std::uint32_t trigram(const char *text)
+{
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(text[0])) << 16 |
+        static_cast<std::uint32_t>(static_cast<unsigned char>(text[1])) << 8 |
+        static_cast<std::uint32_t>(static_cast<unsigned char>(text[2]));
+}
+
+// Stop intersecting once the remaining lists are this many times longer than the candidates;
+// verifying the candidates is then cheaper than decoding the lists.
+constexpr std::size_t INTERSECT_RATIO{16};
+
+} // namespace
+
+void TrigramIndex::add(std::uint32_t row, std::string_view text)
+{
+    for (std::size_t pos = 0; pos + MIN_NEEDLE <= text.size(); ++pos)
+    {
+        // appending the same row twice is ignored, so repeated trigrams cost nothing
+        m_postings[trigram(text.data() + pos)].append(row);
+    }
+}
+
+std::vector<std::uint32_t> TrigramIndex::candidates(std::string_view needle) const
+{
+    if (needle.size() < MIN_NEEDLE)
+    {
+        throw std::runtime_error("Trigram index needle '" + std::string{needle} + "' is too short");
+    }
+
+    std::vector<const PostingList *> lists;
+    for (std::size_t pos = 0; pos + MIN_NEEDLE <= needle.size(); ++pos)
+    {
+        const auto it = m_postings.find(trigram(needle.data() + pos));
+        if (it == m_postings.end())
+        {
+            return {};
+        }
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+        [](const PostingList *lhs, const PostingList *rhs) { return lhs->size() < rhs->size(); });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    std::vector<std::uint32_t> rows(lists.front()->begin(), lists.front()->end());
+    std::vector<std::uint32_t> common;
+    for (auto list = lists.begin() + 1; list != lists.end() && !rows.empty(); ++list)
+    {
+        if ((*list)->size() > rows.size() * INTERSECT_RATIO)
+        {
+            break;
+        }
+        common.clear();
+        auto row = rows.begin();
+        for (auto it = (*list)->begin(); it != (*list)->end() && row != rows.end(); ++it)
+        {
+            while (row != rows.end() && *row < *it)
+            {
+                ++row;
+            }
+            if (row != rows.end() && *row == *it)
+            {
+                common.push_back(*row);
+                ++row;
+            }
+        }
+        std::swap(rows, common);
+    }
+    return rows;
+}
+
+TrigramIndex buildTrigramIndex(const StringColumn &column)
+{
+    TrigramIndex index;
+    for (std::size_t row = 0; row < column.size(); ++row)
+    {
+        if (column.present(row))
+        {
+            index.add(static_cast<std::uint32_t>(row), column[row]);
+        }
+    }
+    return index;
+}
+
+} // namespace comics
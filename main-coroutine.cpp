@@ -1,131 +1,269 @@
 #include <comics/coro.h>
+#include <comics/match-printer.h>
+#include <comics/stats.h>
+#include <comics/trace.h>
 
+#include <algorithm>
+#include <charconv>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace
 {
 
+constexpr std::size_t DEFAULT_CACHE_MIB{64};
+
 int usage(const char *program)
 {
     std::cerr << "Usage: " << program
-              << " <jsondir> (-s <script writer name>|-p <penciler name>|-i <inker name>|-c <colorist name>)\n";
+              << " <jsondir> [-x|-f] [-o] [-t] [--threads N] [--batch N] [--memory-budget MiB]\n"
+                 "    [--cache <file>] [--cache-size MiB] [--stats[=json]] [--trace <file>] [--any]\n"
+                 "    (-s <script writer name>|-p <penciler name>|-i <inker name>|-c <colorist name>|\n"
+                 "     -l <letterer name>)...\n"
+                 "    (-s|-p|-i|-c|-l) --names <file>\n"
+                 "  -x  match whole creator names, ignoring case and credit annotations\n"
+                 "  -f  match ignoring case and accents\n"
+                 "  -o  print matches ordered by issue and sequence number\n"
+                 "  -t  build a trigram index to answer substring queries\n"
+                 "  --threads N  split scans of the sequences across N threads\n"
+                 "  --batch N  take up to N matches from the scan per resume\n"
+                 "  --memory-budget MiB  read JSON dumps in chunks, using about this much memory to parse them\n"
+                 "  --cache <file>  keep the results of queries in the file, so repeating a query skips the scan\n"
+                 "  --cache-size MiB  keep up to this many MiB of query results, 64 by default\n"
+                 "  --names <file>  match every name in the file, one per line, in a single pass\n"
+                 "  --any  match sequences with any of several credits, rather than all of them\n"
+                 "  --stats[=json]  print timings and counters of each phase to stderr, as a summary or JSON\n"
+                 "  --trace <file>  write a Chrome trace event file of the load and query, for Perfetto\n";
     return 1;
 }
 
-std::string issueTitle(simdjson::dom::object issue)
-{
-    return std::string{issue.at_key("series name").get_string().value()} + " #" +
-        std::string{issue.at_key("issue number").get_string().value()};
-}
-
-void printSequence(std::ostream &str, simdjson::dom::object sequence)
+comics::coroutine::CreditField creditField(std::string_view option)
 {
-    const auto printField = [&](const std::string_view key)
-        {
-            const auto it = std::find_if(sequence.begin(), sequence.end(),
-                [=](const simdjson::dom::key_value_pair &item) { return item.key == key; });
-            if (it == sequence.end())
-            {
-                // field might not be present
-                return;
-            }
-            const simdjson::simdjson_result<simdjson::dom::element> field = sequence.at_key(key);
-            if (key.length() > 18)
-            {
-                throw std::runtime_error("Field " + std::string{key} + " too long");
-            }
-            str << std::string(18 - key.length(), ' ') << key << ": ";
-            if (field.is_string())
-            {
-                str << field.get_string().value() << '\n';
-            }
-            else if (field.is_bool())
-            {
-                str << (field.get_bool().value() ? "true\n" : "false\n");
-            }
-            else if (field.is_number())
-            {
-                str << field.get_int64() << '\n';
-            }
-            else
-            {
-                std::ostringstream fieldType;
-                fieldType << field.type();
-                throw std::runtime_error("Unknown type for field '" + std::string{key} + "', got " + fieldType.str());
-            }
-        };
-    printField("title");
-    printField("feature");
-    printField("script");
-    printField("pencils");
-    printField("inks");
-    printField("colors");
-}
-
-void printMatch(std::ostream &str, comics::coroutine::SequenceMatch match)
-{
-    static std::string lastTitle{};
-
-    if (const std::string title{issueTitle(match.issue)}; lastTitle != title)
+    if (option == "-s")
+    {
+        return comics::coroutine::CreditField::SCRIPT;
+    }
+    if (option == "-p")
+    {
+        return comics::coroutine::CreditField::PENCIL;
+    }
+    if (option == "-i")
+    {
+        return comics::coroutine::CreditField::INK;
+    }
+    if (option == "-c")
+    {
+        return comics::coroutine::CreditField::COLOR;
+    }
+    if (option == "-l")
     {
-        str << title << '\n';
-        lastTitle = title;
+        return comics::coroutine::CreditField::LETTER;
     }
-    printSequence(str, match.sequence);
+    return comics::coroutine::CreditField::NONE;
 }
 
-void printMatches(std::ostream &str, comics::coroutine::DatabasePtr db, comics::coroutine::CreditField field, std::string_view name)
+std::vector<std::string> readNames(const std::string &path)
 {
-    comics::coroutine::MatchGenerator coro{matches(db, field, name)};
-    bool first{true};
-    while (coro.resume())
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Couldn't open " + path);
+    }
+    std::vector<std::string> names;
+    std::string line;
+    while (std::getline(file, line))
     {
-        if (!first)
+        if (!line.empty() && line.back() == '\r')
         {
-            str << '\n';
+            line.pop_back();
+        }
+        if (!line.empty())
+        {
+            names.push_back(line);
         }
-        printMatch(str, coro.getMatch());
-        first = false;
     }
+    return names;
 }
 
 } // namespace
 
 int main(int argc, char *argv[])
 {
-    if (argc != 4)
+    if (argc < 4)
     {
         return usage(argv[0]);
     }
-    try
+    comics::MatchMode mode{comics::MatchMode::SUBSTRING};
+    comics::MatchOrder order{comics::MatchOrder::SCAN};
+    comics::DatabaseOptions options;
+    comics::QueryStats stats;
+    std::string_view statsFormat;
+    comics::TraceRecorder trace;
+    std::string tracePath;
+    comics::coroutine::Combine combine{comics::coroutine::Combine::ALL};
+    std::vector<comics::coroutine::CreditPredicate> predicates;
+    // the options and names of the predicates, for listing those a match hit
+    std::vector<std::string> labels;
+    std::string namesFile;
+    std::size_t batch{1};
+    for (int i = 2; i < argc; ++i)
     {
-        std::shared_ptr db{comics::coroutine::createDatabase(argv[1])};
-        const std::string_view option{argv[2]};
-        const std::string_view name{argv[3]};
-        comics::coroutine::CreditField field{comics::coroutine::CreditField::NONE};
-        if (option == "-s")
+        const std::string_view arg{argv[i]};
+        if (arg == "-x")
         {
-            field = comics::coroutine::CreditField::SCRIPT;
+            mode = comics::MatchMode::CREATOR;
         }
-        else if (option == "-p")
+        else if (arg == "-f")
         {
-            field = comics::coroutine::CreditField::PENCIL;
+            mode = comics::MatchMode::FOLDED;
         }
-        else if (option == "-i")
+        else if (arg == "-o")
         {
-            field = comics::coroutine::CreditField::INK;
+            order = comics::MatchOrder::SEQUENCE;
         }
-        else if (option == "-c")
+        else if (arg == "-t")
         {
-            field = comics::coroutine::CreditField::COLOR;
+            options.trigramIndex = true;
+        }
+        else if (arg == "--stats" || arg == "--stats=json")
+        {
+            options.stats = &stats;
+            statsFormat = arg;
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            const std::string_view value{argv[++i]};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), options.threads);
+            if (ec != std::errc{} || end != value.data() + value.size() || options.threads == 0)
+            {
+                return usage(argv[0]);
+            }
+        }
+        else if (arg == "--batch" && i + 1 < argc)
+        {
+            const std::string_view value{argv[++i]};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), batch);
+            if (ec != std::errc{} || end != value.data() + value.size() || batch == 0)
+            {
+                return usage(argv[0]);
+            }
+        }
+        else if (arg == "--memory-budget" && i + 1 < argc)
+        {
+            const std::string_view value{argv[++i]};
+            std::size_t megabytes{};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), megabytes);
+            if (ec != std::errc{} || end != value.data() + value.size() || megabytes == 0)
+            {
+                return usage(argv[0]);
+            }
+            options.memoryBudget = megabytes << 20;
+        }
+        else if (arg == "--cache" && i + 1 < argc)
+        {
+            options.cachePath = argv[++i];
+        }
+        else if (arg == "--cache-size" && i + 1 < argc)
+        {
+            const std::string_view value{argv[++i]};
+            std::size_t megabytes{};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), megabytes);
+            if (ec != std::errc{} || end != value.data() + value.size() || megabytes == 0)
+            {
+                return usage(argv[0]);
+            }
+            options.cacheBytes = megabytes << 20;
+        }
+        else if (arg == "--any")
+        {
+            combine = comics::coroutine::Combine::ANY;
+        }
+        else if (predicates.empty() && i + 2 < argc && std::string_view{argv[i + 1]} == "--names")
+        {
+            predicates.push_back({creditField(arg), {}});
+            namesFile = argv[i + 2];
+            i += 2;
+        }
+        else if (namesFile.empty() && i + 1 < argc)
+        {
+            predicates.push_back({creditField(arg), argv[i + 1]});
+            labels.push_back(std::string{arg} + ' ' + argv[i + 1]);
+            ++i;
         }
         else
         {
             return usage(argv[0]);
         }
-        printMatches(std::cout, db, field, name);
+    }
+    if (predicates.empty()
+        || std::any_of(predicates.begin(), predicates.end(),
+            [](const comics::coroutine::CreditPredicate &predicate)
+            { return predicate.field == comics::coroutine::CreditField::NONE; }))
+    {
+        return usage(argv[0]);
+    }
+    if (!options.cachePath.empty() && options.cacheBytes == 0)
+    {
+        options.cacheBytes = DEFAULT_CACHE_MIB << 20;
+    }
+    // all output goes through std::cout, so it needn't stay in step with C stdio
+    std::ios_base::sync_with_stdio(false);
+    if (!tracePath.empty())
+    {
+        comics::TraceRecorder::setActive(&trace);
+    }
+    try
+    {
+        std::shared_ptr db{comics::coroutine::createDatabase(argv[1], options)};
+        if (!namesFile.empty())
+        {
+            const std::vector<std::string> lines{readNames(namesFile)};
+            const std::vector<std::string_view> names(lines.begin(), lines.end());
+            comics::coroutine::MatchGenerator coro{matches(db, predicates.front().field, names, mode, order)};
+            comics::coroutine::MatchPrinter{*db}.printAll(std::cout, coro, names, batch);
+        }
+        else if (predicates.size() == 1)
+        {
+            comics::coroutine::MatchGenerator coro{
+                matches(db, predicates.front().field, predicates.front().name, mode, order)};
+            comics::coroutine::MatchPrinter{*db}.printAll(std::cout, coro, {}, batch);
+        }
+        else
+        {
+            const std::vector<std::string_view> names(labels.begin(), labels.end());
+            comics::coroutine::MatchGenerator coro{matches(db, predicates, combine, mode, order)};
+            comics::coroutine::MatchPrinter{*db}.printAll(std::cout, coro, names, batch);
+        }
+        if (options.stats != nullptr)
+        {
+            // the matches go first, so the stats follow them when both streams go to a terminal
+            std::cout.flush();
+            if (statsFormat == "--stats=json")
+            {
+                comics::printStatsJSON(std::cerr, stats);
+            }
+            else
+            {
+                comics::printStats(std::cerr, stats);
+            }
+        }
+        if (!tracePath.empty())
+        {
+            comics::TraceRecorder::setActive(nullptr);
+            std::ofstream file(tracePath);
+            trace.writeChromeTrace(file);
+            if (!file)
+            {
+                throw std::runtime_error("Couldn't write trace " + tracePath);
+            }
+        }
     }
     catch (const std::exception &bang)
     {
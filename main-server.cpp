@@ -0,0 +1,243 @@
+#include <comics/coro.h>
+#include <comics/query-server.h>
+
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+constexpr std::size_t DEFAULT_CACHE_MIB{64};
+
+int usage(const char *program)
+{
+    std::cerr << "Usage: " << program
+              << " <jsondir> [-t] [-f] [--threads N] [--cache <file>] [--cache-size MiB] [--socket <path>]\n"
+                 "  -t  build a trigram index to answer substring queries\n"
+                 "  -f  fold the credits for case and accent insensitive queries at load\n"
+                 "  --threads N  split scans of the sequences across N threads\n"
+                 "  --cache <file>  keep the results of queries in the file, so repeating a query skips the scan\n"
+                 "  --cache-size MiB  keep up to this many MiB of query results, 64 by default\n"
+                 "  --socket <path>  accept queries on a Unix domain socket instead of standard input\n"
+                 "Each query is a line \"[-x|-f] (-s|-p|-i|-c|-l) <name>\"; each response ends with a line \".\".\n"
+                 "  -x  match whole creator names, ignoring case and credit annotations\n"
+                 "  -f  match ignoring case and accents\n";
+    return 1;
+}
+
+#ifndef _WIN32
+// Buffered stream over a connected socket, so responses are written as the scan finds matches.
+class SocketBuf : public std::streambuf
+{
+public:
+    explicit SocketBuf(int fd) :
+        m_fd(fd)
+    {
+        setg(m_in, m_in, m_in);
+        setp(m_out, m_out + sizeof(m_out));
+    }
+    ~SocketBuf() override
+    {
+        sync();
+        ::close(m_fd);
+    }
+
+protected:
+    int_type underflow() override
+    {
+        const ssize_t count{::read(m_fd, m_in, sizeof(m_in))};
+        if (count <= 0)
+        {
+            return traits_type::eof();
+        }
+        setg(m_in, m_in, m_in + count);
+        return traits_type::to_int_type(*gptr());
+    }
+    int_type overflow(int_type c) override
+    {
+        if (sync() != 0)
+        {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    int sync() override
+    {
+        for (const char *pos = pbase(); pos < pptr();)
+        {
+            const ssize_t count{::write(m_fd, pos, static_cast<std::size_t>(pptr() - pos))};
+            if (count <= 0)
+            {
+                return -1;
+            }
+            pos += count;
+        }
+        setp(m_out, m_out + sizeof(m_out));
+        return 0;
+    }
+
+private:
+    int m_fd;
+    char m_in[4096];
+    char m_out[64 * 1024];
+};
+
+void serveSocket(const std::string &path, const comics::coroutine::DatabasePtr &db)
+{
+    // a client that disconnects mid-response only fails its own writes
+    std::signal(SIGPIPE, SIG_IGN);
+    const int listener{::socket(AF_UNIX, SOCK_STREAM, 0)};
+    if (listener < 0)
+    {
+        throw std::runtime_error("Couldn't create socket");
+    }
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("Socket path " + path + " is too long");
+    }
+    path.copy(address.sun_path, path.size());
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0)
+    {
+        ::close(listener);
+        throw std::runtime_error("Couldn't listen on " + path);
+    }
+    std::cout << "Listening on " << path << '\n' << std::flush;
+    for (;;)
+    {
+        const int client{::accept(listener, nullptr, nullptr)};
+        if (client < 0)
+        {
+            continue;
+        }
+        // the database is shared read-only, so each client is served on its own thread
+        std::thread(
+            [client, db]
+            {
+                SocketBuf buffer{client};
+                std::iostream stream{&buffer};
+                comics::coroutine::serveQueries(stream, stream, db);
+                // the server runs until it is killed, so save what the client's queries found
+                if (comics::QueryCache *cache = db->getQueryCache())
+                {
+                    try
+                    {
+                        cache->save();
+                    }
+                    catch (const std::exception &bang)
+                    {
+                        std::cerr << "Couldn't save query cache: " << bang.what() << '\n';
+                    }
+                }
+            })
+            .detach();
+    }
+}
+#endif
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        return usage(argv[0]);
+    }
+    comics::DatabaseOptions options;
+    std::string socketPath;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string_view arg{argv[i]};
+        if (arg == "-t")
+        {
+            options.trigramIndex = true;
+        }
+        else if (arg == "-f")
+        {
+            options.foldCredits = true;
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            const std::string_view value{argv[++i]};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), options.threads);
+            if (ec != std::errc{} || end != value.data() + value.size() || options.threads == 0)
+            {
+                return usage(argv[0]);
+            }
+        }
+        else if (arg == "--cache" && i + 1 < argc)
+        {
+            options.cachePath = argv[++i];
+        }
+        else if (arg == "--cache-size" && i + 1 < argc)
+        {
+            const std::string_view value{argv[++i]};
+            std::size_t megabytes{};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), megabytes);
+            if (ec != std::errc{} || end != value.data() + value.size() || megabytes == 0)
+            {
+                return usage(argv[0]);
+            }
+            options.cacheBytes = megabytes << 20;
+        }
+        else if (arg == "--socket" && i + 1 < argc)
+        {
+            socketPath = argv[++i];
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+    if (!options.cachePath.empty() && options.cacheBytes == 0)
+    {
+        options.cacheBytes = DEFAULT_CACHE_MIB << 20;
+    }
+    try
+    {
+        const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(argv[1], options)};
+        if (socketPath.empty())
+        {
+            comics::coroutine::serveQueries(std::cin, std::cout, db);
+        }
+        else
+        {
+#ifdef _WIN32
+            throw std::runtime_error("Unix domain sockets aren't supported on this platform");
+#else
+            serveSocket(socketPath, db);
+#endif
+        }
+    }
+    catch (const std::exception &bang)
+    {
+        std::cerr << "Unexpected exception: " << bang.what() << '\n';
+        return 2;
+    }
+    catch (...)
+    {
+        return 3;
+    }
+
+    return 0;
+}
@@ -1,15 +1,34 @@
+#include <charconv>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 
 #include <comics/comics.h>
+#include <comics/stats.h>
+#include <comics/trace.h>
 
 namespace
 {
 
+constexpr std::size_t DEFAULT_CACHE_MIB{64};
+
 int usage(const char *program)
 {
     std::cerr << "Usage: " << program
-              << " <jsondir> (-s <script writer name>|-p <penciler name>|-i <inker name>|-c <colorist name>)\n";
+              << " <jsondir> [-x|-f] [-t] [--threads N] [--cache <file>] [--cache-size MiB]\n"
+                 "    [--stats[=json]] [--trace <file>]\n"
+                 "    (-s <script writer name>|-p <penciler name>|-i <inker name>|-c <colorist name>|\n"
+                 "     -l <letterer name>)\n"
+                 "  -x  match whole creator names, ignoring case and credit annotations\n"
+                 "  -f  match ignoring case and accents\n"
+                 "  -t  build a trigram index to answer substring queries\n"
+                 "  --threads N  split scans of the sequences across N threads\n"
+                 "  --cache <file>  keep the results of queries in the file, so repeating a query skips the scan\n"
+                 "  --cache-size MiB  keep up to this many MiB of query results, 64 by default\n"
+                 "  --stats[=json]  print timings and counters of each phase to stderr, as a summary or JSON\n"
+                 "  --trace <file>  write a Chrome trace event file of the load and query, for Perfetto\n";
     return 1;
 }
 
@@ -17,15 +36,90 @@ int usage(const char *program)
 
 int main(int argc, char *argv[])
 {
-    if (argc != 4)
+    if (argc < 4)
     {
         return usage(argv[0]);
     }
+    comics::MatchMode mode{comics::MatchMode::SUBSTRING};
+    comics::DatabaseOptions options;
+    comics::QueryStats stats;
+    std::string_view statsFormat;
+    comics::TraceRecorder trace;
+    std::string tracePath;
+    std::string option;
+    std::string name;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string_view arg{argv[i]};
+        if (arg == "-x")
+        {
+            mode = comics::MatchMode::CREATOR;
+        }
+        else if (arg == "-f")
+        {
+            mode = comics::MatchMode::FOLDED;
+        }
+        else if (arg == "-t")
+        {
+            options.trigramIndex = true;
+        }
+        else if (arg == "--stats" || arg == "--stats=json")
+        {
+            options.stats = &stats;
+            statsFormat = arg;
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            const std::string_view value{argv[++i]};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), options.threads);
+            if (ec != std::errc{} || end != value.data() + value.size() || options.threads == 0)
+            {
+                return usage(argv[0]);
+            }
+        }
+        else if (arg == "--cache" && i + 1 < argc)
+        {
+            options.cachePath = argv[++i];
+        }
+        else if (arg == "--cache-size" && i + 1 < argc)
+        {
+            const std::string_view value{argv[++i]};
+            std::size_t megabytes{};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), megabytes);
+            if (ec != std::errc{} || end != value.data() + value.size() || megabytes == 0)
+            {
+                return usage(argv[0]);
+            }
+            options.cacheBytes = megabytes << 20;
+        }
+        else if (option.empty() && i + 1 < argc)
+        {
+            option = arg;
+            name = argv[++i];
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+    if (!options.cachePath.empty() && options.cacheBytes == 0)
+    {
+        options.cacheBytes = DEFAULT_CACHE_MIB << 20;
+    }
+    // all output goes through std::cout, so it needn't stay in step with C stdio
+    std::ios_base::sync_with_stdio(false);
+    if (!tracePath.empty())
+    {
+        comics::TraceRecorder::setActive(&trace);
+    }
     try
     {
-        std::shared_ptr db{comics::createDatabase(argv[1])};
-        const std::string option{argv[2]};
-        const std::string name{argv[3]};
+        std::shared_ptr db{comics::createDatabase(argv[1], options)};
+        db->setMatchMode(mode);
         if (option == "-s")
         {
             db->printScriptSequences(std::cout, name);
@@ -42,10 +136,37 @@ int main(int argc, char *argv[])
         {
             db->printColorSequences(std::cout, name);
         }
+        else if (option == "-l")
+        {
+            db->printLetterSequences(std::cout, name);
+        }
         else
         {
             return usage(argv[0]);
         }
+        if (options.stats != nullptr)
+        {
+            // the matches go first, so the stats follow them when both streams go to a terminal
+            std::cout.flush();
+            if (statsFormat == "--stats=json")
+            {
+                comics::printStatsJSON(std::cerr, stats);
+            }
+            else
+            {
+                comics::printStats(std::cerr, stats);
+            }
+        }
+        if (!tracePath.empty())
+        {
+            comics::TraceRecorder::setActive(nullptr);
+            std::ofstream file(tracePath);
+            trace.writeChromeTrace(file);
+            if (!file)
+            {
+                throw std::runtime_error("Couldn't write trace " + tracePath);
+            }
+        }
     }
     catch (const std::exception &bang)
     {
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// Empty directory for the files of a test, removed with them when destroyed.  It is named after the
+// running test and the process, so tests run in parallel processes by ctest -j never share one.
+class ScratchDir
+{
+public:
+    ScratchDir() :
+        m_path(std::filesystem::temp_directory_path() / uniqueName())
+    {
+        std::filesystem::remove_all(m_path);
+        std::filesystem::create_directories(m_path);
+    }
+    ~ScratchDir()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(m_path, ec);
+    }
+    ScratchDir(const ScratchDir &) = delete;
+    ScratchDir &operator=(const ScratchDir &) = delete;
+
+    const std::filesystem::path &path() const
+    {
+        return m_path;
+    }
+    std::filesystem::path operator/(std::string_view name) const
+    {
+        return m_path / name;
+    }
+    // Write a file in the directory, returning its path.
+    std::filesystem::path write(std::string_view name, std::string_view text) const
+    {
+        const std::filesystem::path path{m_path / name};
+        std::ofstream(path) << text;
+        return path;
+    }
+
+private:
+    static std::string uniqueName()
+    {
+        // a test may use more than one directory
+        static unsigned count{};
+#ifdef _WIN32
+        const int pid{_getpid()};
+#else
+        const int pid{static_cast<int>(::getpid())};
+#endif
+        std::string name{"test-comics"};
+        if (const ::testing::TestInfo *test = ::testing::UnitTest::GetInstance()->current_test_info())
+        {
+            name += '-';
+            name += test->test_suite_name();
+            name += '-';
+            name += test->name();
+        }
+        name += '-' + std::to_string(pid) + '-' + std::to_string(count++);
+        // parameterized tests are named Prefix/Suite.name/index
+        for (char &c : name)
+        {
+            if (c == '/')
+            {
+                c = '-';
+            }
+        }
+        return name;
+    }
+
+    std::filesystem::path m_path;
+};
@@ -3,8 +3,13 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "scratch-dir.h"
+
+#include <cstdint>
+#include <filesystem>
 #include <ostream>
 #include <string_view>
+#include <vector>
 
 using namespace testing;
 
@@ -177,6 +182,27 @@ inline MockDatabasePtr createMockDatabase()
     return std::make_shared<MockDatabase>();
 }
 
+// The issues and sequences written as JSON files, for tests of databases with tables and indexes.
+class JSONDir : public ScratchDir
+{
+public:
+    JSONDir()
+    {
+        write("issues.json", ISSUES);
+        write("sequences.json", SEQUENCES);
+    }
+};
+
+std::vector<std::size_t> matchedRows(comics::coroutine::MatchGenerator &coro)
+{
+    std::vector<std::size_t> rows;
+    while (coro.resume())
+    {
+        rows.push_back(coro.getMatch().sequenceRow);
+    }
+    return rows;
+}
+
 TEST(TestComicsCoroutine, construct)
 {
     comics::coroutine::MatchGenerator coro{matches(nullptr, comics::coroutine::CreditField::SCRIPT, SCRIPT_NAME)};
@@ -240,3 +266,186 @@ TEST(TestComicsCoroutine, notResumableFromOnlyMatch)
     EXPECT_EQ("1", match.issue.at_key("issue number").get_string().value());
     EXPECT_NE(std::string::npos, match.sequence.at_key("letters").get_string().value().find(LETTERS_NAME_ONE_MATCH));
 }
+
+TEST(TestComicsCoroutine, findIssueScansIssuesByDefault)
+{
+    MockDatabasePtr db{createMockDatabase()};
+    ParsedJson issues{ISSUES};
+    EXPECT_CALL(*db, getIssues()).WillOnce(Return(issues.m_document));
+
+    const simdjson::dom::object issue{db->findIssue(17568)};
+
+    EXPECT_EQ("The Amazing Spider-Man", issue.at_key("series name").get_string().value());
+}
+
+TEST(TestComicsCoroutine, creatorModeMatchesWholeNamesWithoutIndex)
+{
+    MockDatabasePtr db{createMockDatabase()};
+    ParsedJson issues{ISSUES};
+    ParsedJson sequences{SEQUENCES};
+    EXPECT_CALL(*db, getSequences()).WillOnce(Return(sequences.m_document));
+    EXPECT_CALL(*db, getIssues()).WillOnce(Return(issues.m_document));
+    comics::coroutine::MatchGenerator coro{
+        matches(db, comics::coroutine::CreditField::LETTER, "john duffy", comics::MatchMode::CREATOR)};
+
+    const bool firstValue{coro.resume()};
+    const comics::coroutine::SequenceMatch match{coro.getMatch()};
+    const bool secondValue{coro.resume()};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_FALSE(secondValue);
+    EXPECT_EQ("2", match.sequence.at_key("sequence_number").get_string().value());
+}
+
+TEST(TestComicsCoroutine, batchTagsMatchesWithNames)
+{
+    MockDatabasePtr db{createMockDatabase()};
+    ParsedJson issues{ISSUES};
+    ParsedJson sequences{SEQUENCES};
+    EXPECT_CALL(*db, getSequences()).WillOnce(Return(sequences.m_document));
+    EXPECT_CALL(*db, getIssues()).WillRepeatedly(Return(issues.m_document));
+    const std::vector<std::string_view> names{NO_MATCHING_SCRIPT_NAME, "Jack Kirby", "Steve Ditko"};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::PENCIL, names)};
+
+    std::vector<std::vector<std::uint32_t>> tags;
+    while (coro.resume())
+    {
+        tags.push_back(coro.getMatch().names);
+    }
+
+    const std::vector<std::vector<std::uint32_t>> expected{{1}, {1}, {1}, {1}, {2}, {2}};
+    EXPECT_EQ(expected, tags);
+}
+
+TEST(TestComicsCoroutine, batchCreatorModeMatchesWholeNames)
+{
+    MockDatabasePtr db{createMockDatabase()};
+    ParsedJson issues{ISSUES};
+    ParsedJson sequences{SEQUENCES};
+    EXPECT_CALL(*db, getSequences()).WillOnce(Return(sequences.m_document));
+    EXPECT_CALL(*db, getIssues()).WillRepeatedly(Return(issues.m_document));
+    const std::vector<std::string_view> names{"george klein", "Sol Brodsky", "Sol"};
+    comics::coroutine::MatchGenerator coro{
+        matches(db, comics::coroutine::CreditField::INK, names, comics::MatchMode::CREATOR)};
+
+    const bool firstValue{coro.resume()};
+    const std::vector<std::uint32_t> first{coro.getMatch().names};
+    const bool secondValue{coro.resume()};
+    const std::vector<std::uint32_t> second{coro.getMatch().names};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_TRUE(secondValue);
+    EXPECT_EQ((std::vector<std::uint32_t>{0}), first);
+    EXPECT_EQ((std::vector<std::uint32_t>{0, 1}), second);
+}
+
+TEST(TestComicsCoroutine, predicatesMatchAllFields)
+{
+    MockDatabasePtr db{createMockDatabase()};
+    ParsedJson issues{ISSUES};
+    ParsedJson sequences{SEQUENCES};
+    EXPECT_CALL(*db, getSequences()).WillOnce(Return(sequences.m_document));
+    EXPECT_CALL(*db, getIssues()).WillOnce(Return(issues.m_document));
+    const std::vector<comics::coroutine::CreditPredicate> predicates{
+        {comics::coroutine::CreditField::PENCIL, PENCIL_NAME}, {comics::coroutine::CreditField::INK, INK_NAME}};
+    comics::coroutine::MatchGenerator coro{matches(db, predicates)};
+
+    const bool firstValue{coro.resume()};
+    const comics::coroutine::SequenceMatch match{coro.getMatch()};
+    const bool secondValue{coro.resume()};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_FALSE(secondValue);
+    EXPECT_EQ("The Chameleon Strikes!", match.sequence.at_key("title").get_string().value());
+    EXPECT_TRUE(match.names.empty());
+}
+
+TEST(TestComicsCoroutine, predicatesMatchAnyFieldTaggingPredicates)
+{
+    MockDatabasePtr db{createMockDatabase()};
+    ParsedJson issues{ISSUES};
+    ParsedJson sequences{SEQUENCES};
+    EXPECT_CALL(*db, getSequences()).WillOnce(Return(sequences.m_document));
+    EXPECT_CALL(*db, getIssues()).WillOnce(Return(issues.m_document));
+    const std::vector<comics::coroutine::CreditPredicate> predicates{
+        {comics::coroutine::CreditField::PENCIL, INK_NAME},
+        {comics::coroutine::CreditField::LETTER, LETTERS_NAME_ONE_MATCH}};
+    comics::coroutine::MatchGenerator coro{matches(db, predicates, comics::coroutine::Combine::ANY)};
+
+    std::vector<std::vector<std::uint32_t>> tags;
+    while (coro.resume())
+    {
+        tags.push_back(coro.getMatch().names);
+    }
+
+    const std::vector<std::vector<std::uint32_t>> expected{{0}, {0, 1}};
+    EXPECT_EQ(expected, tags);
+}
+
+TEST(TestComicsCoroutine, creatorPredicatesIntersectPostingLists)
+{
+    const JSONDir dir;
+    comics::QueryStats stats;
+    comics::DatabaseOptions options;
+    options.stats = &stats;
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path(), options)};
+    const std::vector<comics::coroutine::CreditPredicate> predicates{
+        {comics::coroutine::CreditField::PENCIL, "jack kirby"}, {comics::coroutine::CreditField::INK, "sol brodsky"}};
+    const std::vector<comics::coroutine::CreditPredicate> scanned{
+        {comics::coroutine::CreditField::PENCIL, PENCIL_NAME}, {comics::coroutine::CreditField::INK, "Sol Brodsky"}};
+    comics::coroutine::MatchGenerator indexed{
+        matches(db, predicates, comics::coroutine::Combine::ALL, comics::MatchMode::CREATOR)};
+    comics::coroutine::MatchGenerator scan{matches(db, scanned)};
+
+    const std::vector<std::size_t> indexedRows{matchedRows(indexed)};
+    const std::uint64_t indexedRecords{stats.recordsScanned.load()};
+    const std::vector<std::size_t> scanRows{matchedRows(scan)};
+
+    EXPECT_EQ((std::vector<std::size_t>{1, 2}), indexedRows);
+    EXPECT_EQ(indexedRows, scanRows);
+    EXPECT_EQ(2U, indexedRecords);
+}
+
+TEST(TestComicsCoroutine, substringPredicatesCheckTrigramCandidates)
+{
+    const JSONDir dir;
+    comics::QueryStats stats;
+    comics::DatabaseOptions options;
+    options.trigramIndex = true;
+    options.stats = &stats;
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path(), options)};
+    const std::vector<comics::coroutine::CreditPredicate> predicates{
+        {comics::coroutine::CreditField::SCRIPT, SCRIPT_NAME}, {comics::coroutine::CreditField::LETTER, "Artie Simek"}};
+    comics::coroutine::MatchGenerator coro{matches(db, predicates)};
+
+    const std::vector<std::size_t> rows{matchedRows(coro)};
+
+    EXPECT_EQ((std::vector<std::size_t>{0, 1, 2, 3}), rows);
+    EXPECT_EQ(4U, stats.recordsScanned.load());
+}
+
+TEST(TestComicsCoroutine, anyPredicatesScanColumnsInParallel)
+{
+    const JSONDir dir;
+    comics::DatabaseOptions options;
+    options.threads = 2;
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path(), options)};
+    const std::vector<comics::coroutine::CreditPredicate> predicates{
+        {comics::coroutine::CreditField::PENCIL, INK_NAME},
+        {comics::coroutine::CreditField::LETTER, LETTERS_NAME_ONE_MATCH}};
+    comics::coroutine::MatchGenerator coro{matches(db, predicates, comics::coroutine::Combine::ANY,
+        comics::MatchMode::SUBSTRING, comics::MatchOrder::SEQUENCE)};
+
+    std::vector<std::size_t> rows;
+    std::vector<std::vector<std::uint32_t>> tags;
+    while (coro.resume())
+    {
+        const comics::coroutine::SequenceMatch match{coro.getMatch()};
+        rows.push_back(match.sequenceRow);
+        tags.push_back(match.names);
+    }
+
+    const std::vector<std::vector<std::uint32_t>> expected{{0}, {0, 1}};
+    EXPECT_EQ((std::vector<std::size_t>{4, 5}), rows);
+    EXPECT_EQ(expected, tags);
+}
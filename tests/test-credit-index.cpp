@@ -0,0 +1,72 @@
+#include <comics/credit-index.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+TEST(TestCreditIndex, normalizesCreatorNames)
+{
+    EXPECT_EQ("jack kirby", comics::normalizeCreator("  Jack   Kirby "));
+    EXPECT_EQ("sol brodsky", comics::normalizeCreator("Sol Brodsky ?"));
+    EXPECT_EQ("", comics::normalizeCreator("?"));
+}
+
+TEST(TestCreditIndex, splitsCreditsDroppingAnnotations)
+{
+    std::vector<std::string> names;
+
+    comics::creatorNames(names,
+        "Stan Lee (signed as Stan Lee [early- to mid-career]); Will Eisner [as Moebius]; Sol Brodsky ? (see notes); ?");
+
+    EXPECT_THAT(names, ElementsAre("stan lee", "will eisner", "sol brodsky"));
+}
+
+TEST(TestCreditIndex, creditsNameMatchesWholeCreators)
+{
+    EXPECT_TRUE(comics::creditsName("George Klein; Sol Brodsky ? (see notes)", "sol brodsky"));
+    EXPECT_FALSE(comics::creditsName("Stan Goldberg [as Stan Lee]", "stan lee"));
+    EXPECT_FALSE(comics::creditsName("Stan Lee", "stan"));
+}
+
+TEST(TestPostingList, roundTripsAscendingRows)
+{
+    comics::PostingList list;
+    const std::vector<std::uint32_t> rows{0, 1, 127, 128, 16384, 2000000000};
+
+    for (const std::uint32_t row : rows)
+    {
+        list.append(row);
+    }
+    list.append(2000000000);
+
+    EXPECT_EQ(rows.size(), list.size());
+    EXPECT_THAT(std::vector<std::uint32_t>(list.begin(), list.end()), ElementsAreArray(rows));
+}
+
+TEST(TestPostingList, rejectsDescendingRows)
+{
+    comics::PostingList list;
+    list.append(5);
+
+    EXPECT_THROW(list.append(4), std::runtime_error);
+}
+
+TEST(TestCreditIndex, findsRowsByCreator)
+{
+    comics::CreditIndex index;
+    index.add(0, "Stan Lee");
+    index.add(1, "Stan Lee (signed as Stan Lee [early- to mid-career])");
+    index.add(2, "Stan Goldberg [as Stan Lee]");
+    index.add(4, "Jack Kirby; stan  lee");
+
+    const comics::PostingList *rows = index.find("Stan Lee");
+
+    ASSERT_NE(nullptr, rows);
+    EXPECT_THAT(std::vector<std::uint32_t>(rows->begin(), rows->end()), ElementsAre(0, 1, 4));
+    EXPECT_EQ(nullptr, index.find("Stan"));
+    EXPECT_EQ(3U, index.creators());
+}
@@ -0,0 +1,109 @@
+#include <comics/dump-delta.h>
+#include <comics/gcd-converter.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+constexpr std::string_view OLD_DUMP{"\"1\"\t\"0\"\t\"script\"\t\"Stan Lee\"\n"
+                                    "\"1\"\t\"1\"\t\"script\"\t\"Jack Kirby\"\n"
+                                    "\"2\"\t\"0\"\t\"script\"\t\"Steve Ditko\"\n"};
+constexpr std::string_view NEW_DUMP{"\"1\"\t\"0\"\t\"script\"\t\"Stan Lee\"\n"
+                                    "\"1\"\t\"1\"\t\"script\"\t\"Jack \"\"King\"\" Kirby\"\n"
+                                    "\"3\"\t\"0\"\t\"script\"\t\"Gardner Fox\"\n"};
+
+std::string convert(std::string_view dump, comics::TableWriter &table, comics::RecordTracking *tracking)
+{
+    std::ostringstream json;
+    {
+        comics::OutputBuffer out{json};
+        comics::DumpConverter converter{comics::DumpKind::SEQUENCES, {}, out, &table};
+        if (tracking != nullptr)
+        {
+            converter.track(*tracking);
+        }
+        comics::convertDump(dump, converter, [](std::size_t) {});
+    }
+    return json.str();
+}
+
+// Convert the old dump and write it with its record list.
+void writeOldConversion(const ScratchDir &dir)
+{
+    comics::TableWriter table{comics::SEQUENCE_COLUMNS};
+    comics::RecordTracking tracking;
+    std::ofstream(dir / "sequences.json", std::ios::binary) << convert(OLD_DUMP, table, &tracking);
+    comics::writeSnapshot(dir / "sequences.snapshot", table.table());
+    comics::writeRecordList(
+        dir / "sequences.records", comics::RECORDS_SNAPSHOT, dir / "sequences.json", tracking.records);
+}
+
+} // namespace
+
+TEST(TestDumpDelta, hashDependsOnEveryByte)
+{
+    EXPECT_EQ(comics::hashRecord("\"1\"\t\"script\"\t\"Stan Lee\""), comics::hashRecord("\"1\"\t\"script\"\t\"Stan Lee\""));
+    EXPECT_NE(comics::hashRecord("\"1\"\t\"script\"\t\"Stan Lee\""), comics::hashRecord("\"1\"\t\"script\"\t\"Stan Lea\""));
+    EXPECT_NE(comics::hashRecord("abc"), comics::hashRecord(std::string_view{"abc\0", 4}));
+}
+
+TEST(TestDumpDelta, copiesUnchangedRecords)
+{
+    const ScratchDir dir;
+    writeOldConversion(dir);
+    const comics::PreviousConversion previous{dir / "sequences.records", dir / "sequences.json",
+        dir / "sequences.snapshot", comics::RECORDS_SNAPSHOT, comics::SEQUENCE_COLUMNS};
+    comics::RecordTracking tracking{&previous};
+    comics::TableWriter table{comics::SEQUENCE_COLUMNS};
+    comics::TableWriter fullTable{comics::SEQUENCE_COLUMNS};
+
+    const std::string json{convert(NEW_DUMP, table, &tracking)};
+    const std::string full{convert(NEW_DUMP, fullTable, nullptr)};
+    const comics::SequenceColumns columns{table.table()};
+
+    EXPECT_EQ(full, json);
+    EXPECT_EQ(1U, tracking.counts.unchanged);
+    EXPECT_EQ(1U, tracking.counts.changed);
+    EXPECT_EQ(1U, tracking.counts.added);
+    EXPECT_EQ(1U, previous.removed(tracking.records));
+    ASSERT_EQ(3U, table.rows());
+    EXPECT_EQ("Stan Lee", columns.script[0]);
+    EXPECT_EQ("Jack \"King\" Kirby", columns.script[1]);
+    EXPECT_EQ(3, columns.issue[2]);
+    ASSERT_EQ(3U, tracking.records.size());
+    EXPECT_EQ(comics::recordKey(1, 1), tracking.records[1].key);
+    EXPECT_EQ("{\n    \"issue\": \"3\",\n    \"script\": \"Gardner Fox\"\n}",
+        json.substr(tracking.records[2].offset, tracking.records[2].length));
+}
+
+TEST(TestDumpDelta, otherOptionsThrow)
+{
+    const ScratchDir dir;
+    writeOldConversion(dir);
+
+    EXPECT_THROW(comics::PreviousConversion(dir / "sequences.records", dir / "sequences.json",
+                     dir / "sequences.snapshot", comics::RECORDS_NDJSON, comics::SEQUENCE_COLUMNS),
+        std::runtime_error);
+}
+
+TEST(TestDumpDelta, rewrittenJSONThrows)
+{
+    const ScratchDir dir;
+    writeOldConversion(dir);
+    comics::TableWriter table{comics::SEQUENCE_COLUMNS};
+    std::ofstream(dir / "sequences.json", std::ios::binary) << convert(NEW_DUMP, table, nullptr);
+
+    EXPECT_THROW(comics::PreviousConversion(dir / "sequences.records", dir / "sequences.json",
+                     dir / "sequences.snapshot", comics::RECORDS_SNAPSHOT, comics::SEQUENCE_COLUMNS),
+        std::runtime_error);
+}
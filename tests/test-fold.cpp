@@ -0,0 +1,141 @@
+#include <comics/coro.h>
+#include <comics/fold.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+constexpr const char *ISSUES{R"iss([
+    { "id": "1", "series name": "Métal Hurlant" },
+    { "id": "2", "series name": "Epic Illustrated" }
+])iss"};
+
+constexpr const char *SEQUENCES{R"seq([
+    { "issue": "1", "sequence_number": "0", "script": "Jean Giraud (as Mœbius)" },
+    { "issue": "1", "sequence_number": "1", "script": "Philippe Druillet" },
+    { "issue": "2", "sequence_number": "0", "script": "MOEBIUS" },
+    { "issue": "2", "sequence_number": "1", "script": "Jack Kirby" }
+])seq"};
+
+std::vector<std::size_t> matchedRows(comics::coroutine::MatchGenerator &coro)
+{
+    std::vector<std::size_t> rows;
+    while (coro.resume())
+    {
+        rows.push_back(coro.getMatch().sequenceRow);
+    }
+    return rows;
+}
+
+} // namespace
+
+TEST(TestFold, foldsCaseAndAccents)
+{
+    EXPECT_EQ("jack kirby", comics::foldText("Jack KIRBY"));
+    EXPECT_EQ("moebius", comics::foldText("Mœbius"));
+    EXPECT_EQ("jose munoz", comics::foldText("José Muñoz"));
+    EXPECT_EQ("strasse", comics::foldText("Straße"));
+    EXPECT_EQ("lukasz", comics::foldText("Łukasz"));
+}
+
+TEST(TestFold, dropsCombiningMarks)
+{
+    // "é" spelled as "e" followed by a combining acute accent
+    EXPECT_EQ("jose", comics::foldText("Jose\xCC\x81"));
+}
+
+TEST(TestFold, foldsGreekAndCyrillicCase)
+{
+    EXPECT_EQ(comics::foldText("αθήνα"), comics::foldText("ΑΘΗΝΑ"));
+    EXPECT_EQ("иван", comics::foldText("ИВАН"));
+}
+
+TEST(TestFold, keepsOtherText)
+{
+    EXPECT_EQ("手塚治虫 (art) [1]", comics::foldText("手塚治虫 (art) [1]"));
+    EXPECT_EQ("a\xFF" "b", comics::foldText("A\xFF" "B"));
+}
+
+TEST(TestFold, foldedColumnKeepsAbsentRows)
+{
+    comics::TableWriter writer{{{"credit", comics::ColumnType::STRING}}};
+    writer.set(0, "Mœbius");
+    writer.endRow();
+    writer.endRow();
+    writer.set(0, "");
+    writer.endRow();
+    const comics::Table table{writer.table()};
+
+    const comics::FoldedColumn folded{table.stringColumn("credit")};
+    const comics::StringColumn column{folded.column()};
+
+    ASSERT_EQ(3U, column.size());
+    EXPECT_EQ("moebius", column[0]);
+    EXPECT_FALSE(column.present(1));
+    EXPECT_TRUE(column.present(2));
+    EXPECT_EQ("", column[2]);
+}
+
+TEST(TestFold, foldedMatchesScanFoldedColumn)
+{
+    const ScratchDir dir;
+    dir.write("issues.json", ISSUES);
+    dir.write("sequences.json", SEQUENCES);
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path())};
+    comics::coroutine::MatchGenerator exact{matches(db, comics::coroutine::CreditField::SCRIPT, "Moebius")};
+    comics::coroutine::MatchGenerator folded{
+        matches(db, comics::coroutine::CreditField::SCRIPT, "Moebius", comics::MatchMode::FOLDED)};
+
+    EXPECT_TRUE(matchedRows(exact).empty());
+    EXPECT_EQ((std::vector<std::size_t>{0, 2}), matchedRows(folded));
+}
+
+TEST(TestFold, foldedBatchMatchesTagNames)
+{
+    const ScratchDir dir;
+    dir.write("issues.json", ISSUES);
+    dir.write("sequences.json", SEQUENCES);
+    comics::DatabaseOptions options;
+    options.foldCredits = true;
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path(), options)};
+    const std::vector<std::string_view> names{"JACK", "mœbius"};
+    comics::coroutine::MatchGenerator coro{
+        matches(db, comics::coroutine::CreditField::SCRIPT, names, comics::MatchMode::FOLDED)};
+
+    std::vector<std::vector<std::uint32_t>> tags;
+    while (coro.resume())
+    {
+        tags.push_back(coro.getMatch().names);
+    }
+
+    const std::vector<std::vector<std::uint32_t>> expected{{1}, {1}, {0}};
+    EXPECT_EQ(expected, tags);
+}
+
+TEST(TestFold, foldedMatchesStreamedSequences)
+{
+    const ScratchDir dir;
+    dir.write("issues.ndjson", "{ \"id\": \"1\", \"series name\": \"Métal Hurlant\" }\n");
+    dir.write("sequences.ndjson",
+        "{ \"issue\": \"1\", \"script\": \"Jean Giraud (as Mœbius)\" }\n"
+        "{ \"issue\": \"1\", \"script\": \"Philippe Druillet\" }\n");
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path())};
+    comics::coroutine::MatchGenerator coro{
+        matches(db, comics::coroutine::CreditField::SCRIPT, "GIRAUD (AS MOEBIUS)", comics::MatchMode::FOLDED)};
+
+    const bool firstValue{coro.resume()};
+    const std::string script{coro.getMatch().sequence.at_key("script").get_string().value()};
+    const bool secondValue{coro.resume()};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_FALSE(secondValue);
+    EXPECT_EQ("Jean Giraud (as Mœbius)", script);
+}
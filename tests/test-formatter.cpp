@@ -0,0 +1,88 @@
+#include <comics/formatter.h>
+#include <comics/projection.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+constexpr std::string_view SEQUENCE{
+    R"([{ "issue": "1", "colors": "Stan Goldberg", "title": "Origin", "script": "Stan Lee", "notes": "x"}])"};
+
+constexpr std::string_view PRINTED{
+    "             title: Origin\n"
+    "            script: Stan Lee\n"
+    "            colors: Stan Goldberg\n"};
+
+} // namespace
+
+TEST(TestFormatter, buffersUntilFlushed)
+{
+    std::ostringstream str;
+    comics::OutputBuffer out{str, 8};
+
+    out << "abc" << '-' << std::int64_t{-42};
+    const std::string buffered{str.str()};
+    out << std::string_view{"0123456789"};
+    out << 'z';
+    out.flush();
+
+    EXPECT_EQ("", buffered);
+    EXPECT_EQ("abc--420123456789z", str.str());
+}
+
+TEST(TestFormatter, flushesOnDestruction)
+{
+    std::ostringstream str;
+    {
+        comics::OutputBuffer out{str};
+        out << "Fantastic Four #1\n";
+    }
+
+    EXPECT_EQ("Fantastic Four #1\n", str.str());
+}
+
+TEST(TestFormatter, formatsJSONSequence)
+{
+    simdjson::dom::parser parser;
+    const simdjson::dom::element records{parser.parse(SEQUENCE)};
+    std::ostringstream str;
+    {
+        comics::OutputBuffer out{str};
+        comics::formatSequence(out, records.at(0).get_object().value());
+    }
+
+    EXPECT_EQ(PRINTED, str.str());
+}
+
+TEST(TestFormatter, formatsColumnSequenceLikeJSON)
+{
+    simdjson::dom::parser parser;
+    comics::TableWriter writer{comics::SEQUENCE_COLUMNS};
+    comics::projectRecords(writer, comics::SEQUENCE_COLUMNS, parser.parse(SEQUENCE));
+    const comics::Table table{writer.table()};
+    const comics::SequenceColumns columns{table};
+    std::ostringstream str;
+    {
+        comics::OutputBuffer out{str};
+        comics::formatSequence(out, columns, 0);
+    }
+
+    EXPECT_EQ(PRINTED, str.str());
+}
+
+TEST(TestFormatter, unknownTypeThrows)
+{
+    simdjson::dom::parser parser;
+    const simdjson::dom::element records{parser.parse(std::string_view{R"([{ "title": ["Origin"]}])"})};
+    std::ostringstream str;
+    comics::OutputBuffer out{str};
+
+    EXPECT_THROW(comics::formatSequence(out, records.at(0).get_object().value()), std::runtime_error);
+}
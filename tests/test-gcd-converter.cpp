@@ -0,0 +1,166 @@
+#include <comics/gcd-converter.h>
+#include <comics/snapshot.h>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+std::string convert(std::string_view tsv, comics::DumpKind kind, const comics::ConvertOptions &options)
+{
+    std::ostringstream json;
+    {
+        comics::OutputBuffer out{json};
+        comics::DumpConverter converter{kind, options, out};
+        comics::convertDump(tsv, converter, [](std::size_t) {});
+    }
+    return json.str();
+}
+
+} // namespace
+
+TEST(TestGCDConverter, convertsIssueRecordsWithSortedKeys)
+{
+    const std::string json{convert("\"1\"\t\"series name\"\t\"Fantastic Four\"\n"
+                                   "\"1\"\t\"issue number\"\t\"1\"\n"
+                                   "\"2\"\t\"series name\"\t\"Journey into Mystery\"\n",
+        comics::DumpKind::ISSUES, {})};
+
+    EXPECT_EQ("[\n"
+              "{\n"
+              "    \"id\": \"1\",\n"
+              "    \"issue number\": \"1\",\n"
+              "    \"series name\": \"Fantastic Four\"\n"
+              "},\n"
+              "{\n"
+              "    \"id\": \"2\",\n"
+              "    \"series name\": \"Journey into Mystery\"\n"
+              "}\n"
+              "]\n",
+        json);
+}
+
+TEST(TestGCDConverter, groupsSequencesAndEscapesValues)
+{
+    const std::string json{convert("\"7\"\t\"1\"\t\"title\"\t\"a \"\"quote\"\"\\\t\"\n"
+                                   "\"7\"\t\"1\"\t\"reprint\"\t\"True\"\n"
+                                   "\"7\"\t\"1\"\t\"title\"\t\"replaced\\x\"\n"
+                                   "\"7\"\t\"2\"\t\"feature\"\t\"Thor\"",
+        comics::DumpKind::SEQUENCES, {true, true})};
+
+    EXPECT_EQ("{ \"issue\": \"7\", \"reprint\": true, \"title\": \"replaced\\\\x\"}\n"
+              "{ \"feature\": \"Thor\", \"issue\": \"7\"}\n",
+        json);
+}
+
+TEST(TestGCDConverter, escapesTabsAndDropsControlCharacters)
+{
+    const std::string json{
+        convert("\"1\"\t\"notes\"\t\"a\tb\x01\"\"c\"\"\"\n", comics::DumpKind::ISSUES, {true, true})};
+
+    EXPECT_EQ("{ \"id\": \"1\", \"notes\": \"a\\tb\\\"c\\\"\"}\n", json);
+}
+
+TEST(TestGCDConverter, fillsSnapshotTable)
+{
+    comics::TableWriter table{comics::SEQUENCE_COLUMNS};
+    std::ostringstream json;
+    {
+        comics::OutputBuffer out{json};
+        comics::DumpConverter converter{comics::DumpKind::SEQUENCES, {}, out, &table};
+        comics::convertDump("\"16556\"\t\"1\"\t\"sequence_number\"\t\"3\"\n"
+                            "\"16556\"\t\"1\"\t\"script\"\t\"Stan \"\"The Man\"\" Lee\"\n",
+            converter, [](std::size_t) {});
+    }
+    const comics::Table view{table.table()};
+    const comics::SequenceColumns columns{view};
+
+    ASSERT_EQ(1U, view.rows());
+    EXPECT_EQ(16556, columns.issue[0]);
+    EXPECT_EQ(3, columns.sequenceNumber[0]);
+    EXPECT_EQ("Stan \"The Man\" Lee", columns.script[0]);
+}
+
+TEST(TestGCDConverter, wrongFieldCountThrows)
+{
+    EXPECT_THROW(convert("\"1\"\t\"title\"\n", comics::DumpKind::SEQUENCES, {}), std::runtime_error);
+}
+
+TEST(TestGCDConverter, parsesLeadingIntLikeStoi)
+{
+    EXPECT_EQ(42, comics::parseLeadingInt(" +42abc"));
+    EXPECT_EQ(-7, comics::parseLeadingInt("-7"));
+    EXPECT_THROW(comics::parseLeadingInt("abc"), std::invalid_argument);
+    EXPECT_THROW(comics::parseLeadingInt("99999999999"), std::out_of_range);
+}
+
+TEST(TestGCDConverter, splitsDumpAtRecordBoundaries)
+{
+    const std::string_view tsv{"\"1\"\t\"a\"\t\"x\"\n"
+                               "\"1\"\t\"b\"\t\"y\"\n"
+                               "\"2\"\t\"a\"\t\"z\"\n"
+                               "\"3\"\t\"a\"\t\"w\"\n"};
+
+    const std::vector<std::string_view> parts{comics::splitDump(tsv, 1)};
+
+    ASSERT_EQ(3U, parts.size());
+    EXPECT_EQ("\"1\"\t\"a\"\t\"x\"\n\"1\"\t\"b\"\t\"y\"\n", parts[0]);
+    EXPECT_EQ("\"2\"\t\"a\"\t\"z\"\n", parts[1]);
+    EXPECT_EQ("\"3\"\t\"a\"\t\"w\"\n", parts[2]);
+}
+
+TEST(TestGCDConverter, parallelConversionMatchesSerial)
+{
+    std::string tsv;
+    for (int issue = 1; issue <= 40; ++issue)
+    {
+        for (int sequence = 0; sequence < 3; ++sequence)
+        {
+            const std::string prefix{'"' + std::to_string(issue) + "\"\t\"" + std::to_string(sequence) + "\"\t\""};
+            tsv += prefix + "sequence_number\"\t\"" + std::to_string(sequence) + "\"\n";
+            tsv += prefix + "script\"\t\"Stan \"\"The Man\"\" Lee\"\n";
+            tsv += prefix + "reprint\"\t\"False\"\n";
+        }
+    }
+    comics::ThreadPool pool{3};
+
+    for (const comics::ConvertOptions options : {comics::ConvertOptions{}, comics::ConvertOptions{true, true}})
+    {
+        comics::TableWriter serialTable{comics::SEQUENCE_COLUMNS};
+        std::ostringstream serial;
+        {
+            comics::OutputBuffer out{serial};
+            comics::DumpConverter converter{comics::DumpKind::SEQUENCES, options, out, &serialTable};
+            comics::convertDump(tsv, converter, [](std::size_t) {});
+        }
+        comics::TableWriter parallelTable{comics::SEQUENCE_COLUMNS};
+        std::ostringstream parallel;
+        std::size_t rounds{};
+        const std::size_t lines{comics::convertDumpParallel(tsv, comics::DumpKind::SEQUENCES, options, parallel,
+            &parallelTable, pool, nullptr, [&](std::size_t) { ++rounds; }, 500)};
+        const comics::SequenceColumns columns{parallelTable.table()};
+
+        EXPECT_EQ(serial.str(), parallel.str());
+        EXPECT_EQ(360U, lines);
+        EXPECT_LT(1U, rounds);
+        ASSERT_EQ(serialTable.rows(), parallelTable.rows());
+        EXPECT_EQ(40, columns.issue[parallelTable.rows() - 1]);
+        EXPECT_EQ("Stan \"The Man\" Lee", columns.script[parallelTable.rows() - 1]);
+    }
+}
+
+TEST(TestGCDConverter, parallelConversionOfEmptyDump)
+{
+    comics::ThreadPool pool{2};
+    std::ostringstream json;
+
+    comics::convertDumpParallel("", comics::DumpKind::ISSUES, {}, json, nullptr, pool, nullptr, [](std::size_t) {});
+
+    EXPECT_EQ("[\n\n]\n", json.str());
+}
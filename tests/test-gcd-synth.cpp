@@ -0,0 +1,147 @@
+#include <comics/gcd-converter.h>
+#include <comics/gcd-synth.h>
+
+#include <simdjson.h>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Dumps
+{
+    std::string tsv;
+    std::string ndjson;
+};
+
+Dumps synthesize(const comics::SynthOptions &options, comics::DumpKind kind)
+{
+    std::ostringstream tsv;
+    std::ostringstream json;
+    {
+        comics::OutputBuffer tsvOut{tsv};
+        comics::OutputBuffer jsonOut{json};
+        comics::DumpConverter converter{kind, {true, true}, jsonOut};
+        if (kind == comics::DumpKind::ISSUES)
+        {
+            comics::synthesizeIssues(options, tsvOut, &converter);
+        }
+        else
+        {
+            comics::synthesizeSequences(options, tsvOut, &converter);
+        }
+    }
+    return {tsv.str(), json.str()};
+}
+
+// Call check with each record of newline delimited JSON, returning the number of records.
+template <typename Check>
+std::size_t forEachRecord(const std::string &ndjson, Check check)
+{
+    simdjson::dom::parser parser;
+    std::size_t count{};
+    std::istringstream lines{ndjson};
+    for (std::string line; std::getline(lines, line); ++count)
+    {
+        check(parser.parse(line).get_object().value());
+    }
+    return count;
+}
+
+comics::SynthOptions smallOptions()
+{
+    comics::SynthOptions options;
+    options.issues = 50;
+    options.sequences = 400;
+    options.creators = 200;
+    return options;
+}
+
+} // namespace
+
+TEST(TestGCDSynth, sameSeedWritesSameDumps)
+{
+    const comics::SynthOptions options{smallOptions()};
+    comics::SynthOptions reseeded{options};
+    reseeded.seed = 2;
+
+    const Dumps first{synthesize(options, comics::DumpKind::SEQUENCES)};
+
+    EXPECT_EQ(first.tsv, synthesize(options, comics::DumpKind::SEQUENCES).tsv);
+    EXPECT_NE(first.tsv, synthesize(reseeded, comics::DumpKind::SEQUENCES).tsv);
+}
+
+TEST(TestGCDSynth, writesRequestedIssues)
+{
+    const comics::SynthOptions options{smallOptions()};
+
+    const Dumps dumps{synthesize(options, comics::DumpKind::ISSUES)};
+
+    std::size_t expectedId{1};
+    EXPECT_EQ(options.issues,
+        forEachRecord(dumps.ndjson,
+            [&](simdjson::dom::object issue)
+            {
+                EXPECT_EQ(std::to_string(expectedId++), std::string{issue["id"].get_string().value()});
+                EXPECT_FALSE(issue["series name"].get_string().value().empty());
+                EXPECT_FALSE(issue["no volume"].get_bool().value());
+            }));
+}
+
+TEST(TestGCDSynth, spreadsRequestedSequencesOverIssues)
+{
+    const comics::SynthOptions options{smallOptions()};
+
+    const Dumps dumps{synthesize(options, comics::DumpKind::SEQUENCES)};
+
+    std::set<int> issues;
+    std::size_t withScript{};
+    EXPECT_EQ(options.sequences,
+        forEachRecord(dumps.ndjson,
+            [&](simdjson::dom::object sequence)
+            {
+                const int id{std::stoi(std::string{sequence["issue"].get_string().value()})};
+                EXPECT_GE(id, 1);
+                EXPECT_LE(id, static_cast<int>(options.issues));
+                issues.insert(id);
+                withScript += sequence["script"].error() == simdjson::SUCCESS ? 1 : 0;
+            }));
+    EXPECT_GT(issues.size(), options.issues / 2);
+    EXPECT_GT(withScript, options.sequences / 2);
+}
+
+TEST(TestGCDSynth, zipfFavorsLowRanks)
+{
+    const comics::ZipfDistribution zipf{100, 1.0};
+    comics::SynthRandom random{7};
+    std::vector<std::size_t> counts(100);
+
+    for (int i = 0; i < 100'000; ++i)
+    {
+        ++counts[zipf(random)];
+    }
+
+    EXPECT_NEAR(2.0, zipf.probability(0) / zipf.probability(1), 1e-9);
+    EXPECT_NEAR(zipf.probability(0) * 100'000, static_cast<double>(counts[0]), 1'000.0);
+    EXPECT_GT(counts[0], counts[1]);
+    EXPECT_GT(counts[1], counts[10]);
+    EXPECT_GT(counts[10], counts[99]);
+}
+
+TEST(TestGCDSynth, creatorNamesAreDistinct)
+{
+    std::set<std::string> names;
+
+    for (std::size_t rank = 0; rank < 200'000; rank += 7)
+    {
+        names.insert(comics::creatorName(rank));
+    }
+
+    EXPECT_EQ((200'000 + 6) / 7, names.size());
+}
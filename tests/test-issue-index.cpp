@@ -0,0 +1,50 @@
+#include <comics/issue-index.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+TEST(TestIdIndex, emptyFindsNothing)
+{
+    const comics::IdIndex<int> index;
+
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(nullptr, index.find(1));
+}
+
+TEST(TestIdIndex, findsInsertedValues)
+{
+    comics::IdIndex<int> index;
+
+    for (int id = 0; id < 1000; ++id)
+    {
+        ASSERT_TRUE(index.insert(id * 7, id));
+    }
+
+    EXPECT_EQ(1000U, index.size());
+    for (int id = 0; id < 1000; ++id)
+    {
+        const int *value = index.find(id * 7);
+        ASSERT_NE(nullptr, value);
+        EXPECT_EQ(id, *value);
+    }
+    EXPECT_EQ(nullptr, index.find(1));
+}
+
+TEST(TestIdIndex, duplicateInsertKeepsFirstValue)
+{
+    comics::IdIndex<int> index;
+
+    EXPECT_TRUE(index.insert(42, 1));
+    EXPECT_FALSE(index.insert(42, 2));
+
+    EXPECT_EQ(1U, index.size());
+    EXPECT_EQ(1, *index.find(42));
+}
+
+TEST(TestIssueIndex, rejectsNonNumericId)
+{
+    EXPECT_THROW(comics::parseId("12a"), std::runtime_error);
+    EXPECT_THROW(comics::parseId(""), std::runtime_error);
+    EXPECT_EQ(16556, comics::parseId("16556"));
+}
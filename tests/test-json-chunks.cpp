@@ -0,0 +1,119 @@
+#include <comics/coro.h>
+#include <comics/json-chunks.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::string issueOf(const simdjson::dom::object &record)
+{
+    return std::string{record.at_key("issue").get_string().value()};
+}
+
+std::vector<std::string> readIssues(comics::JSONArrayReader &reader)
+{
+    std::vector<std::string> issues;
+    simdjson::dom::element record;
+    while (reader.next(record))
+    {
+        issues.push_back(issueOf(record.get_object().value()));
+    }
+    return issues;
+}
+
+} // namespace
+
+TEST(TestJSONChunks, readsRecordsAcrossChunks)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{dir.write("sequences.json",
+        "\n[\n"
+        "  { \"issue\": \"1\", \"script\": \"Lee, Stan [as S. L.]\" },\n"
+        "  { \"issue\": \"2\", \"script\": \"\\\"Sol\\\" {Brodsky},\" },\n"
+        "  { \"issue\": \"3\", \"notes\": [\"a\", \"b]\"] }\n"
+        "]\n")};
+    comics::JSONArrayReader reader{path, 64};
+
+    const std::vector<std::string> issues{readIssues(reader)};
+
+    EXPECT_EQ((std::vector<std::string>{"1", "2", "3"}), issues);
+    EXPECT_EQ(64U, reader.window());
+}
+
+TEST(TestJSONChunks, growsWindowForLargeRecord)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{
+        dir.write("sequences.json", "[{ \"issue\": \"1\", \"script\": \"Stan Lee; Jack Kirby\"}, {\"issue\": \"2\"}]")};
+    comics::JSONArrayReader reader{path, 8};
+
+    const std::vector<std::string> issues{readIssues(reader)};
+
+    EXPECT_EQ((std::vector<std::string>{"1", "2"}), issues);
+    EXPECT_LT(8U, reader.window());
+}
+
+TEST(TestJSONChunks, readsEmptyArray)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{dir.write("sequences.json", " [ ]\n")};
+    comics::JSONArrayReader reader{path, 8};
+    simdjson::dom::element record;
+
+    EXPECT_FALSE(reader.next(record));
+}
+
+TEST(TestJSONChunks, badFilesThrow)
+{
+    const ScratchDir dir;
+    const std::filesystem::path object{dir.write("object.json", "{ \"issue\": \"1\" }")};
+    const std::filesystem::path truncated{dir.write("truncated.json", "[{ \"issue\": \"1\" }, { \"issue\"")};
+    const std::filesystem::path bad{dir.write("bad.json", "[{ \"issue\": }]")};
+    comics::JSONArrayReader truncatedReader{truncated, 8};
+    comics::JSONArrayReader badReader{bad, 8};
+    simdjson::dom::element record;
+
+    EXPECT_THROW(comics::JSONArrayReader{object}, std::runtime_error);
+    EXPECT_TRUE(truncatedReader.next(record));
+    EXPECT_THROW(truncatedReader.next(record), std::runtime_error);
+    EXPECT_THROW(badReader.next(record), std::runtime_error);
+}
+
+TEST(TestJSONChunks, matchesStreamChunksWithinBudget)
+{
+    const ScratchDir dir;
+    dir.write("2024-01-01_issues.json",
+        "[{ \"id\": \"16556\", \"series name\": \"Fantastic Four\"},\n"
+        " { \"id\": \"17568\", \"series name\": \"The Amazing Spider-Man\"}]\n");
+    std::string sequences{"["};
+    for (int i = 0; i < 1000; ++i)
+    {
+        sequences += "{ \"issue\": \"16556\", \"script\": \"Stan Lee\" },";
+    }
+    sequences += "{ \"issue\": \"17568\", \"script\": \"Stan Lee (credited)\" }]";
+    dir.write("2024-01-01_sequences.json", sequences);
+    comics::DatabaseOptions options;
+    options.memoryBudget = 1 << 16;
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path(), options)};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "credited")};
+
+    const bool firstValue{coro.resume()};
+    const comics::coroutine::SequenceMatch match{coro.getMatch()};
+    const std::string issue{issueOf(match.sequence)};
+    const bool secondValue{coro.resume()};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_FALSE(secondValue);
+    EXPECT_EQ(nullptr, db->getSequenceTable());
+    EXPECT_EQ(1U, match.issueRow);
+    EXPECT_EQ("17568", issue);
+    EXPECT_GT(sequences.size(), comics::chunkWindow(options.memoryBudget));
+}
@@ -0,0 +1,48 @@
+#include <comics/json-files.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <filesystem>
+#include <stdexcept>
+
+TEST(TestJSONFiles, loadsBothFiles)
+{
+    const ScratchDir dir;
+    dir.write("2024-01-01_issues.json", R"([ { "id": "1" } ])");
+    dir.write("2024-01-01_sequences.json", R"([ { "issue": "1" }, { "issue": "1" } ])");
+    simdjson::dom::parser issueParser;
+    simdjson::dom::parser sequenceParser;
+    simdjson::simdjson_result<simdjson::dom::element> issues;
+    simdjson::simdjson_result<simdjson::dom::element> sequences;
+
+    comics::loadJSONFiles(comics::findJSONFiles(dir.path()), issueParser, issues, sequenceParser, sequences);
+
+    ASSERT_TRUE(issues.is_array());
+    ASSERT_TRUE(sequences.is_array());
+    EXPECT_EQ(1U, issues.get_array().size());
+    EXPECT_EQ(2U, sequences.get_array().size());
+}
+
+TEST(TestJSONFiles, missingSequencesThrows)
+{
+    const ScratchDir dir;
+    dir.write("2024-01-01_issues.json", R"([ { "id": "1" } ])");
+
+    EXPECT_THROW(comics::findJSONFiles(dir.path()), std::runtime_error);
+}
+
+TEST(TestJSONFiles, invalidSequencesThrows)
+{
+    const ScratchDir dir;
+    dir.write("2024-01-01_issues.json", R"([ { "id": "1" } ])");
+    dir.write("2024-01-01_sequences.json", R"({ "issue": "1" })");
+    simdjson::dom::parser issueParser;
+    simdjson::dom::parser sequenceParser;
+    simdjson::simdjson_result<simdjson::dom::element> issues;
+    simdjson::simdjson_result<simdjson::dom::element> sequences;
+    const comics::JSONPaths paths{comics::findJSONFiles(dir.path())};
+
+    EXPECT_THROW(comics::loadJSONFiles(paths, issueParser, issues, sequenceParser, sequences), std::runtime_error);
+}
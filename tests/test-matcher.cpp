@@ -0,0 +1,114 @@
+#include <comics/matcher.h>
+#include <comics/snapshot.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+using Implementation = comics::NeedleMatcher::Implementation;
+
+std::vector<Implementation> supportedImplementations()
+{
+    std::vector<Implementation> result;
+    for (const Implementation impl : {Implementation::SCALAR, Implementation::SSE2, Implementation::AVX2, Implementation::NEON})
+    {
+        if (comics::NeedleMatcher::supported(impl))
+        {
+            result.push_back(impl);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(TestMatcher, scalarIsAlwaysSupported)
+{
+    EXPECT_TRUE(comics::NeedleMatcher::supported(Implementation::SCALAR));
+    EXPECT_TRUE(comics::NeedleMatcher::supported(comics::NeedleMatcher::best()));
+    EXPECT_EQ(comics::NeedleMatcher::best(), comics::NeedleMatcher{"Lee"}.implementation());
+}
+
+TEST(TestMatcher, unsupportedImplementationThrows)
+{
+    for (const Implementation impl : {Implementation::SSE2, Implementation::AVX2, Implementation::NEON})
+    {
+        if (!comics::NeedleMatcher::supported(impl))
+        {
+            EXPECT_THROW((comics::NeedleMatcher{"Lee", impl}), std::runtime_error);
+        }
+    }
+}
+
+TEST(TestMatcher, implementationsAgreeWithStringFind)
+{
+    // long enough to cover whole blocks and the scalar tail at every alignment
+    std::string text;
+    for (int i = 0; i < 6; ++i)
+    {
+        text += "Stan Lee (signed as Stan Lee [early]); Jack Kirby ?; Steve Ditko; ";
+    }
+    text += "Sol Brodsky";
+    const std::vector<std::string> needles{"S", "?", "St", "Lee", "Sol Brodsky", "Brodsky", "y", "Kirby ?; Steve",
+        "Stan Lee (signed as Stan Lee [early]); Jack Kirby ?; Steve Ditko; Stan", "Barry Flargle", "Sol Brodskyy"};
+
+    for (const Implementation impl : supportedImplementations())
+    {
+        for (const std::string &needle : needles)
+        {
+            const comics::NeedleMatcher matcher{needle, impl};
+            for (std::size_t start = 0; start <= text.size(); ++start)
+            {
+                const std::string_view view{std::string_view{text}.substr(start)};
+                ASSERT_EQ(view.find(needle), matcher.find(view))
+                    << comics::NeedleMatcher::name(impl) << " '" << needle << "' at " << start;
+            }
+        }
+    }
+}
+
+TEST(TestMatcher, emptyNeedleMatchesEverything)
+{
+    for (const Implementation impl : supportedImplementations())
+    {
+        const comics::NeedleMatcher matcher{"", impl};
+
+        EXPECT_EQ(0U, matcher.find("Stan Lee"));
+        EXPECT_TRUE(matcher.matches(""));
+    }
+}
+
+TEST(TestMatcher, findRowSkipsAbsentRowsAndStraddlingMatches)
+{
+    comics::TableWriter writer{{{"script", comics::ColumnType::STRING}}};
+    writer.set(0, "Stan");
+    writer.endRow();
+    writer.set(0, " Lee");
+    writer.endRow();
+    writer.endRow();
+    writer.set(0, "");
+    writer.endRow();
+    writer.set(0, "Stan Lee (credited)");
+    writer.endRow();
+    writer.set(0, "Jack Kirby");
+    writer.endRow();
+    const comics::StringColumn column{writer.table().stringColumn("script")};
+
+    const comics::NeedleMatcher lee{"Stan Lee"};
+    EXPECT_EQ(4U, findRow(column, lee, 0));
+    EXPECT_EQ(6U, findRow(column, lee, 5));
+    EXPECT_EQ(6U, findRow(column, lee, 6));
+
+    const comics::NeedleMatcher empty{""};
+    EXPECT_EQ(1U, findRow(column, empty, 1));
+    EXPECT_EQ(3U, findRow(column, empty, 2));
+
+    const comics::NeedleMatcher kirby{"Kirby"};
+    EXPECT_EQ(5U, findRow(column, kirby, 0));
+}
@@ -0,0 +1,66 @@
+#include <comics/multi-matcher.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+using Found = std::vector<std::uint32_t>;
+
+TEST(TestMultiMatcher, findsEveryNeedleInOnePass)
+{
+    const std::vector<std::string_view> needles{"Stan Lee", "Jack Kirby", "Steve Ditko"};
+    const comics::MultiMatcher matcher{needles};
+    Found found;
+
+    matcher.find("Stan Lee; Jack Kirby (signed)", found);
+
+    EXPECT_EQ((Found{0, 1}), found);
+}
+
+TEST(TestMultiMatcher, findsOverlappingAndNestedNeedles)
+{
+    const std::vector<std::string_view> needles{"he", "she", "his", "hers"};
+    const comics::MultiMatcher matcher{needles};
+    Found found;
+
+    matcher.find("ushers", found);
+
+    EXPECT_EQ((Found{0, 1, 3}), found);
+}
+
+TEST(TestMultiMatcher, reportsNeedlesOnceAndDuplicatesSeparately)
+{
+    const std::vector<std::string_view> needles{"Lee", "Lee"};
+    const comics::MultiMatcher matcher{needles};
+    Found found;
+
+    matcher.find("Stan Lee; Stan Lee", found);
+
+    EXPECT_EQ((Found{0, 1}), found);
+}
+
+TEST(TestMultiMatcher, noMatchClearsFound)
+{
+    const std::vector<std::string_view> needles{"Kirby"};
+    const comics::MultiMatcher matcher{needles};
+    Found found{7};
+
+    matcher.find("Steve Ditko", found);
+
+    EXPECT_TRUE(found.empty());
+    EXPECT_EQ(1U, matcher.needles());
+    EXPECT_EQ(6U, matcher.states());
+}
+
+TEST(TestMultiMatcher, emptyNeedleMatchesEverything)
+{
+    const std::vector<std::string_view> needles{"", "x"};
+    const comics::MultiMatcher matcher{needles};
+    Found found;
+
+    matcher.find("", found);
+
+    EXPECT_EQ((Found{0}), found);
+}
@@ -0,0 +1,144 @@
+#include <comics/coro.h>
+#include <comics/ndjson.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+std::string issueOf(const simdjson::dom::object &record)
+{
+    return std::string{record.at_key("issue").get_string().value()};
+}
+
+} // namespace
+
+TEST(TestNDJSON, readsRecordsAcrossWindows)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{dir.write("sequences.ndjson",
+        "{ \"issue\": \"1\"}\n"
+        "\n"
+        "{ \"issue\": \"2\"}\r\n"
+        "{ \"issue\": \"3\"}")};
+    comics::NDJSONReader reader{path, 20};
+    simdjson::dom::element record;
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ("1", issueOf(record));
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ("2", issueOf(record));
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ("3", issueOf(record));
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_EQ(20U, reader.window());
+}
+
+TEST(TestNDJSON, growsWindowForLargeRecord)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{
+        dir.write("sequences.ndjson", "{ \"issue\": \"1\", \"script\": \"Stan Lee; Jack Kirby\"}\n")};
+    comics::NDJSONReader reader{path, 8};
+    simdjson::dom::element record;
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ("1", issueOf(record));
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_LT(8U, reader.window());
+}
+
+TEST(TestNDJSON, badRecordThrows)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{dir.write("sequences.ndjson", "{ \"issue\": }\n")};
+    comics::NDJSONReader reader{path};
+    simdjson::dom::element record;
+
+    EXPECT_THROW(reader.next(record), std::runtime_error);
+}
+
+TEST(TestNDJSON, findsFilesOnlyWhenBothPresent)
+{
+    const ScratchDir dir;
+    dir.write("2024-01-01_issues.ndjson", "");
+
+    EXPECT_FALSE(comics::findNDJSONFiles(dir.path()));
+
+    dir.write("2024-01-01_sequences.ndjson", "");
+    const std::optional<comics::NDJSONPaths> paths{comics::findNDJSONFiles(dir.path())};
+
+    ASSERT_TRUE(paths);
+    EXPECT_EQ("2024-01-01_issues.ndjson", paths->issues.filename());
+    EXPECT_EQ("2024-01-01_sequences.ndjson", paths->sequences.filename());
+}
+
+TEST(TestNDJSON, ignoresFilesOlderThanJSON)
+{
+    const ScratchDir dir;
+    const std::filesystem::path issues{dir.write("2024-01-01_issues.ndjson", "")};
+    dir.write("2024-01-01_sequences.ndjson", "");
+    const std::filesystem::path json{dir.write("2024-01-01_issues.json", "[]")};
+
+    std::filesystem::last_write_time(json, std::filesystem::last_write_time(issues) - std::chrono::seconds{1});
+    const bool olderJSON{comics::findNDJSONFiles(dir.path()).has_value()};
+    std::filesystem::last_write_time(json, std::filesystem::last_write_time(issues) + std::chrono::seconds{1});
+    const bool newerJSON{comics::findNDJSONFiles(dir.path()).has_value()};
+
+    EXPECT_TRUE(olderJSON);
+    EXPECT_FALSE(newerJSON);
+}
+
+TEST(TestNDJSON, matchesStreamSequences)
+{
+    const ScratchDir dir;
+    dir.write("2024-01-01_issues.ndjson",
+        "{ \"id\": \"16556\", \"series name\": \"Fantastic Four\"}\n"
+        "{ \"id\": \"17568\", \"series name\": \"The Amazing Spider-Man\"}\n");
+    dir.write("2024-01-01_sequences.ndjson",
+        "{ \"issue\": \"16556\", \"script\": \"Stan Lee\"}\n"
+        "{ \"issue\": \"17568\", \"pencils\": \"Steve Ditko\"}\n"
+        "{ \"issue\": \"17568\", \"script\": \"Stan Lee (credited)\"}\n");
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path())};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "credited")};
+
+    const bool firstValue{coro.resume()};
+    const comics::coroutine::SequenceMatch match{coro.getMatch()};
+    const std::string issue{issueOf(match.sequence)};
+    const bool secondValue{coro.resume()};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_FALSE(secondValue);
+    ASSERT_NE(nullptr, db->getIssueTable());
+    EXPECT_EQ(nullptr, db->getSequenceTable());
+    EXPECT_EQ(1U, match.issueRow);
+    EXPECT_EQ(comics::coroutine::NO_ROW, match.sequenceRow);
+    EXPECT_EQ("17568", issue);
+}
+
+TEST(TestNDJSON, streamedMatchesEndEachBatch)
+{
+    const ScratchDir dir;
+    dir.write("2024-01-01_issues.ndjson", "{ \"id\": \"1\", \"series name\": \"Fantastic Four\"}\n");
+    dir.write("2024-01-01_sequences.ndjson",
+        "{ \"issue\": \"1\", \"script\": \"Stan Lee\"}\n"
+        "{ \"issue\": \"1\", \"script\": \"Stan Lee (credited)\"}\n");
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path())};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "Lee")};
+
+    const std::span<const comics::coroutine::SequenceMatch> first{coro.resumeBatch(16)};
+    ASSERT_EQ(1U, first.size());
+    EXPECT_EQ("Stan Lee", first[0].sequence.at_key("script").get_string().value());
+    const std::span<const comics::coroutine::SequenceMatch> second{coro.resumeBatch(16)};
+    ASSERT_EQ(1U, second.size());
+    EXPECT_EQ("Stan Lee (credited)", second[0].sequence.at_key("script").get_string().value());
+    EXPECT_TRUE(coro.resumeBatch(16).empty());
+}
@@ -0,0 +1,40 @@
+#include <comics/projection.h>
+#include <comics/snapshot.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string_view>
+
+TEST(TestProjection, projectsQueriedFields)
+{
+    simdjson::dom::parser parser;
+    const simdjson::dom::element records{parser.parse(std::string_view{
+        R"([{ "issue": "16556", "sequence_number": 3, "title": "Origin", "script": "Stan Lee", "colors": true},)"
+        R"( { "issue": "17568", "pencils": "Steve Ditko", "notes": 12}])"})};
+    comics::TableWriter writer{comics::SEQUENCE_COLUMNS};
+
+    comics::projectRecords(writer, comics::SEQUENCE_COLUMNS, records);
+    const comics::Table table{writer.table()};
+    const comics::SequenceColumns columns{table};
+
+    ASSERT_EQ(2U, table.rows());
+    EXPECT_EQ(16556, columns.issue[0]);
+    EXPECT_EQ(3, columns.sequenceNumber[0]);
+    EXPECT_EQ("Origin", columns.title[0]);
+    EXPECT_EQ("Stan Lee", columns.script[0]);
+    EXPECT_EQ("true", columns.colors[0]);
+    EXPECT_FALSE(columns.pencils.present(0));
+    EXPECT_EQ(17568, columns.issue[1]);
+    EXPECT_EQ("Steve Ditko", columns.pencils[1]);
+    EXPECT_FALSE(columns.title.present(1));
+}
+
+TEST(TestProjection, unexpectedTypeThrows)
+{
+    simdjson::dom::parser parser;
+    const simdjson::dom::element records{parser.parse(std::string_view{R"([{ "issue": "1", "script": ["Stan Lee"]}])"})};
+    comics::TableWriter writer{comics::SEQUENCE_COLUMNS};
+
+    EXPECT_THROW(comics::projectRecords(writer, comics::SEQUENCE_COLUMNS, records), std::runtime_error);
+}
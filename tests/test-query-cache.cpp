@@ -0,0 +1,224 @@
+#include <comics/comics.h>
+#include <comics/coro.h>
+#include <comics/query-cache.h>
+#include <comics/stats.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <array>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr const char *ISSUES{R"iss([
+    { "id": "16556", "series name": "Fantastic Four", "issue number": "1" },
+    { "id": "17568", "series name": "The Amazing Spider-Man", "issue number": "1" }
+])iss"};
+
+constexpr const char *SEQUENCES{R"seq([
+    { "issue": "16556", "sequence_number": "0", "script": "Stan Lee", "pencils": "Jack Kirby" },
+    { "issue": "16556", "sequence_number": "1", "script": "Stan Lee (credited)", "pencils": "Jack Kirby" },
+    { "issue": "17568", "sequence_number": "0", "script": "Stan Lee", "pencils": "Steve Ditko" }
+])seq"};
+
+comics::PostingList postings(std::initializer_list<std::uint32_t> rows)
+{
+    comics::PostingList list;
+    for (const std::uint32_t row : rows)
+    {
+        list.append(row);
+    }
+    return list;
+}
+
+std::vector<std::uint32_t> rowsOf(const comics::PostingList &list)
+{
+    return {list.begin(), list.end()};
+}
+
+std::vector<std::size_t> matchedRows(comics::coroutine::MatchGenerator &coro)
+{
+    std::vector<std::size_t> rows;
+    while (coro.resume())
+    {
+        rows.push_back(coro.getMatch().sequenceRow);
+    }
+    return rows;
+}
+
+} // namespace
+
+TEST(TestQueryCache, keysDistinguishFieldModeAndName)
+{
+    const std::string key{comics::queryKey("script", comics::MatchMode::SUBSTRING, "Stan Lee")};
+
+    EXPECT_EQ(key, comics::queryKey("script", comics::MatchMode::SUBSTRING, "Stan Lee"));
+    EXPECT_NE(key, comics::queryKey("pencils", comics::MatchMode::SUBSTRING, "Stan Lee"));
+    EXPECT_NE(key, comics::queryKey("script", comics::MatchMode::CREATOR, "Stan Lee"));
+    EXPECT_NE(key, comics::queryKey("script", comics::MatchMode::SUBSTRING, "Stan"));
+}
+
+TEST(TestQueryCache, evictsLeastRecentlyUsed)
+{
+    const std::size_t entryBytes{1 + 1 + comics::QueryCache::ENTRY_OVERHEAD};
+    comics::QueryCache cache{2 * entryBytes, 0};
+
+    cache.insert("a", postings({1}));
+    cache.insert("b", postings({2}));
+    ASSERT_NE(nullptr, cache.find("a"));
+    cache.insert("c", postings({3}));
+
+    EXPECT_EQ(2U, cache.entries());
+    EXPECT_EQ(2 * entryBytes, cache.bytes());
+    EXPECT_EQ(nullptr, cache.find("b"));
+    ASSERT_NE(nullptr, cache.find("a"));
+    EXPECT_EQ(std::vector<std::uint32_t>{3}, rowsOf(*cache.find("c")));
+}
+
+TEST(TestQueryCache, skipsEntriesLargerThanCache)
+{
+    comics::QueryCache cache{comics::QueryCache::ENTRY_OVERHEAD, 0};
+
+    cache.insert("a", postings({1, 2, 3}));
+
+    EXPECT_EQ(nullptr, cache.find("a"));
+    EXPECT_EQ(0U, cache.bytes());
+}
+
+TEST(TestQueryCache, savesAndLoadsEntries)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{dir.path() / "queries.cache"};
+    {
+        comics::QueryCache cache{1 << 20, 42, path};
+        cache.insert("a", postings({0, 5, 300, 70000}));
+        cache.insert("b", postings({}));
+    }
+
+    comics::QueryCache loaded{1 << 20, 42, path};
+
+    ASSERT_EQ(2U, loaded.entries());
+    EXPECT_EQ((std::vector<std::uint32_t>{0, 5, 300, 70000}), rowsOf(*loaded.find("a")));
+    EXPECT_TRUE(loaded.find("b")->empty());
+}
+
+TEST(TestQueryCache, ignoresCacheOfOtherFiles)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{dir.path() / "queries.cache"};
+    {
+        comics::QueryCache cache{1 << 20, 42, path};
+        cache.insert("a", postings({1}));
+    }
+
+    const comics::QueryCache loaded{1 << 20, 43, path};
+
+    EXPECT_EQ(0U, loaded.entries());
+}
+
+TEST(TestQueryCache, replacesTruncatedCache)
+{
+    const ScratchDir dir;
+    const std::filesystem::path path{dir.path() / "queries.cache"};
+    {
+        comics::QueryCache cache{1 << 20, 42, path};
+        cache.insert("a", postings({1}));
+        cache.insert("b", postings({2, 3}));
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    {
+        comics::QueryCache truncated{1 << 20, 42, path};
+
+        EXPECT_EQ(0U, truncated.entries());
+        truncated.insert("c", postings({4}));
+    }
+
+    comics::QueryCache loaded{1 << 20, 42, path};
+
+    ASSERT_EQ(1U, loaded.entries());
+    EXPECT_EQ((std::vector<std::uint32_t>{4}), rowsOf(*loaded.find("c")));
+}
+
+TEST(TestQueryCache, rejectsOtherFiles)
+{
+    const ScratchDir dir;
+    dir.write("notes.txt", "These notes aren't a query cache at all.");
+
+    EXPECT_THROW((comics::QueryCache{1 << 20, 42, dir.path() / "notes.txt"}), std::runtime_error);
+}
+
+TEST(TestQueryCache, fingerprintChangesWithFiles)
+{
+    const ScratchDir dir;
+    dir.write("issues.json", ISSUES);
+    dir.write("sequences.json", SEQUENCES);
+    const std::array files{dir.path() / "issues.json", dir.path() / "sequences.json"};
+    const std::uint64_t before{comics::fingerprintFiles(files)};
+
+    dir.write("sequences.json", "[]");
+
+    EXPECT_NE(before, comics::fingerprintFiles(files));
+}
+
+TEST(TestQueryCache, coroutineRepeatsQueryFromCache)
+{
+    const ScratchDir dir;
+    dir.write("issues.json", ISSUES);
+    dir.write("sequences.json", SEQUENCES);
+    comics::QueryStats stats;
+    comics::DatabaseOptions options;
+    options.cacheBytes = 1 << 20;
+    options.cachePath = dir.path() / "queries.cache";
+    options.stats = &stats;
+    std::vector<std::size_t> first;
+    {
+        const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path(), options)};
+        comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "Stan Lee")};
+        first = matchedRows(coro);
+    }
+    const std::uint64_t scanned{stats.recordsScanned.load()};
+
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path(), options)};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "Stan Lee")};
+    comics::coroutine::MatchGenerator ordered{matches(db, comics::coroutine::CreditField::SCRIPT, "Stan Lee",
+        comics::MatchMode::SUBSTRING, comics::MatchOrder::SEQUENCE)};
+    const std::vector<std::size_t> second{matchedRows(coro)};
+    const comics::coroutine::SequenceMatch firstOrdered{(ordered.resume(), ordered.getMatch())};
+
+    EXPECT_EQ((std::vector<std::size_t>{0, 1, 2}), first);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(0U, firstOrdered.sequenceRow);
+    EXPECT_EQ(2U, stats.cacheHits.load());
+    EXPECT_EQ(scanned, stats.recordsScanned.load());
+}
+
+TEST(TestQueryCache, printsRepeatedQueryFromCache)
+{
+    const ScratchDir dir;
+    dir.write("issues.json", ISSUES);
+    dir.write("sequences.json", SEQUENCES);
+    comics::QueryStats stats;
+    comics::DatabaseOptions options;
+    options.cacheBytes = 1 << 20;
+    options.stats = &stats;
+    const std::shared_ptr<comics::Database> db{comics::createDatabase(dir.path(), options)};
+    std::ostringstream first;
+    std::ostringstream second;
+    std::ostringstream other;
+
+    db->printPencilSequences(first, "Kirby");
+    db->printPencilSequences(second, "Kirby");
+    db->printScriptSequences(other, "Kirby");
+
+    EXPECT_FALSE(first.str().empty());
+    EXPECT_EQ(first.str(), second.str());
+    EXPECT_TRUE(other.str().empty());
+    EXPECT_EQ(1U, stats.cacheHits.load());
+}
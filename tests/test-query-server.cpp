@@ -0,0 +1,68 @@
+#include <comics/query-server.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+comics::coroutine::DatabasePtr sampleDatabase(const ScratchDir &dir)
+{
+    dir.write("2024-01-01_issues.ndjson",
+        "{ \"id\": \"16556\", \"series name\": \"Fantastic Four\", \"issue number\": \"1\"}\n");
+    dir.write("2024-01-01_sequences.ndjson",
+        "{ \"issue\": \"16556\", \"script\": \"Stan Lee\", \"pencils\": \"Jack Kirby\"}\n"
+        "{ \"issue\": \"16556\", \"script\": \"Stan Lee (credited)\"}\n");
+    return comics::coroutine::createDatabase(dir.path());
+}
+
+} // namespace
+
+TEST(TestQueryServer, parsesQueryWithSpacesInName)
+{
+    const comics::coroutine::Query query{comics::coroutine::parseQuery("  -x -p  Jack Kirby \r")};
+
+    EXPECT_EQ(comics::coroutine::CreditField::PENCIL, query.field);
+    EXPECT_EQ(comics::MatchMode::CREATOR, query.mode);
+    EXPECT_EQ("Jack Kirby", query.name);
+}
+
+TEST(TestQueryServer, parsesFoldedQuery)
+{
+    const comics::coroutine::Query query{comics::coroutine::parseQuery("-f -s moebius")};
+
+    EXPECT_EQ(comics::coroutine::CreditField::SCRIPT, query.field);
+    EXPECT_EQ(comics::MatchMode::FOLDED, query.mode);
+    EXPECT_EQ("moebius", query.name);
+}
+
+TEST(TestQueryServer, rejectsMalformedQueries)
+{
+    EXPECT_THROW(comics::coroutine::parseQuery("-q Stan Lee"), std::runtime_error);
+    EXPECT_THROW(comics::coroutine::parseQuery("-s "), std::runtime_error);
+    EXPECT_THROW(comics::coroutine::parseQuery(""), std::runtime_error);
+}
+
+TEST(TestQueryServer, answersEachQueryFromOneDatabase)
+{
+    const ScratchDir dir;
+    const comics::coroutine::DatabasePtr db{sampleDatabase(dir)};
+    std::istringstream in{"-s credited\n\n-p Ditko\n-z\nquit\n-s Stan Lee\n"};
+    std::ostringstream out;
+
+    comics::coroutine::serveQueries(in, out, db);
+
+    EXPECT_EQ("Fantastic Four #1\n"
+              "            script: Stan Lee (credited)\n"
+              ".\n"
+              ".\n"
+              "error: Expected -s, -p, -i, -c or -l, got '-z'\n"
+              ".\n",
+        out.str());
+}
@@ -0,0 +1,292 @@
+#include <comics/coro.h>
+#include <comics/issue-index.h>
+#include <comics/snapshot.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+comics::TableWriter sampleSequences()
+{
+    comics::TableWriter writer{comics::SEQUENCE_COLUMNS};
+    writer.set(0, 16556);
+    writer.set(1, 0);
+    writer.set(4, "Stan Lee");
+    writer.set(5, "Jack Kirby");
+    writer.endRow();
+    writer.set(0, 17568);
+    writer.set(1, 1);
+    writer.set(2, "Spider-Man");
+    writer.set(4, "Stan Lee (credited)");
+    writer.set(5, "");
+    writer.endRow();
+    return writer;
+}
+
+} // namespace
+
+TEST(TestTable, absentAndEmptyStringsDiffer)
+{
+    const comics::TableWriter writer{sampleSequences()};
+    const comics::SequenceColumns columns{writer.table()};
+
+    EXPECT_FALSE(columns.title.present(0));
+    EXPECT_EQ(nullptr, columns.title[0].data());
+    EXPECT_EQ("Spider-Man", columns.title[1]);
+    EXPECT_TRUE(columns.pencils.present(1));
+    EXPECT_EQ("", columns.pencils[1]);
+    EXPECT_FALSE(columns.letters.present(1));
+}
+
+TEST(TestTable, setReplacesValueInRow)
+{
+    comics::TableWriter writer{comics::ISSUE_COLUMNS};
+    writer.set(1, "Fantastic Four");
+    writer.set(1, "The Amazing Spider-Man");
+    writer.endRow();
+
+    const comics::IssueColumns columns{writer.table()};
+
+    EXPECT_EQ("The Amazing Spider-Man", columns.seriesName[0]);
+    EXPECT_EQ(0, columns.id[0]);
+}
+
+TEST(TestTable, appendsRows)
+{
+    comics::TableWriter writer{comics::SEQUENCE_COLUMNS};
+    writer.set(0, 1);
+    writer.set(2, "Origin");
+    writer.endRow();
+
+    writer.append(sampleSequences());
+    const comics::SequenceColumns columns{writer.table()};
+
+    ASSERT_EQ(3U, writer.rows());
+    EXPECT_EQ("Origin", columns.title[0]);
+    EXPECT_EQ(16556, columns.issue[1]);
+    EXPECT_FALSE(columns.title.present(1));
+    EXPECT_EQ("Stan Lee", columns.script[1]);
+    EXPECT_EQ("Spider-Man", columns.title[2]);
+    EXPECT_EQ("", columns.pencils[2]);
+    EXPECT_THROW(writer.append(comics::TableWriter{comics::ISSUE_COLUMNS}), std::runtime_error);
+}
+
+TEST(TestTable, missingColumnThrows)
+{
+    const comics::TableWriter writer{comics::ISSUE_COLUMNS};
+
+    EXPECT_THROW(writer.table().stringColumn("script"), std::runtime_error);
+    EXPECT_THROW(writer.table().stringColumn("id"), std::runtime_error);
+}
+
+TEST(TestSnapshot, roundTripsTable)
+{
+    const ScratchDir dir;
+    const std::filesystem::path file{dir / "sequences.snapshot"};
+    const comics::TableWriter writer{sampleSequences()};
+
+    comics::writeSnapshot(file, writer.table());
+    const comics::Snapshot snapshot{file};
+    const comics::SequenceColumns columns{snapshot.table()};
+
+    ASSERT_EQ(2U, snapshot.table().rows());
+    EXPECT_EQ(17568, columns.issue[1]);
+    EXPECT_EQ(1, columns.sequenceNumber[1]);
+    EXPECT_FALSE(columns.title.present(0));
+    EXPECT_EQ("Spider-Man", columns.title[1]);
+    EXPECT_EQ("Stan Lee (credited)", columns.script[1]);
+    EXPECT_EQ("", columns.pencils[1]);
+}
+
+TEST(TestSnapshot, rejectsOtherFiles)
+{
+    const ScratchDir dir;
+    const std::filesystem::path file{dir / "not.snapshot"};
+    std::ofstream(file) << "[ { \"id\": \"1\" } ]                      \n";
+
+    EXPECT_THROW(comics::Snapshot{file}, std::runtime_error);
+}
+
+TEST(TestSnapshot, rejectsOtherVersions)
+{
+    const ScratchDir dir;
+    const std::filesystem::path file{dir / "version.snapshot"};
+    comics::writeSnapshot(file, sampleSequences().table());
+    {
+        std::fstream str(file, std::ios::in | std::ios::out | std::ios::binary);
+        const std::uint32_t version{comics::SNAPSHOT_VERSION + 1};
+        str.seekp(offsetof(comics::SnapshotHeader, version));
+        str.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    }
+
+    EXPECT_THROW(comics::Snapshot{file}, std::runtime_error);
+}
+
+TEST(TestSnapshot, findsSnapshotsOfCurrentJSON)
+{
+    const ScratchDir dir;
+    const comics::TableWriter writer{sampleSequences()};
+    comics::writeSnapshot(dir / "issues.snapshot", writer.table(), dir.write("issues.json", "[]"));
+    comics::writeSnapshot(dir / "sequences.snapshot", writer.table(), dir.write("sequences.json", "[]"));
+
+    const std::optional<comics::SnapshotPaths> current{comics::findSnapshots(dir.path())};
+    dir.write("sequences.json", "[{ \"issue\": \"1\" }]");
+    const std::optional<comics::SnapshotPaths> stale{comics::findSnapshots(dir.path())};
+
+    ASSERT_TRUE(current.has_value());
+    EXPECT_EQ(dir / "sequences.snapshot", current->sequences);
+    EXPECT_FALSE(stale.has_value());
+}
+
+TEST(TestSnapshot, findsSnapshotsWithoutJSON)
+{
+    const ScratchDir dir;
+    const comics::TableWriter writer{sampleSequences()};
+    comics::writeSnapshot(dir / "issues.snapshot", writer.table());
+    comics::writeSnapshot(dir / "sequences.snapshot", writer.table(), dir.write("sequences.json", "[]"));
+    std::filesystem::remove(dir / "sequences.json");
+
+    EXPECT_TRUE(comics::findSnapshots(dir.path()).has_value());
+}
+
+namespace
+{
+
+class TableDatabase : public comics::coroutine::Database
+{
+public:
+    TableDatabase() :
+        m_sequenceWriter(sampleSequences())
+    {
+        m_issueWriter.set(0, 16556);
+        m_issueWriter.set(1, "Fantastic Four");
+        m_issueWriter.endRow();
+        m_issueWriter.set(0, 17568);
+        m_issueWriter.set(1, "The Amazing Spider-Man");
+        m_issueWriter.endRow();
+        m_issues = m_issueWriter.table();
+        m_sequences = m_sequenceWriter.table();
+        m_index = comics::buildIssueRowIndex(comics::IssueColumns{m_issues}.id);
+    }
+    ~TableDatabase() override = default;
+
+    simdjson::simdjson_result<simdjson::dom::element> getIssues() const override
+    {
+        return simdjson::UNINITIALIZED;
+    }
+    simdjson::simdjson_result<simdjson::dom::element> getSequences() const override
+    {
+        return simdjson::UNINITIALIZED;
+    }
+    const comics::Table *getIssueTable() const override
+    {
+        return &m_issues;
+    }
+    const comics::Table *getSequenceTable() const override
+    {
+        return &m_sequences;
+    }
+    std::size_t findIssueRow(int id) const override
+    {
+        return *m_index.find(id);
+    }
+
+private:
+    comics::TableWriter m_issueWriter{comics::ISSUE_COLUMNS};
+    comics::TableWriter m_sequenceWriter;
+    comics::Table m_issues;
+    comics::Table m_sequences;
+    comics::IssueRowIndex m_index;
+};
+
+class ThreadedTableDatabase : public TableDatabase
+{
+public:
+    comics::ThreadPool *getThreadPool() const override
+    {
+        return &m_pool;
+    }
+
+private:
+    mutable comics::ThreadPool m_pool{2};
+};
+
+} // namespace
+
+TEST(TestSnapshot, matchesScanTables)
+{
+    const auto db{std::make_shared<TableDatabase>()};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "credited")};
+
+    const bool firstValue{coro.resume()};
+    const comics::coroutine::SequenceMatch match{coro.getMatch()};
+    const bool secondValue{coro.resume()};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_FALSE(secondValue);
+    EXPECT_EQ(1U, match.issueRow);
+    EXPECT_EQ(1U, match.sequenceRow);
+}
+
+TEST(TestSnapshot, matchesScanTablesInParallel)
+{
+    const auto db{std::make_shared<ThreadedTableDatabase>()};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "Stan Lee")};
+
+    const bool firstValue{coro.resume()};
+    const std::size_t firstRow{coro.getMatch().sequenceRow};
+    const bool secondValue{coro.resume()};
+    const std::size_t secondRow{coro.getMatch().sequenceRow};
+    const bool thirdValue{coro.resume()};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_TRUE(secondValue);
+    EXPECT_FALSE(thirdValue);
+    EXPECT_EQ(0U, firstRow);
+    EXPECT_EQ(1U, secondRow);
+}
+
+TEST(TestSnapshot, batchMatchesScanTablesInParallel)
+{
+    const auto db{std::make_shared<ThreadedTableDatabase>()};
+    const std::vector<std::string_view> names{"credited", "Stan Lee"};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, names)};
+
+    const bool firstValue{coro.resume()};
+    const comics::coroutine::SequenceMatch first{coro.getMatch()};
+    const bool secondValue{coro.resume()};
+    const comics::coroutine::SequenceMatch second{coro.getMatch()};
+    const bool thirdValue{coro.resume()};
+
+    EXPECT_TRUE(firstValue);
+    EXPECT_TRUE(secondValue);
+    EXPECT_FALSE(thirdValue);
+    EXPECT_EQ(0U, first.sequenceRow);
+    EXPECT_EQ((std::vector<std::uint32_t>{1}), first.names);
+    EXPECT_EQ(1U, second.sequenceRow);
+    EXPECT_EQ((std::vector<std::uint32_t>{0, 1}), second.names);
+}
+
+TEST(TestSnapshot, resumeBatchYieldsUpToCapacity)
+{
+    const auto db{std::make_shared<TableDatabase>()};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "Stan Lee")};
+
+    const std::span<const comics::coroutine::SequenceMatch> first{coro.resumeBatch(1)};
+    ASSERT_EQ(1U, first.size());
+    EXPECT_EQ(0U, first[0].sequenceRow);
+    const std::span<const comics::coroutine::SequenceMatch> second{coro.resumeBatch(8)};
+    ASSERT_EQ(1U, second.size());
+    EXPECT_EQ(1U, second[0].sequenceRow);
+    EXPECT_TRUE(coro.resumeBatch(8).empty());
+}
@@ -0,0 +1,112 @@
+#include <comics/comics.h>
+#include <comics/coro.h>
+#include <comics/snapshot.h>
+#include <comics/sort-keys.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Sequences out of order, as a partial or merged dump may have them.
+void writeUnorderedDump(const ScratchDir &dir)
+{
+    dir.write("2024-01-01_issues.json", R"([
+        { "id": "17568", "series name": "The Amazing Spider-Man", "issue number": "1" },
+        { "id": "16556", "series name": "Fantastic Four", "issue number": "1" }
+    ])");
+    dir.write("2024-01-01_sequences.json", R"([
+        { "issue": "17568", "sequence_number": "10", "script": "Stan Lee", "title": "C" },
+        { "issue": "17568", "sequence_number": "2", "script": "Stan Lee", "title": "B" },
+        { "issue": "16556", "sequence_number": "0", "script": "Stan Lee", "title": "A" }
+    ])");
+}
+
+} // namespace
+
+TEST(TestSortKeys, keysOrderByIssueThenSequenceNumber)
+{
+    EXPECT_LT(comics::sequenceKey(1, 100), comics::sequenceKey(2, 0));
+    EXPECT_LT(comics::sequenceKey(2, 2), comics::sequenceKey(2, 10));
+    EXPECT_EQ(17568, comics::keyIssue(comics::sequenceKey(17568, 3)));
+}
+
+TEST(TestSortKeys, radixSortMatchesStableSort)
+{
+    std::mt19937 random{42};
+    std::uniform_int_distribution<std::int32_t> issues{0, 3000000};
+    std::uniform_int_distribution<std::int32_t> numbers{0, 40};
+    std::vector<comics::KeyedRow> rows;
+    for (std::uint32_t row = 0; row < 10000; ++row)
+    {
+        // repeat keys so stability matters
+        rows.push_back(comics::KeyedRow{comics::sequenceKey(issues(random) % 500, numbers(random)), row});
+    }
+    rows.push_back(comics::KeyedRow{comics::sequenceKey(issues(random), 0), 10000});
+    std::vector<comics::KeyedRow> expected{rows};
+    std::stable_sort(expected.begin(), expected.end(),
+        [](const comics::KeyedRow &lhs, const comics::KeyedRow &rhs) { return lhs.key < rhs.key; });
+
+    comics::sortKeyedRows(rows);
+
+    ASSERT_EQ(expected.size(), rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].key, rows[i].key);
+        EXPECT_EQ(expected[i].row, rows[i].row);
+    }
+}
+
+TEST(TestSortKeys, printOrdersByIssueThenSequenceNumber)
+{
+    const ScratchDir dir;
+    writeUnorderedDump(dir);
+    const std::shared_ptr<comics::Database> db{comics::createDatabase(dir.path())};
+    std::ostringstream str;
+
+    db->printScriptSequences(str, "Lee");
+
+    const std::string text{str.str()};
+    EXPECT_LT(text.find("title: A"), text.find("title: B"));
+    EXPECT_LT(text.find("title: B"), text.find("title: C"));
+}
+
+TEST(TestSortKeys, orderedMatchesYieldByIssueThenSequenceNumber)
+{
+    const ScratchDir dir;
+    writeUnorderedDump(dir);
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path())};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "Lee",
+        comics::MatchMode::SUBSTRING, comics::MatchOrder::SEQUENCE)};
+
+    const comics::SequenceColumns sequences{*db->getSequenceTable()};
+    std::string titles;
+    while (coro.resume())
+    {
+        titles += sequences.title[coro.getMatch().sequenceRow];
+    }
+
+    EXPECT_EQ("ABC", titles);
+}
+
+TEST(TestSortKeys, orderedMatchesOfStreamThrow)
+{
+    const ScratchDir dir;
+    dir.write("2024-01-01_issues.ndjson", "{ \"id\": \"1\"}\n");
+    dir.write("2024-01-01_sequences.ndjson", "{ \"issue\": \"1\", \"sequence_number\": \"0\", \"script\": \"Lee\"}\n");
+    const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path())};
+    comics::coroutine::MatchGenerator coro{matches(db, comics::coroutine::CreditField::SCRIPT, "Lee",
+        comics::MatchMode::SUBSTRING, comics::MatchOrder::SEQUENCE)};
+
+    EXPECT_THROW(coro.resume(), std::runtime_error);
+}
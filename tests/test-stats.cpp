@@ -0,0 +1,141 @@
+#include <comics/comics.h>
+#include <comics/coro.h>
+#include <comics/match-printer.h>
+#include <comics/stats.h>
+
+#include <gtest/gtest.h>
+
+#include "scratch-dir.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+// Scratch directory with a small issues and sequences dump.
+class JSONDir : public ScratchDir
+{
+public:
+    JSONDir()
+    {
+        write("issues.json", R"([
+            { "id": "1", "series name": "Fantastic Four", "issue number": "1" },
+            { "id": "2", "series name": "Fantastic Four", "issue number": "2" }
+        ])");
+        write("sequences.json", R"([
+            { "issue": "1", "sequence_number": "0", "script": "Stan Lee" },
+            { "issue": "1", "sequence_number": "1", "script": "Jack Kirby" },
+            { "issue": "2", "sequence_number": "0", "script": "Stan Lee" }
+        ])");
+    }
+};
+
+// Silences the progress the databases write while loading.
+class QuietCout
+{
+public:
+    QuietCout() :
+        m_saved(std::cout.rdbuf(m_discard.rdbuf()))
+    {
+    }
+    ~QuietCout()
+    {
+        std::cout.rdbuf(m_saved);
+    }
+
+private:
+    std::ostringstream m_discard;
+    std::streambuf *m_saved;
+};
+
+std::int64_t phaseTime(const comics::QueryStats &stats, comics::Phase phase)
+{
+    return stats.nanoseconds[static_cast<std::size_t>(phase)].load();
+}
+
+} // namespace
+
+TEST(TestStats, timerWithoutStatsDoesNothing)
+{
+    const comics::PhaseTimer timer{nullptr, comics::Phase::SCAN};
+}
+
+TEST(TestStats, nestedTimerIsExcludedFromOuter)
+{
+    comics::QueryStats stats;
+
+    {
+        const comics::PhaseTimer scan{&stats, comics::Phase::SCAN};
+        const comics::PhaseTimer join{&stats, comics::Phase::JOIN};
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    EXPECT_GE(phaseTime(stats, comics::Phase::JOIN), 20'000'000);
+    EXPECT_LT(phaseTime(stats, comics::Phase::SCAN), phaseTime(stats, comics::Phase::JOIN));
+}
+
+TEST(TestStats, printsJSONObject)
+{
+    comics::QueryStats stats;
+    stats.matches = 3;
+    stats.nanoseconds[static_cast<std::size_t>(comics::Phase::SORT)] = 42;
+    std::ostringstream str;
+
+    comics::printStatsJSON(str, stats);
+
+    const std::string json{str.str()};
+    EXPECT_EQ(0U, json.find("{\"phases_ns\": {\"read\": 0, "));
+    EXPECT_NE(std::string::npos, json.find("\"sort\": 42"));
+    EXPECT_NE(std::string::npos, json.find("\"matches\": 3,"));
+    EXPECT_EQ("}\n", json.substr(json.size() - 2));
+}
+
+TEST(TestStats, printDatabaseCountsQuery)
+{
+    const JSONDir dir;
+    comics::QueryStats stats;
+    comics::DatabaseOptions options;
+    options.stats = &stats;
+    std::ostringstream out;
+
+    {
+        const QuietCout quiet;
+        comics::createDatabase(dir.path(), options)->printScriptSequences(out, "Stan Lee");
+    }
+
+    EXPECT_EQ(std::filesystem::file_size(dir.path() / "issues.json") +
+            std::filesystem::file_size(dir.path() / "sequences.json"),
+        stats.bytesRead.load());
+    EXPECT_EQ(3U, stats.recordsScanned.load());
+    EXPECT_EQ(2U, stats.matches.load());
+    EXPECT_EQ(2U, stats.joinLookups.load());
+    EXPECT_EQ(out.str().size(), stats.outputBytes.load());
+}
+
+TEST(TestStats, coroutineDatabaseCountsQuery)
+{
+    const JSONDir dir;
+    comics::QueryStats stats;
+    comics::DatabaseOptions options;
+    options.stats = &stats;
+    std::ostringstream out;
+
+    {
+        const QuietCout quiet;
+        const comics::coroutine::DatabasePtr db{comics::coroutine::createDatabase(dir.path(), options)};
+        comics::coroutine::MatchGenerator coro{
+            matches(db, comics::coroutine::CreditField::SCRIPT, "Stan Lee", comics::MatchMode::SUBSTRING)};
+        comics::coroutine::MatchPrinter{*db}.printAll(out, coro);
+    }
+
+    EXPECT_EQ(3U, stats.recordsScanned.load());
+    EXPECT_EQ(2U, stats.matches.load());
+    EXPECT_EQ(2U, stats.joinLookups.load());
+    EXPECT_EQ(out.str().size(), stats.outputBytes.load());
+    EXPECT_GT(phaseTime(stats, comics::Phase::PARSE), 0);
+}
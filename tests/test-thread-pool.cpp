@@ -0,0 +1,81 @@
+#include <comics/thread-pool.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(TestThreadPool, partsCoverRangeInOrder)
+{
+    comics::ThreadPool pool{4};
+    std::vector<std::size_t> begins(pool.parts(10));
+    std::vector<std::size_t> ends(pool.parts(10));
+
+    pool.parallelFor(10,
+        [&](std::size_t part, std::size_t begin, std::size_t end)
+        {
+            begins[part] = begin;
+            ends[part] = end;
+        });
+
+    ASSERT_EQ(4U, begins.size());
+    EXPECT_EQ(0U, begins.front());
+    EXPECT_EQ(10U, ends.back());
+    for (std::size_t part = 1; part < begins.size(); ++part)
+    {
+        EXPECT_EQ(ends[part - 1], begins[part]);
+    }
+}
+
+TEST(TestThreadPool, fewerRowsThanThreads)
+{
+    comics::ThreadPool pool{8};
+
+    EXPECT_EQ(3U, pool.parts(3));
+    EXPECT_EQ(0U, pool.parts(0));
+}
+
+TEST(TestThreadPool, rethrowsLowestPartException)
+{
+    comics::ThreadPool pool{4};
+
+    try
+    {
+        pool.parallelFor(8,
+            [](std::size_t part, std::size_t, std::size_t)
+            {
+                if (part >= 1)
+                {
+                    throw std::runtime_error(std::to_string(part));
+                }
+            });
+        FAIL() << "Expected exception";
+    }
+    catch (const std::runtime_error &bang)
+    {
+        EXPECT_STREQ("1", bang.what());
+    }
+}
+
+TEST(TestThreadPool, collectKeepsSerialOrder)
+{
+    comics::ThreadPool pool{3};
+
+    const std::vector<std::size_t> evens{comics::parallelCollect<std::size_t>(pool, 100,
+        [](std::size_t begin, std::size_t end, std::vector<std::size_t> &matches)
+        {
+            for (std::size_t row = begin; row < end; ++row)
+            {
+                if (row % 2 == 0)
+                {
+                    matches.push_back(row);
+                }
+            }
+        })};
+
+    ASSERT_EQ(50U, evens.size());
+    EXPECT_TRUE(std::is_sorted(evens.begin(), evens.end()));
+}
@@ -0,0 +1,137 @@
+#include <comics/trace.h>
+
+#include <simdjson.h>
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// Makes a recorder active for the life of a test.
+class ActiveRecorder
+{
+public:
+    explicit ActiveRecorder(std::size_t eventsPerThread = comics::TraceRecorder::DEFAULT_EVENTS_PER_THREAD) :
+        m_recorder(eventsPerThread)
+    {
+        comics::TraceRecorder::setActive(&m_recorder);
+    }
+    ~ActiveRecorder()
+    {
+        comics::TraceRecorder::setActive(nullptr);
+    }
+
+    std::string trace() const
+    {
+        std::ostringstream str;
+        m_recorder.writeChromeTrace(str);
+        return str.str();
+    }
+    const comics::TraceRecorder &recorder() const
+    {
+        return m_recorder;
+    }
+
+private:
+    comics::TraceRecorder m_recorder;
+};
+
+struct Event
+{
+    std::string name;
+    std::string phase;
+    std::int64_t tid;
+    std::int64_t value;
+};
+
+std::vector<Event> parseEvents(const std::string &trace)
+{
+    simdjson::dom::parser parser;
+    std::vector<Event> events;
+    for (const simdjson::dom::element event : parser.parse(trace)["traceEvents"].get_array())
+    {
+        const simdjson::simdjson_result<simdjson::dom::element> value{event["args"]["n"]};
+        events.push_back(Event{std::string{event["name"].get_string().value()},
+            std::string{event["ph"].get_string().value()}, event["tid"].get_int64().value(),
+            value.error() == simdjson::SUCCESS ? value.get_int64().value() : -1});
+    }
+    return events;
+}
+
+} // namespace
+
+TEST(TestTrace, spansAreIgnoredWithoutActiveRecorder)
+{
+    comics::TraceRecorder recorder;
+
+    {
+        const comics::TraceSpan span{"ignored"};
+        comics::traceInstant("ignored");
+    }
+
+    std::ostringstream str;
+    recorder.writeChromeTrace(str);
+    EXPECT_TRUE(parseEvents(str.str()).empty());
+}
+
+TEST(TestTrace, writesSpansAndInstants)
+{
+    const ActiveRecorder active;
+
+    {
+        comics::TraceSpan span{"scan"};
+        span.setValue(42);
+        comics::traceInstant("suspend");
+    }
+
+    const std::vector<Event> events{parseEvents(active.trace())};
+    ASSERT_EQ(3U, events.size());
+    EXPECT_EQ("M", events[0].phase);
+    EXPECT_EQ("suspend", events[1].name);
+    EXPECT_EQ("i", events[1].phase);
+    EXPECT_EQ("scan", events[2].name);
+    EXPECT_EQ("X", events[2].phase);
+    EXPECT_EQ(42, events[2].value);
+}
+
+TEST(TestTrace, threadsRecordToTheirOwnBuffers)
+{
+    const ActiveRecorder active;
+
+    {
+        const comics::TraceSpan span{"main"};
+    }
+    std::thread([] { const comics::TraceSpan span{"worker"}; }).join();
+
+    std::set<std::int64_t> tids;
+    for (const Event &event : parseEvents(active.trace()))
+    {
+        if (event.phase == "X")
+        {
+            tids.insert(event.tid);
+        }
+    }
+    EXPECT_EQ(2U, tids.size());
+}
+
+TEST(TestTrace, fullBufferKeepsLatestEvents)
+{
+    const ActiveRecorder active{2};
+
+    comics::traceInstant("first", 1);
+    comics::traceInstant("second", 2);
+    comics::traceInstant("third", 3);
+
+    const std::vector<Event> events{parseEvents(active.trace())};
+    ASSERT_EQ(3U, events.size());
+    EXPECT_EQ(2, events[1].value);
+    EXPECT_EQ(3, events[2].value);
+    EXPECT_EQ(1U, active.recorder().dropped());
+}
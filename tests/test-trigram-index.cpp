@@ -0,0 +1,54 @@
+#include <comics/trigram-index.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string_view>
+
+using namespace testing;
+
+namespace
+{
+
+comics::TrigramIndex sampleIndex()
+{
+    comics::TrigramIndex index;
+    index.add(0, "Stan Lee");
+    index.add(1, "Jack Kirby");
+    index.add(2, "Stan Lee (credited)");
+    index.add(3, "Steve Ditko");
+    index.add(5, "Stan Goldberg [as Stan Lee]");
+    return index;
+}
+
+} // namespace
+
+TEST(TestTrigramIndex, candidatesIncludeEveryMatch)
+{
+    const comics::TrigramIndex index{sampleIndex()};
+
+    EXPECT_THAT(index.candidates("Stan Lee"), ElementsAre(0, 2, 5));
+    EXPECT_THAT(index.candidates("Kirby"), ElementsAre(1));
+}
+
+TEST(TestTrigramIndex, unknownTrigramHasNoCandidates)
+{
+    const comics::TrigramIndex index{sampleIndex()};
+
+    EXPECT_THAT(index.candidates("Barry Flargle"), IsEmpty());
+}
+
+TEST(TestTrigramIndex, candidatesAreCaseSensitive)
+{
+    const comics::TrigramIndex index{sampleIndex()};
+
+    EXPECT_THAT(index.candidates("stan"), IsEmpty());
+}
+
+TEST(TestTrigramIndex, rejectsShortNeedles)
+{
+    const comics::TrigramIndex index{sampleIndex()};
+
+    EXPECT_THROW(index.candidates("St"), std::runtime_error);
+}
@@ -0,0 +1,182 @@
+#include <comics/formatter.h>
+#include <comics/gcd-converter.h>
+#include <comics/gcd-synth.h>
+
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+namespace tool
+{
+
+struct Options
+{
+    comics::SynthOptions synth;
+    // also convert the dumps as gcd-to-json would
+    bool json{};
+    comics::ConvertOptions convert;
+};
+
+template <typename T>
+bool parseValue(std::string_view text, T &value)
+{
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc{} && end == text.data() + text.size();
+}
+
+void synthesize(const fs::path &dir, comics::DumpKind kind, const Options &options)
+{
+    const std::string stem{kind == comics::DumpKind::ISSUES ? "synth_issues" : "synth_sequences"};
+    const fs::path tsvPath{dir / (stem + ".tsv")};
+    const fs::path jsonPath{dir / (stem + (options.convert.ndjson ? ".ndjson" : ".json"))};
+    std::cout << "Writing " << tsvPath.string();
+    if (options.json)
+    {
+        std::cout << " and " << jsonPath.string();
+    }
+    std::cout << '\n';
+
+    const auto start{std::chrono::steady_clock::now()};
+    std::ofstream tsvFile(tsvPath);
+    comics::OutputBuffer tsv{tsvFile, 1024 * 1024};
+    std::optional<std::ofstream> jsonFile;
+    std::optional<comics::OutputBuffer> json;
+    std::optional<comics::DumpConverter> converter;
+    if (options.json)
+    {
+        jsonFile.emplace(jsonPath);
+        json.emplace(*jsonFile, 1024 * 1024);
+        converter.emplace(kind, options.convert, *json);
+    }
+    if (kind == comics::DumpKind::ISSUES)
+    {
+        comics::synthesizeIssues(options.synth, tsv, converter ? &*converter : nullptr);
+    }
+    else
+    {
+        comics::synthesizeSequences(options.synth, tsv, converter ? &*converter : nullptr);
+    }
+    if (json)
+    {
+        json->flush();
+    }
+    tsv.flush();
+    if (!tsvFile || (jsonFile && !*jsonFile))
+    {
+        throw std::runtime_error("Couldn't write " + stem);
+    }
+
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+    const double megabytes{static_cast<double>(tsv.written()) / (1024.0 * 1024.0)};
+    std::cout << std::fixed << std::setprecision(1) << megabytes << " MB of dump in " << std::setprecision(2)
+              << elapsed.count() << "s\n"
+              << std::defaultfloat;
+}
+
+} // namespace tool
+
+int main(int argc, char *argv[])
+{
+    tool::Options options;
+    int arg{1};
+    for (; arg < argc - 1; ++arg)
+    {
+        const std::string option{argv[arg]};
+        const bool hasValue{arg + 1 < argc - 1};
+        if (option == "-i" && hasValue)
+        {
+            if (!tool::parseValue(argv[++arg], options.synth.issues) || options.synth.issues == 0)
+            {
+                break;
+            }
+        }
+        else if (option == "-q" && hasValue)
+        {
+            if (!tool::parseValue(argv[++arg], options.synth.sequences))
+            {
+                break;
+            }
+        }
+        else if (option == "-c" && hasValue)
+        {
+            if (!tool::parseValue(argv[++arg], options.synth.creators) || options.synth.creators == 0)
+            {
+                break;
+            }
+        }
+        else if (option == "-z" && hasValue)
+        {
+            if (!tool::parseValue(argv[++arg], options.synth.zipfExponent) || options.synth.zipfExponent < 0.0)
+            {
+                break;
+            }
+        }
+        else if (option == "-r" && hasValue)
+        {
+            if (!tool::parseValue(argv[++arg], options.synth.seed))
+            {
+                break;
+            }
+        }
+        else if (option == "-o")
+        {
+            options.json = true;
+        }
+        else if (option == "-s")
+        {
+            options.json = true;
+            options.convert.singleLineRecords = true;
+        }
+        else if (option == "-n")
+        {
+            options.json = true;
+            options.convert.singleLineRecords = true;
+            options.convert.ndjson = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (arg != argc - 1)
+    {
+        std::cerr << "Usage: gcd-synth [-i N] [-q N] [-c N] [-z S] [-r SEED] [-o] [-s] [-n] <datadir>\n"
+                     "  -i N  number of issues (default 1000)\n"
+                     "  -q N  number of sequences, spread over the issues (default 10000)\n"
+                     "  -c N  number of distinct creator names (default 10000)\n"
+                     "  -z S  exponent of the Zipf distribution of creator names (default 1, 0 is uniform)\n"
+                     "  -r SEED  random seed; the same options and seed always write the same dataset\n"
+                     "  -o  also write the JSON gcd-to-json would convert the dumps to\n"
+                     "  -s  as -o, with each JSON record on a single line\n"
+                     "  -n  as -o, with newline delimited JSON (.ndjson)\n";
+        return 1;
+    }
+
+    try
+    {
+        const fs::path dataDir{argv[arg]};
+        fs::create_directories(dataDir);
+        tool::synthesize(dataDir, comics::DumpKind::ISSUES, options);
+        tool::synthesize(dataDir, comics::DumpKind::SEQUENCES, options);
+    }
+    catch (const std::exception &bang)
+    {
+        std::cerr << "\nUnexpected exception: " << bang.what() << '\n';
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "\nUnexpected exception\n";
+        return 2;
+    }
+    return 0;
+}
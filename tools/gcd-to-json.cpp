@@ -1,10 +1,24 @@
-#include <cctype>
+#include <comics/dump-delta.h>
+#include <comics/formatter.h>
+#include <comics/gcd-converter.h>
+#include <comics/snapshot.h>
+#include <comics/thread-pool.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
-#include <map>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -17,212 +31,164 @@ inline bool endsWith(const std::string &text, const std::string &suffix)
     return text.length() >= suffix.length() && text.substr(text.length() - suffix.length()) == suffix;
 }
 
-inline std::string escaped(std::string text)
+struct Options
 {
-    // escape all backslashes
-    for (std::string::size_type pos = text.find('\\'); pos != std::string::npos; pos = text.find('\\', pos + 2))
-    {
-        text.insert(pos, 1, '\\');
-    }
-
-    // replace "" with \"
-    for (std::string::size_type pos = text.find(R"("")"); pos != std::string::npos; pos = text.find(R"("")", pos + 2))
-    {
-        text[pos] = '\\';
-    }
+    bool snapshot{};
+    comics::ConvertOptions convert;
+    unsigned threads{std::max(1U, std::thread::hardware_concurrency())};
+    // directory of the previous conversion, for copying its unchanged records; empty to convert everything
+    std::optional<fs::path> previousDir;
+};
 
-    // escape all TABs
-    for (std::string::size_type pos = text.find('\t'); pos != std::string::npos; pos = text.find('\t', pos + 1))
-    {
-        text.erase(pos, 1);
-        text.insert(pos, "\\t");
-    }
+// Serializes output of conversions running at the same time.
+std::mutex g_console;
 
-    // scan for control characters
-    std::string::size_type pos = 0;
-    while (pos < text.length())
+void writeTable(const fs::path &outPath, const comics::TableWriter &table, const fs::path &jsonPath)
+{
     {
-        const unsigned char c = static_cast<unsigned char>(text[pos]);
-        if (c < 32)
-        {
-            std::cerr << "\nControl character (^" << static_cast<char>(c + 64) << ") found in '" << text << "'; dropping\n"
-                << "                                 " << std::string(pos, ' ') << "^--\n";
-            text.erase(pos, 1);
-        }
-        else
-        {
-            ++pos;
-        }
+        const std::lock_guard lock{g_console};
+        std::cout << "Writing snapshot " << outPath.string() << '\n';
     }
-    return text;
+    comics::writeSnapshot(outPath, table.table(), jsonPath);
 }
 
-void split(std::vector<std::string> &fields, const std::string &text)
+std::uint32_t recordFlags(const Options &options)
 {
-    fields.clear();
-    std::size_t start{1};
-    for (std::size_t split = text.find("\"\t\""); split != std::string::npos; split = text.find("\"\t\"", split + 1))
-    {
-        fields.emplace_back(text.substr(start, split - start));
-        start = split + 3;
-    }
-    fields.emplace_back(text.substr(start, text.length() - start - 1));
+    return (options.convert.singleLineRecords ? comics::RECORDS_SINGLE_LINE : 0U) |
+        (options.convert.ndjson ? comics::RECORDS_NDJSON : 0U) | (options.snapshot ? comics::RECORDS_SNAPSHOT : 0U);
 }
 
-void convertIssues( const fs::path &path, bool singleLineRecords )
+// Open the conversion of the same kind of dump in the previous directory, if there is a usable one.
+void openPrevious(comics::DumpKind kind, const Options &options, std::optional<comics::PreviousConversion> &previous)
 {
-    fs::path outPath{fs::path(path).replace_extension(".json")};
-    std::cout << "Convert issues at " << path.string() << " to " << outPath.string() << '\n';
-    std::ifstream tsv(path);
-    std::ofstream json(outPath);
-    int recordCount{};
-    std::string line;
-    std::map<std::string, std::string> record;
-    int lastRecordId{-1};
-    bool firstRecord{true};
-    auto printRecord = [&]
-    {
-        if (record.empty())
-            return;
-        if (!firstRecord)
-            json << ",\n";
-        json << "{";
-        bool first{true};
-        for (const auto &pair : record)
-        {
-            if (!first)
-            {
-                json << ",";
-            }
-            json << (singleLineRecords ? " \"" : "\n    \"") << escaped(pair.first) << "\": ";
-            if (pair.second == "True" || pair.second == "False")
-            {
-                json << (pair.second == "True" ? "true" : "false");
-            }
-            else
-            {
-                json << "\"" << escaped(pair.second) << "\"";
-            }
-            first = false;
-        }
-        json << (singleLineRecords ? "}" : "\n}");
-        firstRecord = false;
-    };
-    json << "[\n";
-    while (tsv)
+    const std::string kindName{kind == comics::DumpKind::ISSUES ? "issues" : "sequences"};
+    for (const fs::directory_entry &entry : fs::directory_iterator(*options.previousDir))
     {
-        if (!std::getline(tsv, line))
-        {
-            break;
-        }
-        ++recordCount;
-        if (recordCount % 1000 == 0)
+        const fs::path &path = entry.path();
+        if (!(entry.is_regular_file() && path.extension().string() == ".records" &&
+                endsWith(path.stem().string(), kindName)))
         {
-            std::cout << recordCount << " records...\r";
+            continue;
         }
-
-        std::vector<std::string> fields;
-        split(fields, line);
-        if (fields.size() != 3)
+        try
         {
-            throw std::runtime_error("Expected 3 fields, got " + std::to_string(fields.size()));
+            previous.emplace(path, fs::path(path).replace_extension(options.convert.ndjson ? ".ndjson" : ".json"),
+                fs::path(path).replace_extension(".snapshot"), recordFlags(options),
+                kind == comics::DumpKind::ISSUES ? comics::ISSUE_COLUMNS : comics::SEQUENCE_COLUMNS);
+            return;
         }
-        const int recordId{std::stoi(fields[0])};
-        if (recordId != lastRecordId)
+        catch (const std::exception &bang)
         {
-            if (!record.empty())
-            {
-                printRecord();
-            }
-            record.clear();
-            record["id"] = fields[0];
-            lastRecordId = recordId;
+            const std::lock_guard lock{g_console};
+            std::cout << "Ignoring previous " << kindName << ": " << bang.what() << '\n';
         }
-        record[fields[1]] = fields[2];
     }
-    printRecord();
-    json << "\n]\n";
-    std::cout << '\n' << recordCount << " records processed.\n";
 }
 
-void convertSequences( const fs::path &path, bool singleLineRecords )
+void convert(const fs::path &path, comics::DumpKind kind, const Options &options, comics::ThreadPool *pool)
 {
-    fs::path outPath{fs::path(path).replace_extension(".json")};
-    std::cout << "Convert sequences at " << path.string() << " to " << outPath.string() << '\n';
-    std::ifstream tsv(path);
-    std::ofstream json(outPath);
-    int recordCount{};
-    std::string line;
-    std::map<std::string, std::string> record;
-    int lastRecordId{-1};
-    int lastSequenceId{-1};
-    bool firstRecord{true};
-    auto printRecord = [&]
+    const fs::path outPath{fs::path(path).replace_extension(options.convert.ndjson ? ".ndjson" : ".json")};
+    const fs::path snapshotPath{fs::path(path).replace_extension(".snapshot")};
     {
-        if (record.empty())
-            return;
-        if (!firstRecord)
-            json << ",\n";
-        json << "{";
-        bool first{true};
-        for (const auto &pair : record)
-        {
-            if (!first)
-            {
-                json << ",";
-            }
-            json << (singleLineRecords ? " \"" : "\n    \"") << escaped(pair.first) << "\": ";
-            if (pair.second == "True" || pair.second == "False")
-            {
-                json << (pair.second == "True" ? "true" : "false");
-            }
-            else
-            {
-                json << "\"" << escaped(pair.second) << "\"";
-            }
-            first = false;
-        }
-        json << (singleLineRecords ? "}" : "\n}");
-        firstRecord = false;
+        const std::lock_guard lock{g_console};
+        std::cout << "Convert " << (kind == comics::DumpKind::ISSUES ? "issues" : "sequences") << " at "
+                  << path.string() << " to " << outPath.string() << '\n';
+    }
+    const auto start{std::chrono::steady_clock::now()};
+    const comics::MappedFile tsv{path};
+    const std::string_view text{tsv.data(), tsv.size()};
+    const bool incremental{options.previousDir.has_value()};
+    std::optional<comics::PreviousConversion> previous;
+    comics::RecordTracking tracking;
+    if (incremental)
+    {
+        openPrevious(kind, options, previous);
+        tracking.previous = previous ? &*previous : nullptr;
+    }
+    // the previous output may be the one being replaced, so it stays mapped until the new one is complete
+    const auto pending = [=](const fs::path &target) { return incremental ? fs::path(target) += ".tmp" : target; };
+    std::ofstream json(pending(outPath));
+    comics::TableWriter table{options.snapshot
+            ? (kind == comics::DumpKind::ISSUES ? comics::ISSUE_COLUMNS : comics::SEQUENCE_COLUMNS)
+            : std::vector<comics::ColumnSpec>{}};
+    comics::TableWriter *rows{options.snapshot ? &table : nullptr};
+    const auto progress = [](std::size_t lines)
+    {
+        const std::lock_guard lock{g_console};
+        std::cout << lines << " records...\r";
     };
-    json << "[\n";
-    while (tsv)
+    std::size_t recordCount{};
+    if (pool != nullptr)
     {
-        if (!std::getline(tsv, line))
-        {
-            break;
-        }
-        ++recordCount;
-        if (recordCount % 1000 == 0)
+        recordCount = comics::convertDumpParallel(
+            text, kind, options.convert, json, rows, *pool, incremental ? &tracking : nullptr, progress);
+    }
+    else
+    {
+        comics::OutputBuffer out{json, 1024 * 1024};
+        comics::DumpConverter converter{kind, options.convert, out, rows};
+        if (incremental)
         {
-            std::cout << recordCount << " records...\r";
+            converter.track(tracking);
         }
-
-        std::vector<std::string> fields;
-        split(fields, line);
-        if (fields.size() != 4)
+        recordCount = comics::convertDump(text, converter, progress);
+    }
+    json.close();
+    if (options.snapshot)
+    {
+        writeTable(pending(snapshotPath), table, pending(outPath));
+    }
+    else
+    {
+        // a snapshot of an earlier conversion would be read instead of the new JSON
+        fs::remove(snapshotPath);
+    }
+    // an older .ndjson beside new JSON is ignored by print-comics-coroutine, but print-comics only reads JSON
+    if (const fs::path jsonPath{fs::path(path).replace_extension(".json")};
+        options.convert.ndjson && fs::is_regular_file(jsonPath))
+    {
+        const std::lock_guard lock{g_console};
+        std::cout << "Warning: " << jsonPath.string() << " is older than " << outPath.string()
+                  << "; print-comics still reads it\n";
+    }
+    const std::size_t removed{previous ? previous->removed(tracking.records) : 0};
+    const fs::path recordsPath{fs::path(path).replace_extension(".records")};
+    if (incremental)
+    {
+        previous.reset();
+        fs::rename(pending(outPath), outPath);
+        if (options.snapshot)
         {
-            throw std::runtime_error("Expected 4 fields, got " + std::to_string(fields.size()));
+            fs::rename(pending(snapshotPath), snapshotPath);
         }
-        const int recordId{std::stoi(fields[0])};
-        const int sequenceId{std::stoi(fields[1])};
-        if (recordId != lastRecordId || sequenceId != lastSequenceId)
+        comics::writeRecordList(recordsPath, recordFlags(options), outPath, tracking.records);
+    }
+    else
+    {
+        // the records of an earlier incremental conversion no longer describe the output
+        fs::remove(recordsPath);
+    }
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+    const double megabytes{static_cast<double>(tsv.size()) / (1024.0 * 1024.0)};
+    {
+        const std::lock_guard lock{g_console};
+        std::cout << '\n' << recordCount << " records processed.\n";
+        if (incremental)
         {
-            printRecord();
-            record.clear();
-            record["issue"] = fields[0];
-            lastRecordId = recordId;
-            lastSequenceId = sequenceId;
+            const comics::DeltaCounts &counts{tracking.counts};
+            std::cout << counts.unchanged << " unchanged, " << counts.changed << " changed, " << counts.added
+                      << " added, " << removed << " removed.\n";
         }
-        record[fields[2]] = fields[3];
+        std::cout << std::fixed << std::setprecision(1) << megabytes << " MB in " << std::setprecision(2)
+                  << elapsed.count() << "s (" << std::setprecision(1)
+                  << (elapsed.count() > 0.0 ? megabytes / elapsed.count() : 0.0) << " MB/s)\n"
+                  << std::defaultfloat;
     }
-    printRecord();
-    json << "\n]\n";
-    std::cout << '\n' << recordCount << " records processed.\n";
 }
 
-void gcdToJSON( const std::string &dataDir, bool singleLineRecords )
+void gcdToJSON(const std::string &dataDir, const Options &options)
 {
+    std::vector<std::pair<fs::path, comics::DumpKind>> dumps;
     for (const fs::directory_entry &entry : fs::directory_iterator(dataDir))
     {
         const fs::path &path = entry.path();
@@ -233,12 +199,34 @@ void gcdToJSON( const std::string &dataDir, bool singleLineRecords )
 
         if (endsWith(path.stem().string(), "issues"))
         {
-            convertIssues(path, singleLineRecords);
+            dumps.emplace_back(path, comics::DumpKind::ISSUES);
         }
         else if (endsWith(path.stem().string(), "sequences"))
         {
-            convertSequences(path, singleLineRecords);
+            dumps.emplace_back(path, comics::DumpKind::SEQUENCES);
+        }
+    }
+
+    if (options.threads == 1)
+    {
+        for (const auto &[path, kind] : dumps)
+        {
+            convert(path, kind, options, nullptr);
         }
+        return;
+    }
+
+    // convert the dumps at the same time, sharing the pool for their parts
+    comics::ThreadPool pool{options.threads};
+    std::vector<std::future<void>> conversions;
+    for (const auto &[path, kind] : dumps)
+    {
+        conversions.push_back(std::async(std::launch::async,
+            [&path = path, kind = kind, &options, &pool] { convert(path, kind, options, &pool); }));
+    }
+    for (std::future<void> &conversion : conversions)
+    {
+        conversion.get();
     }
 }
 
@@ -246,17 +234,58 @@ void gcdToJSON( const std::string &dataDir, bool singleLineRecords )
 
 int main(int argc, char *argv[])
 {
-    if (argc < 2 || argc > 3 || (argc == 3 && argv[1] != std::string{"-s"}))
+    tool::Options options;
+    int arg{1};
+    for (; arg < argc - 1; ++arg)
+    {
+        const std::string option{argv[arg]};
+        if (option == "-s")
+        {
+            options.convert.singleLineRecords = true;
+        }
+        else if (option == "-b")
+        {
+            options.snapshot = true;
+        }
+        else if (option == "-j" && arg + 1 < argc - 1)
+        {
+            const std::string_view value{argv[++arg]};
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), options.threads);
+            if (ec != std::errc{} || end != value.data() + value.size() || options.threads == 0)
+            {
+                break;
+            }
+        }
+        else if (option == "-i" && arg + 1 < argc - 1)
+        {
+            options.previousDir = argv[++arg];
+        }
+        else if (option == "-n")
+        {
+            options.convert.singleLineRecords = true;
+            options.convert.ndjson = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (arg != argc - 1)
     {
-        std::cerr << "Usage: gcd-to-json [-s] <datadir>\n";
+        std::cerr << "Usage: gcd-to-json [-s] [-b] [-n] [-j N] [-i <previousdir>] <datadir>\n"
+                     "  -s  write each JSON record on a single line\n"
+                     "  -b  also write binary snapshots for print-comics\n"
+                     "  -n  write newline delimited JSON (.ndjson) instead of a JSON array\n"
+                     "  -j N  convert with N threads, both dumps at once; -j 1 converts serially\n"
+                     "  -i <previousdir>  copy records unchanged since the conversion in previousdir, which may be\n"
+                     "      datadir, and write .records files for the next incremental conversion\n";
         return 1;
     }
-    const bool singleLineRecords{argc == 3};
 
-    const std::string dataDir{argv[singleLineRecords ? 2 : 1]};
+    const std::string dataDir{argv[arg]};
     try
     {
-        tool::gcdToJSON(dataDir, singleLineRecords);
+        tool::gcdToJSON(dataDir, options);
     }
     catch (const std::exception &bang)
     {